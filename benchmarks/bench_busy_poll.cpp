@@ -0,0 +1,85 @@
+//
+// Created by wenjuxu on 2023/8/20.
+//
+
+#include <netinet/tcp.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "exec/async_scope.hpp"
+#include "exec/task.hpp"
+#include "fuchsia/epoll_context.h"
+#include "fuchsia/net/tcp.h"
+#include "fuchsia/scope_guard.h"
+#include "fuchsia/socket_accept_op.h"
+#include "fuchsia/socket_recv_some_op.h"
+#include "fuchsia/socket_send_some_op.h"
+
+namespace {
+
+exec::task<void> Echo(fuchsia::net::Tcp::Acceptor& acceptor) {
+    auto socket = co_await fuchsia::AsyncAccept(acceptor);
+    char buffer[64];
+    try {
+        while (true) {
+            size_t n = co_await fuchsia::AsyncRecvSome(socket, fuchsia::Buffer(buffer));
+            co_await fuchsia::AsyncSendSome(socket, fuchsia::Buffer(buffer, n));
+        }
+    } catch (const std::system_error&) {
+        // client gone
+    }
+}
+
+// Round trips of one byte over loopback: a blocking client on the benchmark thread, an echo
+// server on an EpollContext. `state.range(0)` is the busy poll window of the context in us, 0 for
+// the default blocking wait.
+void BM_LoopbackPingPong(benchmark::State& state) {
+    fuchsia::EpollContext::Options options;
+    options.busy_poll_duration = std::chrono::microseconds{state.range(0)};
+    fuchsia::EpollContext context{options};
+    std::jthread thread([&]() { context.Run(); });
+    fuchsia::net::Tcp::Acceptor acceptor{
+        context, fuchsia::net::Tcp::Endpoint{fuchsia::net::AddressV4::Loopback(), 0}};
+    // Stop the context before the acceptor is closed.
+    fuchsia::ScopeGuard guard{[&]() noexcept {
+        context.Stop();
+        thread.join();
+    }};
+    ::sockaddr_storage addr{};
+    ::socklen_t len = sizeof(addr);
+    ::getsockname(acceptor.Fd(), reinterpret_cast<::sockaddr*>(&addr), &len);
+    exec::async_scope scope;
+    scope.spawn(stdexec::on(context.GetScheduler(), Echo(acceptor)));
+
+    int client = ::socket(AF_INET, SOCK_STREAM, 0);  // blocking
+    int one = 1;
+    ::setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (::connect(client, reinterpret_cast<::sockaddr*>(&addr), len) != 0) {
+        state.SkipWithError("connect failed");
+        return;
+    }
+
+    std::vector<double> latencies;
+    char byte = 'x';
+    for (auto _ : state) {
+        auto start = std::chrono::steady_clock::now();
+        ::send(client, &byte, 1, 0);
+        ::recv(client, &byte, 1, 0);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        state.SetIterationTime(elapsed.count());
+        latencies.push_back(elapsed.count() * 1e6);
+    }
+    ::close(client);
+    stdexec::sync_wait(scope.on_empty());
+
+    std::sort(latencies.begin(), latencies.end());
+    state.counters["p50_us"] = latencies[latencies.size() / 2];
+    state.counters["p99_us"] = latencies[latencies.size() * 99 / 100];
+}
+
+}  // namespace
+
+BENCHMARK(BM_LoopbackPingPong)->Arg(0)->Arg(50)->Arg(1000)->UseManualTime();
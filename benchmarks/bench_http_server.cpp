@@ -0,0 +1,169 @@
+//
+// Created by wenjuxu on 2023/9/7.
+//
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "exec/async_scope.hpp"
+#include "exec/task.hpp"
+#include "fuchsia/epoll_context_pool.h"
+#include "fuchsia/http/mux.h"
+#include "fuchsia/http/session.h"
+#include "fuchsia/net/tcp.h"
+#include "fuchsia/socket_accept_op.h"
+
+namespace {
+
+constexpr std::string_view kRequest = "GET /hello HTTP/1.1\r\nHost: localhost\r\n\r\n";
+constexpr size_t kRequestsPerClient = 1'000;
+constexpr size_t kClientsPerReactor = 2;
+
+const fuchsia::http::StaticResponse kHello{fuchsia::http::StatusCode::Ok, "Hello, world!"};
+
+// What fuchsia::http::Server runs on each of its contexts: an SO_REUSEPORT acceptor, and the
+// sessions of the connections it accepted.
+struct Reactor {
+    Reactor(fuchsia::EpollContext& context, const fuchsia::net::Tcp::Endpoint& endpoint)
+        : context{context}, acceptor{context, endpoint, true, true} {}
+
+    fuchsia::EpollContext& context;
+    fuchsia::net::Tcp::Acceptor acceptor;
+    fuchsia::http::SessionMgr session_mgr;
+};
+
+exec::task<void> StartSession(fuchsia::http::SessionMgr& session_mgr,
+                              std::shared_ptr<fuchsia::http::Session> session) {
+    try {
+        co_await session_mgr.Start(session);
+    } catch (const std::exception&) {
+    }
+}
+
+exec::task<void> Accept(Reactor& reactor, exec::async_scope& scope, fuchsia::http::MuxRef mux) {
+    while (true) {
+        auto socket = co_await fuchsia::AsyncAccept(reactor.acceptor);
+        auto session = fuchsia::http::MakeSession(std::move(socket), reactor.session_mgr, mux);
+        scope.spawn(stdexec::on(reactor.context.GetScheduler(),
+                                StartSession(reactor.session_mgr, session)));
+    }
+}
+
+// A keep-alive connection sending requests one at a time with blocking syscalls.
+class Client {
+public:
+    explicit Client(fuchsia::net::PortType port) : fd_(::socket(AF_INET, SOCK_STREAM, 0)) {
+        int one = 1;
+        ::setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        ::sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ::connect(fd_, reinterpret_cast<::sockaddr*>(&addr), sizeof(addr));
+    }
+
+    Client(const Client&) = delete;
+
+    ~Client() { ::close(fd_); }
+
+    // Send a request and read the whole response, false if the connection failed.
+    bool RoundTrip() {
+        if (::send(fd_, kRequest.data(), kRequest.size(), MSG_NOSIGNAL) !=
+            static_cast<ssize_t>(kRequest.size())) {
+            return false;
+        }
+        char buffer[256];
+        size_t received = 0;
+        while (received < kHello.Data().size()) {
+            auto n = ::recv(fd_, buffer, sizeof(buffer), 0);
+            if (n <= 0) {
+                return false;
+            }
+            received += n;
+        }
+        return true;
+    }
+
+private:
+    int fd_;
+};
+
+// A server with `state.range(0)` reactors, each one a thread of its own, as many client threads as
+// there are clients per reactor, every client sending its requests over one connection. Requests
+// per second should grow with the number of reactors, until the clients run out of cpus.
+void BM_HttpServerKeepAlive(benchmark::State& state) {
+    auto num_reactors = static_cast<size_t>(state.range(0));
+    fuchsia::http::ServeMux mux;
+    mux.HandleFunc("/hello", [](const fuchsia::http::Request&,
+                                fuchsia::http::Response& resp) -> exec::task<void> {
+        resp.SetStaticResponse(kHello);
+        co_return;
+    });
+
+    fuchsia::EpollContextPool pool{num_reactors};
+    std::vector<std::unique_ptr<Reactor>> reactors;
+    // The first acceptor picks the port, the others share it.
+    fuchsia::net::Tcp::Endpoint endpoint{fuchsia::net::AddressV4::Loopback(), 0};
+    reactors.push_back(std::make_unique<Reactor>(pool.At(0), endpoint));
+    ::sockaddr_in addr{};
+    ::socklen_t len = sizeof(addr);
+    ::getsockname(reactors[0]->acceptor.Fd(), reinterpret_cast<::sockaddr*>(&addr), &len);
+    endpoint = fuchsia::net::Tcp::Endpoint{fuchsia::net::AddressV4::Loopback(),
+                                           ntohs(addr.sin_port)};
+    for (size_t i = 1; i < num_reactors; ++i) {
+        reactors.push_back(std::make_unique<Reactor>(pool.At(i), endpoint));
+    }
+
+    exec::async_scope scope;
+    pool.Start();
+    for (auto& reactor : reactors) {
+        scope.spawn(stdexec::on(reactor->context.GetScheduler(), Accept(*reactor, scope, mux)));
+    }
+
+    std::vector<std::unique_ptr<Client>> clients;
+    for (size_t i = 0; i < num_reactors * kClientsPerReactor; ++i) {
+        clients.push_back(std::make_unique<Client>(endpoint.Port()));
+    }
+
+    std::atomic<bool> failed = false;
+    for (auto _ : state) {
+        std::vector<std::jthread> threads;
+        for (auto& client : clients) {
+            threads.emplace_back([&client, &failed]() {
+                for (size_t i = 0; i < kRequestsPerClient && !failed; ++i) {
+                    if (!client->RoundTrip()) {
+                        failed = true;
+                    }
+                }
+            });
+        }
+        threads.clear();  // join
+        if (failed) {
+            state.SkipWithError("request failed");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * clients.size() * kRequestsPerClient);
+
+    // Torn down the way Server is.
+    clients.clear();
+    scope.request_stop();
+    pool.Stop();
+    for (auto& reactor : reactors) {
+        reactor->acceptor.Close();
+        reactor->session_mgr.StopAll();
+    }
+}
+
+BENCHMARK(BM_HttpServerKeepAlive)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,87 @@
+//
+// Created by wenjuxu on 2023/8/18.
+//
+
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "exec/async_scope.hpp"
+#include "exec/task.hpp"
+#include "fuchsia/epoll_context.h"
+#include "fuchsia/scope_guard.h"
+
+namespace {
+
+// `state.range(0)` threads start operations on one context as fast as they can, which is what a
+// pool of workers handing results back to an io thread looks like.
+void BM_RemoteScheduleFanIn(benchmark::State& state) {
+    static constexpr size_t kOperationsPerThread = 10'000;
+
+    fuchsia::EpollContext context;
+    std::jthread thread([&]() { context.Run(); });
+    fuchsia::ScopeGuard guard{[&]() noexcept { context.Stop(); }};
+    auto scheduler = context.GetScheduler();
+
+    auto wakeups = context.GetMetrics().wakeups.load();
+    for (auto _ : state) {
+        exec::async_scope scope;
+        std::vector<std::jthread> producers;
+        for (int i = 0; i < state.range(0); ++i) {
+            producers.emplace_back([&] {
+                for (size_t n = 0; n < kOperationsPerThread; ++n) {
+                    scope.spawn(stdexec::schedule(scheduler));
+                }
+            });
+        }
+        producers.clear();  // join
+        stdexec::sync_wait(scope.on_empty());
+    }
+
+    auto operations = state.iterations() * state.range(0) * kOperationsPerThread;
+    state.SetItemsProcessed(operations);
+    state.counters["wakeups/op"] =
+        static_cast<double>(context.GetMetrics().wakeups.load() - wakeups) / operations;
+}
+
+exec::task<void> PingPong(fuchsia::EpollContext::Scheduler a, fuchsia::EpollContext::Scheduler b,
+                          size_t rounds) {
+    for (size_t i = 0; i < rounds; ++i) {
+        co_await stdexec::schedule(b);
+        co_await stdexec::schedule(a);
+    }
+}
+
+// Hop back and forth between two contexts, every hop is a remote schedule onto a context that
+// is most likely sleeping, so this is the worst case of the wakeup handshake.
+void BM_RemoteSchedulePingPong(benchmark::State& state) {
+    static constexpr size_t kRounds = 10'000;
+
+    fuchsia::EpollContext context_a;
+    fuchsia::EpollContext context_b;
+    std::jthread thread_a([&]() { context_a.Run(); });
+    std::jthread thread_b([&]() { context_b.Run(); });
+    fuchsia::ScopeGuard guard{[&]() noexcept {
+        context_a.Stop();
+        context_b.Stop();
+    }};
+    auto a = context_a.GetScheduler();
+    auto b = context_b.GetScheduler();
+
+    auto wakeups = context_a.GetMetrics().wakeups.load() + context_b.GetMetrics().wakeups.load();
+    for (auto _ : state) {
+        stdexec::sync_wait(stdexec::on(a, PingPong(a, b, kRounds)));
+    }
+
+    auto hops = state.iterations() * kRounds * 2;
+    state.SetItemsProcessed(hops);
+    state.counters["wakeups/op"] = static_cast<double>(context_a.GetMetrics().wakeups.load() +
+                                                       context_b.GetMetrics().wakeups.load() -
+                                                       wakeups) /
+                                   hops;
+}
+
+}  // namespace
+
+BENCHMARK(BM_RemoteScheduleFanIn)->Arg(1)->Arg(4)->Arg(16)->UseRealTime();
+BENCHMARK(BM_RemoteSchedulePingPong)->UseRealTime();
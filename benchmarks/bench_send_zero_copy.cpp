@@ -0,0 +1,83 @@
+//
+// Created by wenjuxu on 2023/9/1.
+//
+
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "exec/task.hpp"
+#include "fuchsia/epoll_context.h"
+#include "fuchsia/net/tcp.h"
+#include "fuchsia/scope_guard.h"
+#include "fuchsia/socket_send_all_op.h"
+#include "fuchsia/socket_send_zero_copy_op.h"
+
+namespace {
+
+// A connected pair of sockets, the server side bound to `context`, the client side blocking.
+std::pair<fuchsia::net::Tcp::Socket, int> MakeConnection(fuchsia::EpollContext& context) {
+    fuchsia::net::Tcp::Acceptor acceptor{
+        context, fuchsia::net::Tcp::Endpoint{fuchsia::net::AddressV4::Loopback(), 0}};
+    ::sockaddr_storage addr{};
+    ::socklen_t len = sizeof(addr);
+    ::getsockname(acceptor.Fd(), reinterpret_cast<::sockaddr*>(&addr), &len);
+    int client = ::socket(AF_INET, SOCK_STREAM, 0);
+    ::connect(client, reinterpret_cast<::sockaddr*>(&addr), len);
+    std::error_code ec;
+    while (true) {
+        if (auto accepted = acceptor.Accept(ec)) {
+            return {std::move(accepted->first), client};
+        }
+        std::this_thread::yield();
+    }
+}
+
+// Payloads of `state.range(0)` bytes from an EpollContext to a client draining them on another
+// thread, sent with sendmsg() (`state.range(1)` 0) or MSG_ZEROCOPY (1).
+//
+// Over loopback the kernel has to copy zero-copy sends after all, when they are delivered locally,
+// so this shows the cost of the notifications; run it across a real NIC, e.g. by pointing the
+// client elsewhere, to see the copy saved.
+void BM_SendPayload(benchmark::State& state) {
+    auto size = static_cast<size_t>(state.range(0));
+    bool zero_copy = state.range(1) != 0;
+    fuchsia::EpollContext context;
+    std::jthread thread([&]() { context.Run(); });
+    auto [server, client] = MakeConnection(context);
+    // Stop the context before the socket is closed.
+    fuchsia::ScopeGuard guard{[&]() noexcept {
+        context.Stop();
+        thread.join();
+    }};
+
+    std::jthread drain([client = client]() {
+        std::vector<char> buffer(1 << 20);
+        while (::recv(client, buffer.data(), buffer.size(), 0) > 0) {
+        }
+    });
+
+    std::vector<char> payload(size, 'x');
+    fuchsia::ConstBuffer buffer{payload.data(), payload.size()};
+    auto send = [&]() -> exec::task<size_t> {
+        if (zero_copy) {
+            co_return co_await fuchsia::AsyncSendZeroCopy(server, buffer);
+        }
+        co_return co_await fuchsia::AsyncSendAll(server, buffer);
+    };
+    for (auto _ : state) {
+        stdexec::sync_wait(stdexec::on(context.GetScheduler(), send()));
+    }
+    ::shutdown(client, SHUT_RDWR);
+    drain.join();
+    ::close(client);
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+}
+
+}  // namespace
+
+BENCHMARK(BM_SendPayload)
+    ->ArgsProduct({benchmark::CreateRange(4 << 10, 16 << 20, 4), {0, 1}})
+    ->ArgNames({"size", "zero_copy"})
+    ->UseRealTime();
@@ -0,0 +1,76 @@
+//
+// Created by wenjuxu on 2023/8/24.
+//
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "fuchsia/http/mux.h"
+
+namespace {
+
+std::atomic<size_t> allocations = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+namespace {
+
+exec::task<void> Noop(const fuchsia::http::Request&, fuchsia::http::Response&) { co_return; }
+
+// `state.range(0)` routes shaped like a REST api: a few services with many resources each, half of
+// them with an `{id}` segment. Looks up paths of random routes, with a query string.
+void BM_ServeMuxMatch(benchmark::State& state) {
+    fuchsia::http::ServeMux mux;
+    std::vector<std::string> paths;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        auto base = "/api/v" + std::to_string(i % 3) + "/service" + std::to_string(i % 7) +
+                    "/resource" + std::to_string(i);
+        if (i % 2 == 0) {
+            mux.HandleFunc(base, Noop);
+            paths.push_back(base + "?page=2");
+        } else {
+            mux.HandleFunc(base + "/{id}/items", Noop);
+            paths.push_back(base + "/12345/items");
+        }
+    }
+    mux.HandleFunc("/static/", Noop);
+
+    constexpr size_t kOrderSize = 4096;  // a power of 2, so that picking the next is cheap
+    std::mt19937 rng{42};
+    std::vector<std::string_view> order(kOrderSize);
+    for (auto& path : order) {
+        path = paths[rng() % paths.size()];
+    }
+
+    fuchsia::http::RouteParams params;
+    size_t n = 0;
+    auto allocations_before = allocations.load();
+    for (auto _ : state) {
+        auto handler = mux.Match(order[n++ & (kOrderSize - 1)], params);
+        benchmark::DoNotOptimize(handler);
+    }
+    state.counters["allocs"] =
+        benchmark::Counter(static_cast<double>(allocations.load() - allocations_before),
+                           benchmark::Counter::kAvgIterations);
+}
+
+}  // namespace
+
+BENCHMARK(BM_ServeMuxMatch)->Arg(10)->Arg(100)->Arg(1000);
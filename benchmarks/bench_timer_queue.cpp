@@ -0,0 +1,80 @@
+//
+// Created by wenjuxu on 2023/8/16.
+//
+
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "fuchsia/timing_wheel.h"
+
+namespace {
+
+using TimePoint = std::chrono::steady_clock::time_point;
+
+struct Timer {
+    TimePoint expiration;
+    Timer* prev = nullptr;
+    Timer* next = nullptr;
+    uint32_t bucket = fuchsia::kNoTimingWheelBucket;
+};
+
+// `state.range(0)` timers are pending with random timeouts in [0, 60s), like the idle timeouts of
+// as many connections. Measures arming one more timeout and cancelling it again, the common case
+// for an I/O operation that completes before its deadline.
+void BM_TimerArmCancel(benchmark::State& state) {
+    auto start = TimePoint::clock::now();
+    fuchsia::TimingWheel<Timer> wheel{start};
+
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<int64_t> dist{0, 60'000};
+    std::vector<Timer> timers(state.range(0));
+    for (auto& timer : timers) {
+        timer.expiration = start + std::chrono::milliseconds{dist(rng)};
+        wheel.Push(&timer);
+    }
+
+    Timer timer;
+    for (auto _ : state) {
+        timer.expiration = start + std::chrono::milliseconds{dist(rng)};
+        wheel.Push(&timer);
+        wheel.Remove(&timer);
+        benchmark::ClobberMemory();
+    }
+
+    for (auto& t : timers) {
+        wheel.Remove(&t);
+    }
+}
+
+// Arm every timer and let all of them expire, advancing time by 1ms per pop.
+void BM_TimerArmExpire(benchmark::State& state) {
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<int64_t> dist{0, 60'000};
+    std::vector<Timer> timers(state.range(0));
+
+    for (auto _ : state) {
+        auto start = TimePoint::clock::now();
+        fuchsia::TimingWheel<Timer> wheel{start};
+        for (auto& timer : timers) {
+            timer.expiration = start + std::chrono::milliseconds{dist(rng)};
+            wheel.Push(&timer);
+        }
+        for (auto now = start; !wheel.Empty(); now += std::chrono::milliseconds{1}) {
+            auto expired = wheel.PopExpired(now);
+            while (!expired.Empty()) {
+                benchmark::DoNotOptimize(expired.PopFront());
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}  // namespace
+
+BENCHMARK(BM_TimerArmCancel)->Arg(1'000)->Arg(100'000)->Arg(1'000'000);
+BENCHMARK(BM_TimerArmExpire)
+    ->Arg(1'000)
+    ->Arg(100'000)
+    ->Arg(1'000'000)
+    ->Unit(benchmark::kMillisecond);
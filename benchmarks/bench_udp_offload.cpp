@@ -0,0 +1,146 @@
+//
+// Created by wenjuxu on 2023/8/31.
+//
+
+#include <sys/resource.h>
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "exec/async_scope.hpp"
+#include "exec/task.hpp"
+#include "fuchsia/epoll_context.h"
+#include "fuchsia/net/udp.h"
+#include "fuchsia/scope_guard.h"
+#include "fuchsia/socket_recv_many_op.h"
+
+namespace {
+
+constexpr size_t kSegmentSize = 1200;
+constexpr size_t kSegmentsPerSend = 50;  // 60000 bytes, within the 64KB of one GSO send
+
+enum class Mode { Plain, Gso, GsoGro };
+
+using RecvDatagram = fuchsia::net::Datagram<fuchsia::net::Udp, fuchsia::MutableBuffer>;
+
+// Receive until an empty datagram arrives, counting datagrams, coalesced ones included.
+exec::task<void> Receive(fuchsia::net::Udp::Socket& socket, std::atomic<size_t>& received,
+                         std::atomic<bool>& done) {
+    std::vector<char> storage(fuchsia::net::kMaxDatagramBatch * 65536);
+    std::array<RecvDatagram, fuchsia::net::kMaxDatagramBatch> datagrams;
+    for (size_t i = 0; i < datagrams.size(); ++i) {
+        datagrams[i].buffer = fuchsia::MutableBuffer{storage.data() + i * 65536, 65536};
+    }
+    while (true) {
+        size_t n = co_await fuchsia::AsyncRecvMany(socket, datagrams);
+        size_t count = 0;
+        for (size_t i = 0; i < n; ++i) {
+            auto& datagram = datagrams[i];
+            if (datagram.size == 0) {
+                done = true;
+                co_return;
+            }
+            count += datagram.segment_size == 0
+                         ? 1
+                         : (datagram.size + datagram.segment_size - 1) / datagram.segment_size;
+        }
+        received.fetch_add(count, std::memory_order_relaxed);
+    }
+}
+
+double CpuSeconds() {
+    ::rusage usage{};
+    ::getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+}
+
+// Datagrams of 1200 bytes over loopback: the benchmark thread sends, an EpollContext receives with
+// AsyncRecvMany(). Each iteration sends 50 datagrams, either as 50 messages of one sendmmsg()
+// (Plain), or as one message split by the kernel (Gso), optionally received coalesced (GsoGro).
+void BM_UdpOffload(benchmark::State& state) {
+    auto mode = static_cast<Mode>(state.range(0));
+    fuchsia::EpollContext context;
+    std::jthread thread([&]() { context.Run(); });
+    fuchsia::net::Udp::Endpoint loopback{fuchsia::net::AddressV4::Loopback(), 0};
+    fuchsia::net::Udp::Socket receiver{context, loopback};
+    fuchsia::net::Udp::Socket sender{context, loopback};
+    fuchsia::net::Udp::Socket control{context, loopback};  // sends the final empty datagrams
+    // Stop the context before the sockets are closed.
+    fuchsia::ScopeGuard guard{[&]() noexcept {
+        context.Stop();
+        thread.join();
+    }};
+    int rcvbuf = 64 << 20;
+    ::setsockopt(receiver.Fd(), SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    try {
+        receiver.SetUdpGro(mode == Mode::GsoGro);
+        if (mode != Mode::Plain) {
+            sender.SetUdpSegment(kSegmentSize);
+        }
+    } catch (const std::system_error& e) {
+        state.SkipWithError(e.what());
+        return;
+    }
+    fuchsia::net::Udp::Endpoint destination;
+    ::socklen_t len = fuchsia::net::Udp::Endpoint::Capacity();
+    ::getsockname(receiver.Fd(), destination.Data(), &len);
+
+    std::atomic<size_t> received = 0;
+    std::atomic<bool> done = false;
+    exec::async_scope scope;
+    scope.spawn(stdexec::on(context.GetScheduler(), Receive(receiver, received, done)));
+
+    std::vector<char> payload(kSegmentSize * kSegmentsPerSend, 'x');
+    std::array<::iovec, kSegmentsPerSend> iovecs{};
+    std::array<::mmsghdr, kSegmentsPerSend> msgs{};
+    size_t messages = mode == Mode::Plain ? kSegmentsPerSend : 1;
+    for (size_t i = 0; i < messages; ++i) {
+        size_t size = mode == Mode::Plain ? kSegmentSize : payload.size();
+        iovecs[i] = {payload.data() + i * kSegmentSize, size};
+        msgs[i].msg_hdr.msg_name = destination.Data();
+        msgs[i].msg_hdr.msg_namelen = destination.Size();
+        msgs[i].msg_hdr.msg_iov = &iovecs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    size_t sent = 0;
+    auto cpu_start = CpuSeconds();
+    for (auto _ : state) {
+        size_t offset = 0;
+        while (offset < messages) {
+            std::error_code ec;
+            auto n = sender.SendMMsg(msgs.data() + offset, messages - offset, ec);
+            if (n.has_value()) {
+                offset += n.value();
+            }
+        }
+        sent += kSegmentsPerSend;
+    }
+    // Wait for the receiver to drain what made it into the socket buffer.
+    while (!done) {
+        std::error_code ec;
+        control.SendTo(nullptr, 0, destination, ec);
+        std::this_thread::yield();
+    }
+    auto cpu_seconds = CpuSeconds() - cpu_start;
+    stdexec::sync_wait(scope.on_empty());
+
+    state.counters["sent_pps"] = benchmark::Counter(static_cast<double>(sent),
+                                                    benchmark::Counter::kIsRate);
+    state.counters["recv_pps"] = benchmark::Counter(static_cast<double>(received.load()),
+                                                    benchmark::Counter::kIsRate);
+    state.counters["cpu_ns_per_pkt"] =
+        received.load() == 0 ? 0 : cpu_seconds * 1e9 / static_cast<double>(received.load());
+}
+
+}  // namespace
+
+BENCHMARK(BM_UdpOffload)
+    ->Arg(static_cast<int>(Mode::Plain))
+    ->Arg(static_cast<int>(Mode::Gso))
+    ->Arg(static_cast<int>(Mode::GsoGro))
+    ->UseRealTime();
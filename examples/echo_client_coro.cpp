@@ -0,0 +1,53 @@
+//
+// Created by wenjuxu on 2023/8/28.
+//
+
+#include "exec/async_scope.hpp"
+#include "exec/task.hpp"
+#include "fuchsia/epoll_context.h"
+#include "fuchsia/net/tcp.h"
+#include "fuchsia/scope_guard.h"
+#include "fuchsia/socket_connect_op.h"
+#include "fuchsia/socket_recv_exactly_op.h"
+#include "fuchsia/socket_send_all_op.h"
+#include "spdlog/spdlog.h"
+
+// Talks to echo_server_coro with many connections at once, all from one reactor thread.
+constexpr int kNumConnections = 1000;
+constexpr int kNumRounds = 10;
+
+exec::task<void> echo(fuchsia::EpollContext& context, fuchsia::net::Tcp::Endpoint ep,
+                      int id) noexcept {
+    try {
+        fuchsia::net::Tcp::Socket socket{context, fuchsia::net::Tcp::V4()};
+        co_await fuchsia::AsyncConnect(socket, ep);
+        char message[] = "ping";
+        char buffer[sizeof(message)];
+        for (int i = 0; i < kNumRounds; ++i) {
+            co_await fuchsia::AsyncSendAll(socket, fuchsia::Buffer(message));
+            co_await fuchsia::AsyncRecvExactly(socket, fuchsia::Buffer(buffer));
+        }
+        spdlog::debug("Connection {} done", id);
+    } catch (std::system_error& e) {
+        spdlog::error("Connection {} failed: {}", id, e.what());
+    }
+}
+
+int main() {
+    spdlog::set_level(spdlog::level::info);
+
+    fuchsia::EpollContext context;
+    std::jthread thread([&]() { context.Run(); });
+    fuchsia::ScopeGuard guard{[&]() noexcept { context.Stop(); }};
+
+    fuchsia::net::Tcp::Endpoint ep{fuchsia::net::AddressV4::Loopback(), 9876};
+    spdlog::info("Connecting {} times to {}", kNumConnections, ep.ToString());
+
+    exec::async_scope scope;
+    for (int id = 0; id < kNumConnections; ++id) {
+        scope.spawn(stdexec::on(context.GetScheduler(), echo(context, ep, id)));
+    }
+    stdexec::sync_wait(scope.on_empty());
+    spdlog::info("All connections done");
+    return 0;
+}
@@ -26,15 +26,18 @@ int main() {
     spdlog::set_level(spdlog::level::info);
 
     fuchsia::EpollContext context;
-    std::jthread thread([&]() { context.Run(); });
-    fuchsia::ScopeGuard guard{[&]() noexcept { context.Stop(); }};
-
     fuchsia::net::Tcp::Endpoint ep{fuchsia::net::AddressV4::Any(), 9876};
     fuchsia::net::Tcp::Acceptor acceptor{context, ep};
-    spdlog::info("Server listening on {}", ep.ToString());
-
     std::unordered_map<uint32_t, client> clients;
 
+    // Declared after the sockets, so that the context is stopped before they are closed.
+    std::jthread thread([&]() { context.Run(); });
+    fuchsia::ScopeGuard guard{[&]() noexcept {
+        context.Stop();
+        thread.join();
+    }};
+    spdlog::info("Server listening on {}", ep.ToString());
+
     // clang-format off
     stdexec::sender auto task =
         fuchsia::AsyncAccept(acceptor)
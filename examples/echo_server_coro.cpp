@@ -59,11 +59,16 @@ int main() {
     spdlog::set_level(spdlog::level::trace);
 
     fuchsia::EpollContext context;
-    std::jthread thread([&]() { context.Run(); });
-    fuchsia::ScopeGuard guard{[&]() noexcept { context.Stop(); }};
-
     fuchsia::net::Tcp::Endpoint ep{fuchsia::net::AddressV4::Any(), 9876};
     fuchsia::net::Tcp::Acceptor acceptor{context, ep};
+
+    // Declared after the acceptor, so that the context is stopped before the sockets are closed.
+    std::jthread thread([&]() { context.Run(); });
+    fuchsia::ScopeGuard guard{[&]() noexcept {
+        context.Stop();
+        thread.join();
+        clients.clear();
+    }};
     spdlog::info("Server listening on {}", ep.ToString());
 
     stdexec::scheduler auto scheduler = context.GetScheduler();
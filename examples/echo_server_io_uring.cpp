@@ -0,0 +1,54 @@
+//
+// Created by wenjuxu on 2023/8/13.
+//
+
+#include "exec/async_scope.hpp"
+#include "exec/task.hpp"
+#include "fuchsia/io_uring_context.h"
+#include "fuchsia/net/tcp.h"
+#include "fuchsia/scope_guard.h"
+#include "spdlog/spdlog.h"
+
+// Same as echo_server_coro, but driven by IoUringContext instead of EpollContext.
+
+using Socket = fuchsia::net::Socket<fuchsia::net::Tcp, fuchsia::IoUringContext>;
+using Acceptor = fuchsia::net::Acceptor<fuchsia::net::Tcp, fuchsia::IoUringContext>;
+
+exec::task<void> echo(Socket socket) noexcept {
+    char buffer[1024];
+    try {
+        while (true) {
+            size_t n1 = co_await fuchsia::AsyncRecvSome(socket, fuchsia::Buffer(buffer));
+            spdlog::info("Received {} bytes from client {}", n1, socket.Fd());
+            size_t n2 = co_await fuchsia::AsyncSendSome(socket, fuchsia::Buffer(buffer, n1));
+            spdlog::info("Sent {} bytes to client {}", n2, socket.Fd());
+        }
+    } catch (std::system_error& e) {
+        spdlog::info("Client {} disconnected: {}", socket.Fd(), e.what());
+    }
+}
+
+exec::task<void> run(auto&& scheduler, auto&& acceptor) noexcept {
+    exec::async_scope scope;
+    while (true) {
+        auto socket = co_await fuchsia::AsyncAccept(acceptor);
+        spdlog::info("Client connected: {}", socket.Fd());
+        scope.spawn(stdexec::on(scheduler, echo(std::move(socket))));
+    }
+}
+
+int main() {
+    spdlog::set_level(spdlog::level::trace);
+
+    fuchsia::IoUringContext context;
+    std::jthread thread([&]() { context.Run(); });
+    fuchsia::ScopeGuard guard{[&]() noexcept { context.Stop(); }};
+
+    fuchsia::net::Tcp::Endpoint ep{fuchsia::net::AddressV4::Any(), 9876};
+    Acceptor acceptor{context, ep};
+    spdlog::info("Server listening on {}", ep.ToString());
+
+    stdexec::scheduler auto scheduler = context.GetScheduler();
+    stdexec::sync_wait(run(scheduler, acceptor));
+    return 0;
+}
@@ -2,7 +2,9 @@
 // Created by wenjuxu on 2023/7/30.
 //
 
+#include "fuchsia/http/file_server.h"
 #include "fuchsia/http/server.h"
+#include "fuchsia/work_stealing_pool.h"
 #include "spdlog/spdlog.h"
 
 exec::task<void> HandleHello(const fuchsia::http::Request& req, fuchsia::http::Response& resp) {
@@ -23,13 +25,45 @@ exec::task<void> HandleJson(const fuchsia::http::Request& req, fuchsia::http::Re
     co_return;
 }
 
+// Rendered once, sent as a single buffer.
+exec::task<void> HandleHealth(const fuchsia::http::Request& req, fuchsia::http::Response& resp) {
+    static const fuchsia::http::StaticResponse kHealthy{fuchsia::http::StatusCode::Ok, "ok"};
+    resp.SetStaticResponse(kHealthy);
+    co_return;
+}
+
+exec::task<void> HandleUser(const fuchsia::http::Request& req, fuchsia::http::Response& resp) {
+    resp.WriteBody("user ");
+    resp.WriteBody(req.Param("id"));
+    co_return;
+}
+
+static uint64_t Fibonacci(uint64_t n) { return n < 2 ? n : Fibonacci(n - 1) + Fibonacci(n - 2); }
+
+// CPU-bound work is offloaded to the worker pool, the reactor keeps serving other sessions.
+exec::task<void> HandleFibonacci(fuchsia::WorkStealingPool& pool, const fuchsia::http::Request& req,
+                                 fuchsia::http::Response& resp) {
+    auto result = co_await fuchsia::Offload(pool, [] { return Fibonacci(30); });
+    resp.WriteBody(std::to_string(result));
+}
+
 int main() {
     spdlog::set_level(spdlog::level::trace);
 
-    fuchsia::http::Server server("0.0.0.0", 8080);
+    fuchsia::http::Server server("0.0.0.0", 8080,
+                                 {.num_threads = std::thread::hardware_concurrency()});
+    fuchsia::WorkStealingPool workers;
+    fuchsia::http::FileServer files{".", "/static/"};  // the working directory, with sendfile()
     fuchsia::http::ServeMux mux;
     mux.HandleFunc("/hello", HandleHello);
     mux.HandleFunc("/hello-keep-alive", HandleHelloKeepAlive);  // for benchmark
     mux.HandleFunc("/json", HandleJson);
+    mux.HandleFunc("/users/{id}", HandleUser);
+    mux.HandleFunc("/health", HandleHealth);
+    mux.HandleFunc("/static/", files.Handler());
+    mux.HandleFunc("/fib", [&workers](const fuchsia::http::Request& req,
+                                      fuchsia::http::Response& resp) {
+        return HandleFibonacci(workers, req, resp);
+    });
     server.Serve(mux);
 }
@@ -13,6 +13,9 @@
 
 namespace fuchsia {
 
+// A multi-producer single-consumer queue. Besides being empty, the queue can be marked inactive by
+// the consumer right before it goes to sleep, and the producer whose push takes the queue out of
+// the inactive state is told so, which makes it the only one that needs to wake the consumer up.
 template <IntrusiveQueueNode T>
 class AtomicIntrusiveQueue {
 public:
@@ -25,21 +28,78 @@ public:
 
     ~AtomicIntrusiveQueue() { assert(Empty()); }
 
-    bool Empty() const noexcept { return head_.load(std::memory_order_relaxed) == nullptr; }
+    bool Empty() const noexcept {
+        T* head = head_.load(std::memory_order_relaxed);
+        return head == nullptr || head == Inactive();
+    }
 
-    void PushFront(T* item) noexcept {
+    // Returns true if the queue was inactive, the caller is then responsible for waking the
+    // consumer up.
+    bool PushFront(T* item) noexcept {
         T* old_head = head_.load(std::memory_order_relaxed);
         do {
-            item->next = old_head;
+            item->next = old_head == Inactive() ? nullptr : old_head;
         } while (!head_.compare_exchange_weak(old_head, item, std::memory_order_acq_rel));
+        return old_head == Inactive();
+    }
+
+    // Push all `items` with a single CAS, they are popped in the order they have in `items`.
+    // Returns true if the queue was inactive, same as PushFront().
+    bool PushAllFront(IntrusiveQueue<T>&& items) noexcept {
+        if (items.Empty()) {
+            return false;
+        }
+        // Reverse the items into a stack, as if they were pushed one by one.
+        T* top = nullptr;
+        T* bottom = nullptr;
+        while (!items.Empty()) {
+            T* item = items.PopFront();
+            item->next = top;
+            if (top == nullptr) {
+                bottom = item;
+            }
+            top = item;
+        }
+
+        T* old_head = head_.load(std::memory_order_relaxed);
+        do {
+            bottom->next = old_head == Inactive() ? nullptr : old_head;
+        } while (!head_.compare_exchange_weak(old_head, top, std::memory_order_acq_rel));
+        return old_head == Inactive();
     }
 
+    // Consumer only. Mark the queue inactive if it is empty, returns false if it is not empty, in
+    // which case the consumer must not go to sleep.
+    bool TryMarkInactive() noexcept {
+        T* old_head = nullptr;
+        if (head_.compare_exchange_strong(old_head, Inactive(), std::memory_order_acq_rel)) {
+            return true;
+        }
+        return old_head == Inactive();
+    }
+
+    // Consumer only. Mark the queue active again after the consumer is woken up, so that pushes
+    // from now on do not wake it up again.
+    void MarkActive() noexcept {
+        T* old_head = Inactive();
+        head_.compare_exchange_strong(old_head, nullptr, std::memory_order_acq_rel);
+    }
+
+    // Consumer only. This also marks the queue active.
     IntrusiveQueue<T> PopAll() noexcept {
         T* old_head = head_.exchange(nullptr, std::memory_order_acq_rel);
+        if (old_head == Inactive()) {
+            return {};
+        }
         return IntrusiveQueue<T>::MakeReversed(old_head);
     }
 
 private:
+    // A sentinel that can never be a valid item.
+    T* Inactive() const noexcept {
+        return static_cast<T*>(static_cast<void*>(const_cast<std::atomic<T*>*>(&head_)));
+    }
+
     std::atomic<T*> head_ = nullptr;
 };
 
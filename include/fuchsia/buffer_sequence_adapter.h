@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <algorithm>
+
 #include "fuchsia/buffer.h"
 #include "sys/uio.h"
 
@@ -33,6 +35,20 @@ protected:
         InitIovBase(iov.iov_base, const_cast<void*>(buf.Data()));
         iov.iov_len = buf.Size();
     }
+
+    // Drop the first `n` bytes of `iovs`, returns the number of buffers used up entirely.
+    static constexpr std::size_t AdvanceNativeBuffers(iovec* iovs, std::size_t count,
+                                                      std::size_t n) {
+        std::size_t i = 0;
+        for (; i < count && n >= iovs[i].iov_len; ++i) {
+            n -= iovs[i].iov_len;
+        }
+        if (i < count) {
+            iovs[i].iov_base = static_cast<char*>(iovs[i].iov_base) + n;
+            iovs[i].iov_len -= n;
+        }
+        return i;
+    }
 };
 
 template <typename Buffer, typename BufferSequence>
@@ -41,18 +57,26 @@ public:
     static constexpr bool IsSingleBuffer = false;
 
     explicit constexpr BufferSequenceAdapter(const BufferSequence& sequence) noexcept
-        : count_(0), total_buffer_size_(0) {
+        : first_(0), count_(0), total_buffer_size_(0) {
         BufferSequenceAdapter::Init(BufferSequenceBegin(sequence), BufferSequenceEnd(sequence));
     }
 
-    constexpr NativeBufferType* Buffers() noexcept { return buffers_; }
+    constexpr NativeBufferType* Buffers() noexcept { return buffers_ + first_; }
 
-    constexpr std::size_t Count() const noexcept { return count_; }
+    constexpr std::size_t Count() const noexcept { return count_ - first_; }
 
     constexpr std::size_t TotalSize() const noexcept { return total_buffer_size_; }
 
     constexpr bool AllEmpty() const noexcept { return total_buffer_size_ == 0; }
 
+    // Consume the first `n` bytes in place, e.g. after a partial write, so that Buffers() and
+    // Count() describe the rest.
+    constexpr void Advance(std::size_t n) noexcept {
+        n = std::min(n, total_buffer_size_);
+        first_ += AdvanceNativeBuffers(buffers_ + first_, count_ - first_, n);
+        total_buffer_size_ -= n;
+    }
+
     static constexpr bool AllEmpty(const BufferSequence& sequence) noexcept {
         return BufferSequenceAdapter::AllEmpty(BufferSequenceBegin(sequence),
                                                BufferSequenceEnd(sequence));
@@ -96,6 +120,7 @@ private:
     }
 
     NativeBufferType buffers_[MaxBuffers];
+    std::size_t first_;
     std::size_t count_;
     std::size_t total_buffer_size_;
 };
@@ -118,6 +143,12 @@ public:
 
     constexpr bool AllEmpty() const noexcept { return total_buffer_size_ == 0; }
 
+    constexpr void Advance(std::size_t n) noexcept {
+        n = std::min(n, total_buffer_size_);
+        AdvanceNativeBuffers(&buffer_, 1, n);
+        total_buffer_size_ -= n;
+    }
+
     static constexpr bool AllEmpty(const MutableBuffer& sequence) noexcept {
         return sequence.Size() == 0;
     }
@@ -149,6 +180,12 @@ public:
 
     constexpr bool AllEmpty() const noexcept { return total_buffer_size_ == 0; }
 
+    constexpr void Advance(std::size_t n) noexcept {
+        n = std::min(n, total_buffer_size_);
+        AdvanceNativeBuffers(&buffer_, 1, n);
+        total_buffer_size_ -= n;
+    }
+
     static constexpr bool AllEmpty(const ConstBuffer& sequence) noexcept {
         return sequence.Size() == 0;
     }
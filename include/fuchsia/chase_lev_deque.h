@@ -0,0 +1,94 @@
+//
+// Created by wenjuxu on 2023/8/19.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+
+namespace fuchsia {
+
+// A fixed capacity Chase-Lev work-stealing deque of pointers, see "Correct and Efficient
+// Work-Stealing for Weak Memory Models" (Lê et al., 2013). The owner thread pushes and pops at the
+// bottom (LIFO), any other thread steals from the top (FIFO).
+template <typename T>
+class ChaseLevDeque {
+public:
+    // `capacity` must be a power of two.
+    explicit ChaseLevDeque(size_t capacity)
+        : mask_(capacity - 1), buffer_(std::make_unique<std::atomic<T*>[]>(capacity)) {
+        assert(capacity > 0 && (capacity & mask_) == 0);
+    }
+
+    ChaseLevDeque(const ChaseLevDeque&) = delete;
+    ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+    size_t Capacity() const noexcept { return mask_ + 1; }
+
+    // Any thread, it is only a snapshot.
+    bool Empty() const noexcept {
+        return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+    }
+
+    // Owner only. Returns false if the deque is full.
+    bool Push(T* item) noexcept {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        if (b - t > static_cast<int64_t>(mask_)) {
+            return false;
+        }
+        buffer_[b & mask_].store(item, std::memory_order_relaxed);
+        bottom_.store(b + 1, std::memory_order_release);  // publishes the item to thieves
+        return true;
+    }
+
+    // Owner only. Returns nullptr if the deque is empty.
+    T* Pop() noexcept {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        if (t > b) {
+            // empty
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T* item = buffer_[b & mask_].load(std::memory_order_relaxed);
+        if (t == b) {
+            // the last item, race against thieves
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                              std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // Any thread. Returns nullptr if the deque is empty or the race for the top item is lost.
+    T* Steal() noexcept {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) {
+            return nullptr;
+        }
+        T* item = buffer_[t & mask_].load(std::memory_order_relaxed);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+private:
+    alignas(64) std::atomic<int64_t> top_ = 0;
+    alignas(64) std::atomic<int64_t> bottom_ = 0;
+    size_t mask_;
+    std::unique_ptr<std::atomic<T*>[]> buffer_;
+};
+
+}  // namespace fuchsia
@@ -0,0 +1,111 @@
+//
+// Created by wenjuxu on 2023/9/5.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+
+#include "fuchsia/buffer.h"
+
+namespace fuchsia {
+
+// A growable buffer for reads of unknown length, e.g. a request head read up to its blank line:
+// bytes are read into Prepare()d space and Commit()ted, then parsed from Data() and Consume()d.
+// The readable bytes are kept contiguous, so they can be searched and parsed in one go; Prepare()
+// moves them back to the front, or into a larger allocation, only once the space behind them runs
+// out.
+//
+//     fuchsia::DynamicBuffer buf{64 * 1024};
+//     size_t n = co_await fuchsia::AsyncReadUntil(socket, buf, "\r\n\r\n");
+//     Parse(buf.View().substr(0, n));
+//     buf.Consume(n);  // whatever was read past the delimiter stays for the next message
+class DynamicBuffer {
+public:
+    // Reads ask Prepare() for at least that much space, so that small leftovers do not turn into
+    // small reads.
+    static constexpr size_t kMinReadSize = 4096;
+
+    explicit DynamicBuffer(size_t max_size = std::numeric_limits<size_t>::max()) noexcept
+        : max_size_(max_size) {}
+
+    DynamicBuffer(DynamicBuffer&&) noexcept = default;
+    DynamicBuffer& operator=(DynamicBuffer&&) noexcept = default;
+
+    // Number of readable bytes.
+    size_t Size() const noexcept { return end_ - begin_; }
+
+    bool Empty() const noexcept { return begin_ == end_; }
+
+    // The readable bytes may never grow past that.
+    size_t MaxSize() const noexcept { return max_size_; }
+
+    // The readable bytes plus the space around them.
+    size_t Capacity() const noexcept { return capacity_; }
+
+    ConstBuffer Data() const noexcept { return {storage_.get() + begin_, Size()}; }
+
+    std::string_view View() const noexcept { return {storage_.get() + begin_, Size()}; }
+
+    // `n` bytes of writable space behind the readable bytes, invalidating earlier Data() and
+    // Prepare() results. Throws std::length_error if Size() + n would exceed MaxSize().
+    MutableBuffer Prepare(size_t n) {
+        if (n > max_size_ - Size()) {
+            throw std::length_error("DynamicBuffer::Prepare() past max size");
+        }
+        if (n > capacity_ - end_) {
+            size_t size = Size();
+            if (size + n <= capacity_) {
+                std::memmove(storage_.get(), storage_.get() + begin_, size);
+            } else {
+                size_t doubled = capacity_ > max_size_ / 2 ? max_size_ : capacity_ * 2;
+                size_t capacity = std::max(doubled, size + n);
+                std::unique_ptr<char[]> storage{new char[capacity]};
+                if (size > 0) {
+                    std::memcpy(storage.get(), storage_.get() + begin_, size);
+                }
+                storage_ = std::move(storage);
+                capacity_ = capacity;
+            }
+            begin_ = 0;
+            end_ = size;
+        }
+        return {storage_.get() + end_, n};
+    }
+
+    // The size to Prepare() for the next read: at least kMinReadSize or whatever space is left
+    // without growing, within MaxSize(). 0 once the buffer is full.
+    size_t ReadSize() const noexcept {
+        return std::min(std::max(kMinReadSize, capacity_ - Size()), max_size_ - Size());
+    }
+
+    // Make the first `n` bytes of the prepared space readable, once they have been written.
+    void Commit(size_t n) noexcept { end_ += std::min(n, capacity_ - end_); }
+
+    // Drop the first `n` readable bytes.
+    void Consume(size_t n) noexcept {
+        begin_ += std::min(n, Size());
+        if (begin_ == end_) {
+            begin_ = end_ = 0;
+        }
+    }
+
+    void Clear() noexcept { begin_ = end_ = 0; }
+
+private:
+    std::unique_ptr<char[]> storage_;
+    size_t capacity_ = 0;
+    size_t begin_ = 0;
+    size_t end_ = 0;
+    size_t max_size_;
+};
+
+inline ConstBuffer Buffer(const DynamicBuffer& buf) noexcept { return buf.Data(); }
+
+}  // namespace fuchsia
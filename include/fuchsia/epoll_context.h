@@ -6,19 +6,49 @@
 
 #include <atomic>
 #include <chrono>
+#include <deque>
 #include <optional>
+#include <system_error>
 
 #include "exec/timed_scheduler.hpp"
 #include "fuchsia/atomic_intrusive_queue.h"
-#include "fuchsia/intrusive_priority_queue.h"
 #include "fuchsia/intrusive_queue.h"
+#include "fuchsia/operation_base.h"
+#include "fuchsia/slab_allocator.h"
+#include "fuchsia/timing_wheel.h"
 #include "stdexec/execution.hpp"
 
+struct epoll_event;
+
 namespace fuchsia {
 
 class EpollContext {
 public:
+    struct Options {
+        // Run at most this many operations in one iteration of the loop before polling epoll (with
+        // a zero timeout) again, so that a few connections that keep rescheduling themselves cannot
+        // delay readiness events and timers of all others. 0 means no limit.
+        size_t max_operations_per_iteration = 1024;
+
+        // The same budget in time, checked after every operation. 0 means no limit.
+        std::chrono::microseconds max_time_per_iteration{0};
+
+        // Once there is nothing left to do, keep polling epoll and the remote queue for this long
+        // before blocking in epoll_wait. Saves the wakeup latency of a sleeping thread (and the
+        // eventfd writes of remote threads) at the cost of burning a cpu. 0 disables busy polling.
+        std::chrono::microseconds busy_poll_duration{0};
+
+        // What to do between two polls while busy polling.
+        enum class BusyPollYield {
+            Spin,   // nothing, lowest latency
+            Pause,  // a cpu pause hint, friendlier to the sibling hyper-thread
+            Yield,  // sched_yield(), lets other threads of the cpu run
+        };
+        BusyPollYield busy_poll_yield = BusyPollYield::Pause;
+    };
+
     EpollContext();
+    explicit EpollContext(Options options);
     ~EpollContext();
 
     class Scheduler;
@@ -27,24 +57,24 @@ public:
     void Run();
     void Stop() noexcept;
 
-private:
-    struct OperationBase {
-#ifndef NDEBUG
-        uint64_t uuid;
-        static inline std::atomic<uint64_t> uuid_generator = 1;
-        OperationBase() noexcept : uuid(uuid_generator.fetch_add(1, std::memory_order_acq_rel)) {}
-#else
-        OperationBase() noexcept = default;
-#endif
-        // Operations are neither copyable nor movable
-        OperationBase(OperationBase&&) = delete;
-        OperationBase(const OperationBase&) = delete;
-
-        using ExecuteFunction = void(OperationBase*) noexcept;
-        std::atomic<ExecuteFunction*> execute = nullptr;
-        OperationBase* next = nullptr;
+    // Forget the epoll registration of a descriptor before it is closed, so that a new descriptor
+    // reusing the same number is registered afresh. Must be called on the io thread, or while the
+    // context is not running. Sockets call this when they are closed.
+    void ReleaseDescriptor(int fd) noexcept;
+
+    // Counters of the event loop, for observability and benchmarks, readable from any thread.
+    struct Metrics {
+        std::atomic<uint64_t> wakeups = 0;           // eventfd writes to wake up the loop
+        std::atomic<uint64_t> polls = 0;             // epoll_wait calls
+        std::atomic<uint64_t> budget_exhausted = 0;  // iterations cut short by the budget
+        std::atomic<uint64_t> busy_polls = 0;        // epoll_wait calls made while busy polling
     };
 
+    const Metrics& GetMetrics() const noexcept { return metrics_; }
+
+private:
+    using OperationBase = fuchsia::OperationBase;
+
     struct OperationFlags {
         static constexpr uint32_t None = 0;
         static constexpr uint32_t Cancelled = 1 << 0;
@@ -58,42 +88,107 @@ private:
         TimerOperation(EpollContext& context, TimePoint expiration) noexcept
             : context(context), expiration(expiration) {}
 
-        bool operator<(const TimerOperation& other) const noexcept {
-            return expiration < other.expiration;
-        }
-
         EpollContext& context;
         TimePoint expiration;
         TimerOperation* prev = nullptr;
         TimerOperation* next = nullptr;
+        uint32_t bucket = kNoTimingWheelBucket;  // owned by the timer queue
         std::atomic<uint32_t> state = 0;
     };
 
+    // Error waits for EPOLLERR alone, e.g. for notifications on the error queue of a socket.
+    enum class WaitType { Read, Write, Error };
+
+    // Registration state of a descriptor. A descriptor is added to epoll (edge-triggered, for both
+    // directions) the first time an operation on it would block, and stays registered until it is
+    // released. A pending read, a pending write and an operation waiting for the error queue can
+    // wait on the same descriptor at once.
+    struct DescriptorState {
+        int fd = -1;
+        bool registered = false;
+        OperationBase* read_op = nullptr;
+        OperationBase* write_op = nullptr;
+        OperationBase* error_op = nullptr;
+
+        OperationBase*& Slot(WaitType type) noexcept {
+            switch (type) {
+                case WaitType::Read:
+                    return read_op;
+                case WaitType::Write:
+                    return write_op;
+                default:
+                    return error_op;
+            }
+        }
+    };
+
     template <typename Receiver, typename Protocol>
     class SocketOperationBase;
 
     template <typename Receiver, typename Protocol>
     class SocketAcceptOperation;
 
+    template <typename Receiver, typename Protocol>
+    class SocketConnectOperation;
+
     template <typename Receiver, typename Protocol, typename Buffers>
     class SocketSendSomeOperation;
 
     template <typename Receiver, typename Protocol, typename Buffers>
     class SocketRecvSomeOperation;
 
+    template <typename Receiver, typename Protocol, typename Buffers>
+    class SocketSendAllOperation;
+
+    template <typename Receiver, typename Protocol, typename Buffers>
+    class SocketRecvExactlyOperation;
+
+    template <typename Receiver, typename Protocol>
+    class SocketReadUntilOperation;
+
+    template <typename Receiver, typename Protocol>
+    class SocketReadAtLeastOperation;
+
+    template <typename Receiver, typename Protocol, typename Buffers>
+    class SocketSendZeroCopyOperation;
+
+    template <typename Receiver, typename Protocol>
+    class SocketSendFileOperation;
+
+    template <typename Receiver, typename Protocol>
+    class SocketSendToOperation;
+
+    template <typename Receiver, typename Protocol>
+    class SocketRecvFromOperation;
+
+    template <typename Receiver, typename Protocol>
+    class SocketSendManyOperation;
+
+    template <typename Receiver, typename Protocol>
+    class SocketRecvManyOperation;
+
 private:
     void Schedule(OperationBase* op) noexcept;
     void ScheduleLocal(OperationBase* op) noexcept;
     void ScheduleRemote(OperationBase* op) noexcept;
+    // Schedule a whole chain of operations from another thread at once.
+    void ScheduleRemote(IntrusiveQueue<OperationBase>&& ops) noexcept;
     void ScheduleAt(TimerOperation* op) noexcept;
     void RemoveTimer(TimerOperation* op) noexcept;
 
+    // Park `op` until `fd` is ready for `type`, it is scheduled again on the next readiness event.
+    std::error_code WaitDescriptor(int fd, OperationBase* op, WaitType type) noexcept;
+    // Take `op` back out of its slot, returns false if it is not parked there (anymore).
+    bool CancelWait(int fd, OperationBase* op, WaitType type) noexcept;
+
     bool IsRunningOnIOThread() const noexcept;
     void ProcessLocalOperations() noexcept;
     bool ProcessRemoteOperations() noexcept;
     void ProcessTimers() noexcept;
     void UpdateNextExpirationTime() noexcept;
     void BlockingWaitEvents();
+    int WaitEvents(epoll_event* events, int max_events, int timeout);
+    void DispatchEvents(const epoll_event* events, int num_events);
 
     void Wakeup();
     static void Drain(int fd);
@@ -101,16 +196,20 @@ private:
 private:
     using OperationQueue = IntrusiveQueue<OperationBase>;
     using RemoteOperationQueue = AtomicIntrusiveQueue<OperationBase>;
-    using TimerQueue = IntrusivePriorityQueue<TimerOperation>;
+    using TimerQueue = TimingWheel<TimerOperation>;
 
+    Options options_;
+    SlabAllocator allocator_;  // current allocator of the thread while running
     int epoll_fd_ = -1;
     int timer_fd_ = -1;
     int wakeup_fd_ = -1;
     OperationQueue local_operation_queue_;
     RemoteOperationQueue remote_operation_queue_;
     TimerQueue timer_queue_;
+    std::deque<DescriptorState> descriptors_;  // indexed by fd, deque keeps the states in place
     std::optional<TimePoint> next_expiration_time_;
     stdexec::in_place_stop_source stop_source_;
+    Metrics metrics_;
 };
 
 class EpollContext::Scheduler {
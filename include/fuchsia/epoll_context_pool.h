@@ -0,0 +1,49 @@
+//
+// Created by wenjuxu on 2023/8/12.
+//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "fuchsia/epoll_context.h"
+
+namespace fuchsia {
+
+// A fixed set of EpollContexts, each one driven by its own thread (one reactor per core).
+// Operations never migrate between contexts: whatever is started on a context completes there.
+class EpollContextPool {
+public:
+    // Create `size` contexts, if `pin_threads` is set, thread i is pinned to cpu i % ncpus.
+    explicit EpollContextPool(size_t size = std::thread::hardware_concurrency(),
+                              bool pin_threads = false, EpollContext::Options options = {});
+
+    EpollContextPool(const EpollContextPool&) = delete;
+    EpollContextPool& operator=(const EpollContextPool&) = delete;
+
+    ~EpollContextPool();
+
+    size_t Size() const noexcept { return contexts_.size(); }
+
+    EpollContext& At(size_t index) noexcept { return *contexts_[index]; }
+
+    // Pick a context in round-robin order.
+    EpollContext& Next() noexcept;
+
+    // Spawn one thread per context and run them, returns immediately.
+    void Start();
+
+    // Stop all contexts and join their threads.
+    void Stop() noexcept;
+
+private:
+    std::vector<std::unique_ptr<EpollContext>> contexts_;
+    std::vector<std::jthread> threads_;
+    std::atomic<size_t> next_ = 0;
+    bool pin_threads_;
+};
+
+}  // namespace fuchsia
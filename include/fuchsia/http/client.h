@@ -0,0 +1,116 @@
+//
+// Created by wenjuxu on 2023/8/29.
+//
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "exec/task.hpp"
+#include "fuchsia/epoll_context.h"
+#include "fuchsia/http/common.h"
+#include "fuchsia/http/parser.h"
+#include "fuchsia/net/tcp.h"
+
+namespace fuchsia::http {
+
+// A request sent by a Client. A `Host:` header is added unless `headers` has one, and so is
+// `Content-Length:` for a non-empty body.
+struct ClientRequest {
+    std::string method = "GET";
+    std::string target = "/";
+    fuchsia::http::Headers headers;
+    std::string body;
+
+    // Render the request at the end of `out`, `host` going to the `Host:` header.
+    void AppendTo(std::string& out, std::string_view host) const;
+};
+
+// A response received by a Client. Its views point into the receive buffer of the response, they
+// stay valid until the response is used for the next request.
+class ClientResponse : public Parser<MessageType::Response> {
+public:
+    ClientResponse() = default;
+
+    // Whether the server lets the connection be used for another request.
+    bool KeepAlive() const { return llhttp_should_keep_alive(&parser_) != 0; }
+
+private:
+    friend class Client;
+
+    char buffer_[8192]{};
+};
+
+struct ClientOptions {
+    // Idle connections kept per host, the ones beyond are closed after their response.
+    size_t max_idle_per_host = 16;
+
+    // Idle connections older than that are closed rather than reused, servers drop them anyway.
+    std::chrono::milliseconds idle_timeout = std::chrono::seconds(30);
+};
+
+// An HTTP/1.1 client keeping the connections to each host open for reuse. A connection carries one
+// request at a time, so responses can never be mixed up. A request on a pooled connection that
+// turns out to be closed by the server, before any of the response came in, is retried once on a
+// newly opened connection: if it could not be sent, or if its method is idempotent, e.g. a GET but
+// not a POST, which the server may have acted on.
+//
+// A client belongs to one EpollContext, create one per context: it must only be used, and
+// destroyed, on the thread of that context, nothing is synchronized.
+//
+//     fuchsia::http::ClientRequest request{.target = "/users/42"};
+//     fuchsia::http::ClientResponse response;
+//     co_await client.Send(upstream, request, response);
+class Client {
+public:
+    explicit Client(fuchsia::EpollContext& context, ClientOptions options = {})
+        : context_(context), options_(options) {}
+
+    Client(const Client&) = delete;
+
+    // Send `request` to `endpoint` and receive the answer into `response`. Throws std::system_error
+    // if the connection fails and the request is not retried, with std::errc::bad_message for a
+    // malformed response.
+    exec::task<void> Send(const fuchsia::net::Tcp::Endpoint& endpoint,
+                          const ClientRequest& request, ClientResponse& response);
+
+    // Number of idle connections to `endpoint`.
+    size_t IdleConnections(const fuchsia::net::Tcp::Endpoint& endpoint) const;
+
+private:
+    using TimePoint = EpollContext::TimePoint;
+
+    struct Connection {
+        Connection(fuchsia::EpollContext& context, fuchsia::net::Tcp protocol)
+            : socket(context, protocol) {}
+
+        fuchsia::net::Tcp::Socket socket;
+        std::string write_buffer;
+        TimePoint idle_since;
+    };
+
+    struct Host {
+        std::string name;  // for the `Host:` header
+        std::vector<std::unique_ptr<Connection>> idle;  // the most recently used last
+    };
+
+    // A pooled connection to `host`, or nullptr if there is none fresh enough.
+    std::unique_ptr<Connection> Checkout(Host& host);
+
+    void Checkin(Host& host, std::unique_ptr<Connection> connection);
+
+    // Read the response to the request just sent, `received` tells whether any of it came in.
+    // Returns whether the connection can be reused.
+    static exec::task<bool> Receive(Connection& connection, ClientResponse& response,
+                                    bool& received);
+
+    fuchsia::EpollContext& context_;
+    ClientOptions options_;
+    std::map<fuchsia::net::Tcp::Endpoint, Host> hosts_;
+};
+
+}  // namespace fuchsia::http
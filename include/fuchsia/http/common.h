@@ -4,6 +4,19 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
 namespace fuchsia::http {
 
 struct HttpVersion {
@@ -18,6 +31,55 @@ struct Header {
 
 using Headers = std::vector<Header>;
 
+// A parsed header, the views point into the message it was parsed from.
+struct HeaderView {
+    std::string_view key{};
+    std::string_view value{};
+};
+
+using HeaderViews = std::vector<HeaderView>;
+
+// The values of the `{name}` segments of the ServeMux pattern a request matched, as views into the
+// url, and the names as views into the ServeMux.
+class RouteParams {
+public:
+    static constexpr size_t kMaxParams = 8;
+
+    std::string_view Get(std::string_view name) const {
+        for (size_t i = 0; i < size_; ++i) {
+            if (params_[i].first == name) {
+                return params_[i].second;
+            }
+        }
+        return {};
+    }
+
+    size_t Size() const { return size_; }
+
+    bool Empty() const { return size_ == 0; }
+
+    const std::pair<std::string_view, std::string_view>& operator[](size_t i) const {
+        return params_[i];
+    }
+
+    bool Push(std::string_view name, std::string_view value) {
+        if (size_ == kMaxParams) {
+            return false;
+        }
+        params_[size_++] = {name, value};
+        return true;
+    }
+
+    // Drop the parameters after the first `size`.
+    void Truncate(size_t size) { size_ = std::min(size, size_); }
+
+    void Clear() { size_ = 0; }
+
+private:
+    std::array<std::pair<std::string_view, std::string_view>, kMaxParams> params_{};
+    size_t size_ = 0;
+};
+
 #define HTTP_STATUS_MAP(XX)                                               \
     XX(100, Continue, Continue)                                           \
     XX(101, SwitchingProtocols, Switching Protocols)                      \
@@ -98,4 +160,129 @@ inline std::string_view StatusCodeToString(StatusCode status_code) {
     }
 }
 
+// The whole status line, e.g. `HTTP/1.1 200 OK\r\n`, rendered at compile time.
+inline std::string_view StatusLine(StatusCode status_code) {
+    switch (status_code) {
+#define XX(num, name, string) \
+    case name:                \
+        return "HTTP/1.1 " #num " " #string "\r\n";
+        HTTP_STATUS_MAP(XX)
+#undef XX
+    }
+    return "HTTP/1.1 500 Internal Server Error\r\n";
+}
+
+// Format `value` in decimal at the end of `buffer`, returns the digits.
+inline std::string_view FormatDecimal(char (&buffer)[20], uint64_t value) {
+    char* end = buffer + sizeof(buffer);
+    char* begin = end;
+    do {
+        *--begin = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    return {begin, static_cast<size_t>(end - begin)};
+}
+
+// Format an HTTP date, e.g. `Sat, 26 Aug 2023 08:49:37 GMT`.
+inline std::string_view FormatHttpDate(char (&buffer)[32], std::time_t time) {
+    std::tm tm{};
+    ::gmtime_r(&time, &tm);
+    return {buffer, std::strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &tm)};
+}
+
+// Parse an HTTP date, in the format of FormatHttpDate() or in one of the obsolete RFC 850 and
+// asctime() ones that recipients still have to accept (RFC 9110 5.6.7), nullopt if it is neither.
+inline std::optional<std::time_t> ParseHttpDate(std::string_view date) {
+    char buffer[64];
+    if (date.size() >= sizeof(buffer)) {
+        return std::nullopt;
+    }
+    std::memcpy(buffer, date.data(), date.size());
+    buffer[date.size()] = '\0';
+    for (const char* format :
+         {"%a, %d %b %Y %H:%M:%S GMT", "%A, %d-%b-%y %H:%M:%S GMT", "%a %b %e %H:%M:%S %Y"}) {
+        std::tm tm{};
+        const char* end = ::strptime(buffer, format, &tm);
+        if (end != nullptr && *end == '\0') {
+            return ::timegm(&tm);
+        }
+    }
+    return std::nullopt;
+}
+
+// Whether a file modified at `mtime` is unchanged since the `If-Modified-Since:` date `since`.
+// Dates have a resolution of seconds, and a date that does not parse means the file is sent.
+inline bool NotModifiedSince(std::string_view since, std::time_t mtime) {
+    auto date = ParseHttpDate(since);
+    return date.has_value() && mtime <= *date;
+}
+
+// Format the ETag of a file from its modification time and size, e.g. `"64f2e1a7-3b9aca0-1f4"`.
+inline std::string_view FormatETag(char (&buffer)[64], const ::timespec& mtime, uint64_t size) {
+    int n = std::snprintf(buffer, sizeof(buffer), "\"%llx-%llx-%llx\"",
+                          static_cast<unsigned long long>(mtime.tv_sec),
+                          static_cast<unsigned long long>(mtime.tv_nsec),
+                          static_cast<unsigned long long>(size));
+    return {buffer, static_cast<size_t>(n)};
+}
+
+// Whether the `If-None-Match:` list `tags` has `etag`, with the weak comparison.
+inline bool MatchesETag(std::string_view tags, std::string_view etag) {
+    while (!tags.empty()) {
+        auto comma = tags.find(',');
+        auto tag = tags.substr(0, comma);
+        while (!tag.empty() && tag.front() == ' ') {
+            tag.remove_prefix(1);
+        }
+        while (!tag.empty() && tag.back() == ' ') {
+            tag.remove_suffix(1);
+        }
+        if (tag.starts_with("W/")) {
+            tag.remove_prefix(2);
+        }
+        if (tag == "*" || tag == etag) {
+            return true;
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        tags.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+// The Content-Type of a file by the extension of its `path`, application/octet-stream if unknown.
+inline std::string_view ContentType(std::string_view path) {
+    static constexpr std::pair<std::string_view, std::string_view> kContentTypes[] = {
+        {".html", "text/html; charset=utf-8"},
+        {".htm", "text/html; charset=utf-8"},
+        {".css", "text/css; charset=utf-8"},
+        {".js", "text/javascript; charset=utf-8"},
+        {".mjs", "text/javascript; charset=utf-8"},
+        {".json", "application/json"},
+        {".txt", "text/plain; charset=utf-8"},
+        {".xml", "application/xml"},
+        {".svg", "image/svg+xml"},
+        {".png", "image/png"},
+        {".jpg", "image/jpeg"},
+        {".jpeg", "image/jpeg"},
+        {".gif", "image/gif"},
+        {".webp", "image/webp"},
+        {".ico", "image/x-icon"},
+        {".woff2", "font/woff2"},
+        {".wasm", "application/wasm"},
+        {".pdf", "application/pdf"},
+    };
+    auto dot = path.rfind('.');
+    if (dot != std::string_view::npos && path.find('/', dot) == std::string_view::npos) {
+        auto extension = path.substr(dot);
+        for (const auto& [suffix, type] : kContentTypes) {
+            if (extension == suffix) {
+                return type;
+            }
+        }
+    }
+    return "application/octet-stream";
+}
+
 }  // namespace fuchsia::http
@@ -0,0 +1,38 @@
+//
+// Created by wenjuxu on 2023/8/26.
+//
+
+#pragma once
+
+#include <ctime>
+#include <string_view>
+
+namespace fuchsia::http {
+
+// The `Date:` header line of responses, formatted once per second rather than per response. The
+// server keeps one per reactor, refreshed by a timer on its EpollContext and installed as the
+// current one of the reactor thread; responses rendered on other threads go without a date.
+class DateCache {
+public:
+    DateCache() { Refresh(); }
+
+    DateCache(const DateCache&) = delete;
+    DateCache& operator=(const DateCache&) = delete;
+
+    // The cache of the calling thread, or nullptr.
+    static DateCache* Current() noexcept;
+
+    // Make `cache` the one of the calling thread, returns the previous one.
+    static DateCache* SetCurrent(DateCache* cache) noexcept;
+
+    // Format the current time, e.g. `Date: Sat, 26 Aug 2023 08:49:37 GMT\r\n`.
+    void Refresh() noexcept;
+
+    std::string_view Header() const noexcept { return {header_, size_}; }
+
+private:
+    char header_[64]{};
+    size_t size_ = 0;
+};
+
+}  // namespace fuchsia::http
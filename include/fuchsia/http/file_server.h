@@ -0,0 +1,96 @@
+//
+// Created by wenjuxu on 2023/9/2.
+//
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <chrono>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "exec/task.hpp"
+#include "fuchsia/http/message.h"
+#include "fuchsia/http/mux.h"
+
+namespace fuchsia::http {
+
+struct FileServerOptions {
+    // Files kept open along with their metadata, the least recently used ones are closed beyond.
+    size_t max_open_files = 1024;
+
+    // How long the metadata of a cached file is trusted before it is compared with the disk again.
+    std::chrono::milliseconds revalidate_interval = std::chrono::seconds(1);
+};
+
+// Serves the files below a directory, their content sent with sendfile() straight from the page
+// cache. Open files and their metadata (size, modification time, ETag) are cached, so a request for
+// a cached file, and a conditional one answered with 304 Not Modified in particular, does not touch
+// the disk until the entry is due for revalidation.
+//
+// The cache is shared by all the contexts of a server, lookups hold a mutex only briefly and
+// files are opened outside of it.
+//
+//     fuchsia::http::FileServer files{"/var/www", "/static/"};
+//     mux.HandleFunc("/static/", files.Handler());
+class FileServer {
+public:
+    // `prefix` is stripped from request paths, the rest is looked up below `root`. Paths ending
+    // with `/` are served their `index.html`.
+    explicit FileServer(std::string root, std::string prefix = "/", FileServerOptions options = {});
+
+    FileServer(const FileServer&) = delete;
+
+    exec::task<void> Serve(const Request& req, Response& resp);
+
+    // A handler for ServeMux::HandleFunc(), the file server must outlive the mux.
+    ServeMux::Handler Handler() {
+        return [this](const Request& req, Response& resp) { return Serve(req, resp); };
+    }
+
+    // Number of files in the cache.
+    size_t OpenFiles() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct File {
+        File() = default;
+        File(const File&) = delete;
+        ~File();
+
+        std::string path;  // relative to the root, the key of the cache
+        int fd = -1;
+        size_t size = 0;
+        ::ino_t inode = 0;
+        ::timespec mtime{};
+        std::string etag;
+        std::string last_modified;
+        std::string_view content_type;
+        Clock::time_point checked;  // last compared against the disk, guarded by mutex_
+    };
+
+    using FileList = std::list<std::shared_ptr<File>>;
+
+    // The cached or newly opened file at `path`, nullptr if there is no regular file there.
+    std::shared_ptr<File> Open(std::string_view path);
+
+    // Open and stat `path`, below the root.
+    std::shared_ptr<File> Load(std::string_view path) const;
+
+    void Insert(std::shared_ptr<File> file);
+
+    std::string root_;
+    std::string prefix_;
+    FileServerOptions options_;
+    mutable std::mutex mutex_;
+    FileList lru_;  // the most recently used first
+    std::map<std::string, FileList::iterator, std::less<>> files_;
+};
+
+}  // namespace fuchsia::http
@@ -4,9 +4,13 @@
 
 #pragma once
 
-#include <fmt/format.h>
+#include <sys/types.h>
+
+#include <array>
+#include <memory>
 
 #include "fuchsia/http/common.h"
+#include "fuchsia/http/date_cache.h"
 #include "fuchsia/http/parser.h"
 
 namespace fuchsia::http {
@@ -22,14 +26,40 @@ public:
 
     Request() = default;
 
+    void Reset() override {
+        Parser::Reset();
+        params_.Clear();
+    }
+
+    // Parameters captured by the `{name}` segments of the matched pattern.
+    const RouteParams& Params() const { return params_; }
+
+    std::string_view Param(std::string_view name) const { return params_.Get(name); }
+
+    void SetParams(const RouteParams& params) { params_ = params; }
+
+    // Whether the client lets the connection be used for another request.
+    bool KeepAlive() const { return llhttp_should_keep_alive(&parser_) != 0; }
+
     // TODO: client side methods
+
+private:
+    RouteParams params_;
+};
+
+class StaticResponse;
+
+// A body sent straight from a file: `size` bytes of `fd` from `offset`. `owner` keeps the file
+// open until the response has been sent, e.g. an entry of a FileServer cache.
+struct FileBody {
+    int fd = -1;
+    ::off_t offset = 0;
+    size_t size = 0;
+    std::shared_ptr<const void> owner;
 };
 
 class Response : public Parser<MessageType::Response> {
 public:
-    using Parser::Body;
-    using Parser::Header;
-    using Parser::Headers;
     using Parser::StatusCode;
     using Parser::Version;
 
@@ -38,8 +68,29 @@ public:
     void Reset() override {
         Parser::Reset();
         keep_alive_ = false;
+        has_content_type_ = false;
+        headers_.clear();
+        body_.clear();
+        static_response_ = nullptr;
+        file_body_ = {};
+        prerendered_ = {};
+        prerendered_owner_.reset();
     }
 
+    // The headers and body written so far, rather than parsed ones.
+    const fuchsia::http::Headers& Headers() const { return headers_; }
+
+    std::string_view Header(std::string_view key) const {
+        for (const auto& header : headers_) {
+            if (header.key == key) {
+                return header.value;
+            }
+        }
+        return {};
+    }
+
+    std::string_view Body() const { return body_; }
+
     void SetStatusCode(fuchsia::http::StatusCode status_code) { status_code_ = status_code; }
 
     bool KeepAlive() const { return keep_alive_; }
@@ -47,42 +98,142 @@ public:
 
     void AddHeader(const std::string& key, const std::string& value) {
         headers_.push_back({key, value});
+        if (key == "Content-Type") {
+            has_content_type_ = true;
+        }
     }
 
     void WriteBody(std::string_view data) { body_.append(data); }
 
-    std::vector<fuchsia::ConstBuffer> ToBuffers() {
+    // Send the body from a file with sendfile() instead of WriteBody(). Only the head is rendered
+    // by ToBuffers() and AppendTo() then, the session sends the file after it.
+    void SetFileBody(fuchsia::http::FileBody body) { file_body_ = std::move(body); }
+
+    bool HasFileBody() const { return file_body_.fd >= 0; }
+
+    const fuchsia::http::FileBody& FileBody() const { return file_body_; }
+
+    // Send `response` as it is instead, it must outlive the response being sent.
+    void SetStaticResponse(const StaticResponse& response);
+
+    // Send `head` followed by `body` as they are instead, e.g. rendered ahead of time by a
+    // StaticAssetCache. `owner` keeps both alive until the response has been sent.
+    void SetPrerendered(fuchsia::ConstBuffer head, fuchsia::ConstBuffer body, bool keep_alive,
+                        std::shared_ptr<const void> owner) {
+        prerendered_ = {head, body};
+        prerendered_owner_ = std::move(owner);
+        keep_alive_ = keep_alive;
+    }
+
+    // The status line and headers followed by the body, valid until the next call or Reset().
+    std::array<fuchsia::ConstBuffer, 2> ToBuffers() {
+        if (static_response_ != nullptr) {
+            return {fuchsia::Buffer(StaticData()), fuchsia::ConstBuffer{}};
+        }
+        if (prerendered_owner_ != nullptr) {
+            return prerendered_;
+        }
         header_buffer_.clear();
-        fmt::format_to(std::back_inserter(header_buffer_), "HTTP/1.1 {} {}\r\n",
-                       static_cast<int>(status_code_), StatusCodeToString(status_code_));
-        bool has_content_type = false;
-        for (const auto& header : headers_) {
-            fmt::format_to(std::back_inserter(header_buffer_), "{}: {}\r\n", header.key,
-                           header.value);
-            if (header.key == "Content-Type") {
-                has_content_type = true;
-            }
+        AppendHead(header_buffer_, DateHeader());
+        return {fuchsia::Buffer(header_buffer_), fuchsia::Buffer(body_)};
+    }
+
+    // Render the whole response at the end of `out`, e.g. to send it together with others.
+    void AppendTo(std::string& out) const {
+        if (static_response_ != nullptr) {
+            out.append(StaticData());
+            return;
         }
-        if (!body_.empty()) {
-            fmt::format_to(std::back_inserter(header_buffer_), "Content-Length: {}\r\n",
-                           body_.size());
-            if (!has_content_type) {
-                fmt::format_to(std::back_inserter(header_buffer_), "Content-Type: text/plain\r\n");
+        if (prerendered_owner_ != nullptr) {
+            for (const auto& buffer : prerendered_) {
+                out.append(static_cast<const char*>(buffer.Data()), buffer.Size());
             }
+            return;
         }
-        if (keep_alive_) {
-            fmt::format_to(std::back_inserter(header_buffer_), "Connection: keep-alive\r\n");
-        } else {
-            fmt::format_to(std::back_inserter(header_buffer_), "Connection: close\r\n");
-        }
-        fmt::format_to(std::back_inserter(header_buffer_), "\r\n");
-
-        return {fuchsia::Buffer(header_buffer_), fuchsia::Buffer(body_)};
+        AppendHead(out, DateHeader());
+        out.append(body_);
     }
 
 private:
+    friend class StaticResponse;
+
+    static std::string_view DateHeader() {
+        auto cache = DateCache::Current();
+        return cache == nullptr ? std::string_view{} : cache->Header();
+    }
+
+    std::string_view StaticData() const;
+
+    void AppendHead(std::string& out, std::string_view date) const {
+        out.append(StatusLine(status_code_));
+        out.append(date);
+        for (const auto& header : headers_) {
+            out.append(header.key).append(": ").append(header.value).append("\r\n");
+        }
+        if (HasFileBody()) {
+            char digits[20];
+            out.append("Content-Length: ");
+            out.append(FormatDecimal(digits, file_body_.size)).append("\r\n");
+            if (!has_content_type_) {
+                out.append("Content-Type: application/octet-stream\r\n");
+            }
+        } else if (!body_.empty()) {
+            char digits[20];
+            out.append("Content-Length: ");
+            out.append(FormatDecimal(digits, body_.size())).append("\r\n");
+            if (!has_content_type_) {
+                out.append("Content-Type: text/plain\r\n");
+            }
+        }
+        out.append(keep_alive_ ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n");
+    }
+
     bool keep_alive_{false};
+    bool has_content_type_{false};
+    fuchsia::http::Headers headers_;  // hides the views of the parser, a response is written here
+    std::string body_;
     std::string header_buffer_;
+    const StaticResponse* static_response_{nullptr};
+    fuchsia::http::FileBody file_body_;
+    std::array<fuchsia::ConstBuffer, 2> prerendered_{};
+    std::shared_ptr<const void> prerendered_owner_;
+};
+
+// A response rendered once, e.g. at startup, and then sent as a single buffer by any number of
+// requests. It carries no `Date:` header.
+//
+//     static const fuchsia::http::StaticResponse kHealthy{fuchsia::http::StatusCode::Ok, "ok"};
+//     resp.SetStaticResponse(kHealthy);
+class StaticResponse {
+public:
+    StaticResponse(fuchsia::http::StatusCode status_code, std::string_view body,
+                   const fuchsia::http::Headers& headers = {}, bool keep_alive = true)
+        : keep_alive_(keep_alive) {
+        Response response;
+        response.SetStatusCode(status_code);
+        for (const auto& header : headers) {
+            response.AddHeader(header.key, header.value);
+        }
+        response.WriteBody(body);
+        response.SetKeepAlive(keep_alive);
+        response.AppendHead(data_, {});
+        data_.append(body);
+    }
+
+    std::string_view Data() const { return data_; }
+
+    bool KeepAlive() const { return keep_alive_; }
+
+private:
+    std::string data_;
+    bool keep_alive_;
 };
 
+inline void Response::SetStaticResponse(const StaticResponse& response) {
+    static_response_ = &response;
+    keep_alive_ = response.KeepAlive();
+}
+
+inline std::string_view Response::StaticData() const { return static_response_->Data(); }
+
 }  // namespace fuchsia::http
@@ -4,31 +4,155 @@
 
 #pragma once
 
+#include <cstdint>
 #include <functional>
-#include <map>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
 #include "exec/task.hpp"
 #include "fuchsia/http/message.h"
+#include "fuchsia/slab_allocator.h"
 
 namespace fuchsia::http {
 
+// Routes requests by url path with a compressed radix tree, so that a lookup only depends on the
+// length of the path rather than on the number of routes, and does not allocate. Patterns are made
+// of:
+//
+//   * static text, `/users/list` matches exactly that path;
+//   * `{name}` segments, `/users/{id}/posts` matches `/users/42/posts` with `id` = `42`;
+//   * a trailing `/`, which also matches every path below it, `/static/` matches
+//     `/static/css/main.css`.
+//
+// Static text takes precedence over `{name}` segments, and the longest trailing `/` pattern wins.
+// The query string is not part of the match.
 class ServeMux {
 public:
     using Handler = std::function<exec::task<void>(const Request& req, Response& resp)>;
 
-    ServeMux() = default;
+    ServeMux();
     ~ServeMux() = default;
 
+    // Throws std::runtime_error if the pattern is invalid or already exists.
     void HandleFunc(const std::string& pattern, Handler handler);
 
-    const Handler* Match(const std::string& path) const;
+    const Handler* Match(std::string_view path) const;
+
+    // Also returns the values of the `{name}` segments in `params`.
+    const Handler* Match(std::string_view path, RouteParams& params) const;
+
+    // Call the handler of `req` with its route parameters set, nullopt if no pattern matches.
+    std::optional<exec::task<void>> Dispatch(Request& req, Response& resp) const;
 
 private:
-    std::map<std::string, Handler> handlers_;
+    static constexpr uint32_t kNone = ~uint32_t{0};
+
+    // A piece of a pattern, static text or the name of a `{name}` segment.
+    struct Piece {
+        std::string_view text;
+        bool param;
+    };
+
+    // Nodes refer to each other and to their text by index, so that the mux stays copyable and
+    // compact.
+    struct Node {
+        uint32_t prefix = 0;  // static text of this node in labels_, empty for a `{name}` node
+        uint32_t prefix_size = 0;
+        uint32_t param_child = kNone;
+        uint32_t param_name = 0;  // of a `{name}` node, in labels_
+        uint32_t param_name_size = 0;
+        uint32_t handler = kNone;
+        bool wildcard = false;           // the pattern ends with `/`, it also matches paths below
+        std::string indices;             // first character of every static child, in order
+        std::vector<uint32_t> children;  // static children
+    };
+
+    // The nodes as laid out for lookups: breadth first, so that the static children of a node are
+    // next to each other. The first characters of up to kInlineChildren of them are kept in the
+    // node, so that the child to descend into is found with a few word compares, rather than by
+    // looking at every child. 32 bytes, two to a cache line.
+    struct LookupNode {
+        static constexpr uint32_t kInlineChildren = 8;
+
+        uint64_t child_chars = 0;
+        uint32_t prefix = 0;  // static text in labels_, or the name of a `{name}` node
+        uint32_t prefix_size = 0;
+        uint32_t first_child = 0;  // static children are [first_child, first_child + num_children)
+        uint32_t param_child = kNone;
+        uint32_t handler = kNone;
+        uint16_t num_children = 0;  // at most one per character
+        bool wildcard = false;
+    };
+
+    std::string_view Label(uint32_t offset, uint32_t size) const {
+        return std::string_view{labels_}.substr(offset, size);
+    }
+
+    // Split `pattern` into pieces, throws std::runtime_error if it is malformed.
+    static std::vector<Piece> ParsePattern(std::string_view pattern);
+    // Throws std::runtime_error if `pieces` conflict with the patterns already there.
+    void CheckConflicts(const std::vector<Piece>& pieces) const;
+    uint32_t AddLabel(std::string_view text);
+    uint32_t InsertStatic(uint32_t node, std::string_view text);
+    uint32_t InsertParam(uint32_t node, std::string_view name);
+    // Lay nodes_ out into lookup_nodes_.
+    void Compile();
+    uint32_t FindChild(const LookupNode& node, char c) const noexcept;
+    bool HasPrefix(std::string_view path, const LookupNode& node) const noexcept;
+    const Handler* Lookup(uint32_t node, std::string_view path, RouteParams& params) const;
+
+    std::vector<Node> nodes_;  // nodes_[0] is the root
+    std::vector<Handler> handlers_;
+    std::string labels_;  // texts of all nodes
+    std::vector<LookupNode> lookup_nodes_;  // lookup_nodes_[0] is the root
 };
 
 ServeMux DefaultServeMux();
 
+template <typename Mux>
+concept Dispatcher = requires(const Mux& mux, Request& req, Response& resp) {
+    { mux.Dispatch(req, resp) } -> std::same_as<std::optional<exec::task<void>>>;
+};
+
+// A non-owning reference to a ServeMux, StaticServeMux, or anything else that dispatches requests,
+// which is what sessions serve requests with. One indirect call per request, the mux behind it may
+// then call its handlers directly.
+class MuxRef {
+public:
+    template <Dispatcher Mux>
+    MuxRef(const Mux& mux) noexcept  // NOLINT(google-explicit-constructor)
+        : mux_(&mux), dispatch_([](const void* mux, Request& req, Response& resp) {
+              return static_cast<const Mux*>(mux)->Dispatch(req, resp);
+          }) {}
+
+    std::optional<exec::task<void>> Dispatch(Request& req, Response& resp) const {
+        return dispatch_(mux_, req, resp);
+    }
+
+private:
+    const void* mux_;
+    std::optional<exec::task<void>> (*dispatch_)(const void*, Request&, Response&);
+};
+
 }  // namespace fuchsia::http
+
+// Coroutine frames of handlers, i.e. `exec::task<void>(const Request&, Response&)` functions,
+// members and lambdas, come from the SlabAllocator of the EpollContext serving the request.
+template <>
+struct std::coroutine_traits<exec::task<void>, const fuchsia::http::Request&,
+                             fuchsia::http::Response&> {
+    using promise_type = fuchsia::SlabPromise<exec::task<void>>;
+};
+
+// Self is the object of a member function or of a lambda's call operator, constrained to class
+// types so that free coroutines taking something before the request keep their default promise.
+template <typename Self>
+requires std::is_class_v<std::remove_cvref_t<Self>>
+struct std::coroutine_traits<exec::task<void>, Self, const fuchsia::http::Request&,
+                             fuchsia::http::Response&> {
+    using promise_type = fuchsia::SlabPromise<exec::task<void>>;
+};
@@ -4,7 +4,10 @@
 
 #pragma once
 
+#include <deque>
 #include <span>
+#include <string>
+#include <string_view>
 
 #include "fuchsia/buffer.h"
 #include "fuchsia/http/common.h"
@@ -16,6 +19,13 @@ enum class MessageType { Request, Response };
 
 enum class ParseResult { Ok, Error, Incomplete };
 
+// Parses messages in place: method, url, headers and body are views into the data passed to
+// Parse(), nothing is copied for a message received in one piece. When a message is incomplete,
+// the parts of it seen so far are copied to storage owned by the parser, so that the caller may
+// reuse its buffer for the next read; a token spanning several reads is joined there as well.
+//
+// The views stay valid until Reset(), and for a message received in one piece, as long as the data
+// passed to Parse() is not modified.
 template <MessageType Type>
 class Parser {
 public:
@@ -28,37 +38,63 @@ public:
         parser_.data = this;
     }
 
+    virtual ~Parser() = default;
+
     virtual void Reset() {
         llhttp_reset(&parser_);
         state_ = ParserState::None;
-        method_.clear();
-        url_.clear();
+        method_ = {};
+        url_ = {};
         status_code_ = fuchsia::http::StatusCode::Ok;
-        header_field_.clear();
+        header_field_ = {};
         headers_.clear();
-        body_.clear();
+        body_ = {};
+        storage_.clear();
+        consumed_ = 0;
+        headers_complete_ = false;
+        skip_body_ = false;
     }
 
+    // Parsing stops at the end of a message, Consumed() tells how much of `data` belonged to it;
+    // the rest is the start of the next (pipelined) message, to be parsed after Reset().
     ParseResult Parse(const char* data, size_t len) {
         auto ret = llhttp_execute(&parser_, data, len);
+        if (ret == HPE_PAUSED && state_ == ParserState::OnMessageComplete) {
+            consumed_ = static_cast<size_t>(llhttp_get_error_pos(&parser_) - data);
+            llhttp_resume(&parser_);
+            return ParseResult::Ok;
+        }
+        consumed_ = len;
         if (ret != HPE_OK) {
             return ParseResult::Error;
-        } else if (state_ == ParserState::OnMessageComplete) {
-            return ParseResult::Ok;
         } else {
+            Detach(data, data + len);
             return ParseResult::Incomplete;
         }
     }
 
+    // The peer closed the connection, which completes a message whose end is only marked by that,
+    // e.g. a response without Content-Length.
+    ParseResult Finish() {
+        llhttp_finish(&parser_);
+        return state_ == ParserState::OnMessageComplete ? ParseResult::Ok : ParseResult::Error;
+    }
+
+    // Number of bytes taken by the last Parse(), all of them unless it returned Ok.
+    size_t Consumed() const { return consumed_; }
+
+    // Whether the headers of the message have been parsed entirely, the body may follow.
+    bool HeadersComplete() const { return headers_complete_; }
+
     HttpVersion Version() const { return version_; }
 
-    std::string Method() const { return method_; }
+    std::string_view Method() const { return method_; }
 
-    std::string Url() const { return url_; }
+    std::string_view Url() const { return url_; }
 
     fuchsia::http::StatusCode StatusCode() const { return status_code_; }
 
-    const fuchsia::http::Headers& Headers() const { return headers_; }
+    const HeaderViews& Headers() const { return headers_; }
 
     std::string_view Body() const { return body_; }
 
@@ -72,6 +108,42 @@ public:
     }
 
 protected:
+    // Extend `token` by the next piece of it, which directly follows it unless the token spans
+    // several reads.
+    void Append(std::string_view& token, const char* data, size_t len) {
+        if (token.empty()) {
+            token = {data, len};
+        } else if (token.data() + token.size() == data) {
+            token = {token.data(), token.size() + len};
+        } else if (!storage_.empty() && token.data() == storage_.back().data() &&
+                   token.size() == storage_.back().size()) {
+            storage_.back().append(data, len);
+            token = storage_.back();
+        } else {
+            auto& copy = storage_.emplace_back();
+            copy.reserve(token.size() + len);
+            copy.append(token).append(data, len);
+            token = copy;
+        }
+    }
+
+    // Copy the views into [begin, end) to storage, the caller is about to reuse its buffer.
+    void Detach(const char* begin, const char* end) {
+        auto detach = [&](std::string_view& token) {
+            if (!token.empty() && token.data() >= begin && token.data() < end) {
+                token = storage_.emplace_back(token);
+            }
+        };
+        detach(method_);
+        detach(url_);
+        detach(header_field_);
+        for (auto& header : headers_) {
+            detach(header.key);
+            detach(header.value);
+        }
+        detach(body_);
+    }
+
     static int OnMessageBegin(llhttp_t* parser) {
         auto self = static_cast<Parser*>(parser->data);
         self->state_ = ParserState::OnMessageBegin;
@@ -80,7 +152,7 @@ protected:
 
     static int OnUrl(llhttp_t* parser, const char* data, size_t len) {
         auto self = static_cast<Parser*>(parser->data);
-        self->url_.append(data, len);
+        self->Append(self->url_, data, len);
         self->state_ = ParserState::OnUrl;
         return 0;
     }
@@ -94,7 +166,7 @@ protected:
 
     static int OnMethod(llhttp_t* parser, const char* data, size_t len) {
         auto self = static_cast<Parser*>(parser->data);
-        self->method_.append(data, len);
+        self->Append(self->method_, data, len);
         self->state_ = ParserState::OnMethod;
         return 0;
     }
@@ -108,8 +180,7 @@ protected:
 
     static int OnHeaderField(llhttp_t* parser, const char* data, size_t len) {
         auto self = static_cast<Parser*>(parser->data);
-
-        self->header_field_.append(data, len);
+        self->Append(self->header_field_, data, len);
         self->state_ = ParserState::OnHeaderField;
         return 0;
     }
@@ -117,11 +188,10 @@ protected:
     static int OnHeaderValue(llhttp_t* parser, const char* data, size_t len) {
         auto self = static_cast<Parser*>(parser->data);
         if (self->state_ == ParserState::OnHeaderField) {
-            self->headers_.emplace_back(self->header_field_, std::string(data, len));
-            self->header_field_.clear();
-        } else if (self->state_ == ParserState::OnHeaderValue) {
-            self->headers_.back().value.append(data, len);
+            self->headers_.push_back({self->header_field_, {}});
+            self->header_field_ = {};
         }
+        self->Append(self->headers_.back().value, data, len);
         self->state_ = ParserState::OnHeaderValue;
         return 0;
     }
@@ -129,12 +199,13 @@ protected:
     static int OnHeadersComplete(llhttp_t* parser) {
         auto self = static_cast<Parser*>(parser->data);
         self->state_ = ParserState::OnHeadersComplete;
-        return 0;
+        self->headers_complete_ = true;
+        return self->skip_body_ ? 1 : 0;
     }
 
     static int OnBody(llhttp_t* parser, const char* data, size_t len) {
         auto self = static_cast<Parser*>(parser->data);
-        self->body_.append(data, len);
+        self->Append(self->body_, data, len);
         self->state_ = ParserState::OnBody;
         return 0;
     }
@@ -142,7 +213,7 @@ protected:
     static int OnMessageComplete(llhttp_t* parser) {
         auto self = static_cast<Parser*>(parser->data);
         self->state_ = ParserState::OnMessageComplete;
-        return 0;
+        return HPE_PAUSED;  // leave whatever follows to the next message
     }
 
     static int OnChunkHeader(llhttp_t* parser) {
@@ -191,12 +262,16 @@ protected:
     llhttp_t parser_;
     ParserState state_ = ParserState::None;
     HttpVersion version_;
-    std::string method_;
-    std::string url_;
+    std::string_view method_;
+    std::string_view url_;
     fuchsia::http::StatusCode status_code_ = fuchsia::http::StatusCode::Ok;
-    std::string header_field_;
-    fuchsia::http::Headers headers_;
-    std::string body_;
+    std::string_view header_field_;
+    HeaderViews headers_;
+    std::string_view body_;
+    std::deque<std::string> storage_;  // tokens copied out of the caller's buffers
+    size_t consumed_ = 0;
+    bool headers_complete_ = false;
+    bool skip_body_ = false;  // the message has none whatever its headers say, e.g. HEAD responses
 };
 
 }  // namespace fuchsia::http
@@ -4,31 +4,74 @@
 
 #pragma once
 
+#include <chrono>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "exec/async_scope.hpp"
 #include "exec/task.hpp"
 #include "fuchsia/epoll_context.h"
+#include "fuchsia/epoll_context_pool.h"
+#include "fuchsia/http/date_cache.h"
 #include "fuchsia/http/mux.h"
 #include "fuchsia/http/session.h"
 #include "fuchsia/net/tcp.h"
 
 namespace fuchsia::http {
 
+struct ServerOptions {
+    // Number of EpollContexts (one thread each) serving connections. Every context owns its own
+    // SO_REUSEPORT acceptor, so the kernel spreads new connections across them, and a session
+    // stays on the context that accepted it.
+    size_t num_threads = 1;
+
+    // Pin each context thread to a cpu.
+    bool pin_threads = false;
+
+    // Options of every EpollContext, such as the per-iteration operation budget.
+    fuchsia::EpollContext::Options context_options;
+
+    // Idle, header and body timeouts of every connection.
+    SessionOptions session_options;
+
+    // How long an acceptor waits before accepting again when the process or the system has run
+    // out of descriptors or buffers (EMFILE, ENFILE, ENOBUFS, ENOMEM), or after an unexpected
+    // error.
+    std::chrono::milliseconds accept_retry_delay = std::chrono::milliseconds(100);
+};
+
 class Server {
 public:
-    Server(const std::string& address, int port);
+    Server(const std::string& address, int port, ServerOptions options = {});
 
     Server(const Server&) = delete;
 
     ~Server();
 
-    void Serve(const ServeMux& mux);
+    // Serve requests with a ServeMux or a StaticServeMux, which must outlive the server.
+    void Serve(MuxRef mux);
 
 private:
-    fuchsia::EpollContext context_;
-    fuchsia::net::Tcp::Acceptor acceptor_;
-    SessionMgr session_mgr_;
+    struct Reactor {
+        Reactor(fuchsia::EpollContext& context, const fuchsia::net::Tcp::Endpoint& endpoint)
+            : context{context}, acceptor{context, endpoint, true, true} {}
+
+        fuchsia::EpollContext& context;
+        fuchsia::net::Tcp::Acceptor acceptor;
+        SessionMgr session_mgr;
+        DateCache date_cache;
+    };
+
+    // Accept connections until stopped. Errors of a single connection are skipped, anything else,
+    // such as running out of descriptors or memory, backs off for accept_retry_delay.
+    exec::task<void> Accept(Reactor& reactor, MuxRef mux);
+    // Install the reactor's DateCache on its thread and refresh it every second.
+    exec::task<void> RefreshDate(Reactor& reactor);
+
+    ServerOptions options_;
+    fuchsia::EpollContextPool pool_;
+    std::vector<std::unique_ptr<Reactor>> reactors_;
     exec::async_scope async_scope_;
 };
 
@@ -4,22 +4,48 @@
 
 #pragma once
 
+#include <chrono>
+#include <memory>
 #include <set>
 #include <string>
 
 #include "exec/task.hpp"
+#include "fuchsia/epoll_context.h"
 #include "fuchsia/http/message.h"
 #include "fuchsia/http/mux.h"
 #include "fuchsia/net/tcp.h"
+#include "fuchsia/slab_allocator.h"
 
 namespace fuchsia::http {
 
 class SessionMgr;
 
+// Limits on how long a connection may take, zero for no limit. When one is exceeded, the
+// connection is closed.
+struct SessionOptions {
+    // Between requests, waiting for the first byte of the next one.
+    std::chrono::milliseconds idle_timeout = std::chrono::seconds(60);
+
+    // From the first byte of a request until its headers are complete.
+    std::chrono::milliseconds header_timeout = std::chrono::seconds(10);
+
+    // From the end of the headers of a request until its body is complete.
+    std::chrono::milliseconds body_timeout = std::chrono::seconds(60);
+};
+
+// Sessions are created with MakeSession(), so that they come from the SlabAllocator of the
+// EpollContext serving them, same as the coroutine frames of Start().
 class Session : public std::enable_shared_from_this<Session> {
 public:
-    Session(fuchsia::net::Tcp::Socket socket, SessionMgr& session_mgr, const ServeMux& mux)
-        : id_(GenID()), socket_{std::move(socket)}, session_mgr_{session_mgr}, mux_{mux} {}
+    Session(fuchsia::net::Tcp::Socket socket, SessionMgr& session_mgr, MuxRef mux,
+            const SessionOptions& options = {})
+        : id_(GenID()),
+          socket_{std::move(socket)},
+          session_mgr_{session_mgr},
+          mux_{mux},
+          options_{options} {
+        EnterPhase(Phase::Idle);
+    }
 
     Session(const Session&) = delete;
 
@@ -27,31 +53,75 @@ public:
     void Stop();
 
 private:
+    using TimePoint = EpollContext::TimePoint;
+
+    // What the session is waiting for, each with its own timeout.
+    enum class Phase { Idle, Header, Body };
+
     static uint64_t GenID();
 
+    // Switch to `phase` and restart the timeout for it.
+    void EnterPhase(Phase phase);
+
+    // Send out write_buffer_ entirely.
+    exec::task<void> Flush();
+
     uint64_t id_;
     fuchsia::net::Tcp::Socket socket_;
     SessionMgr& session_mgr_;
-    const ServeMux& mux_;
+    MuxRef mux_;
+    SessionOptions options_;
+    Phase phase_ = Phase::Idle;
+    TimePoint deadline_ = TimePoint::max();  // of the reads of the current phase
     Request request_;
     Response response_;
     char buffer_[8192]{};
+    size_t read_begin_ = 0;  // [read_begin_, read_end_) of buffer_ is received but not parsed yet
+    size_t read_end_ = 0;
+    std::string write_buffer_;  // responses to pipelined requests, sent together
 };
 
+inline std::shared_ptr<Session> MakeSession(fuchsia::net::Tcp::Socket socket,
+                                            SessionMgr& session_mgr, MuxRef mux,
+                                            const SessionOptions& options = {}) {
+    return std::allocate_shared<Session>(SlabStdAllocator<Session>{}, std::move(socket),
+                                         session_mgr, mux, options);
+}
+
 class SessionMgr {
 public:
     SessionMgr() = default;
 
     SessionMgr(const SessionMgr&) = delete;
 
+    // Serve `session` until it ends, however it does, then Stop() it.
     exec::task<void> Start(const std::shared_ptr<Session>& session);
 
+    // Remove `session` and close its connection, it may be stopped more than once.
     void Stop(const std::shared_ptr<Session>& session);
 
     void StopAll();
 
 private:
-    std::set<std::shared_ptr<Session>> sessions_;
+    std::set<std::shared_ptr<Session>, std::less<>, SlabStdAllocator<std::shared_ptr<Session>>>
+        sessions_;
 };
 
 }  // namespace fuchsia::http
+
+template <>
+struct std::coroutine_traits<exec::task<void>, fuchsia::http::Session&> {
+    using promise_type = fuchsia::SlabPromise<exec::task<void>>;
+};
+
+template <>
+struct std::coroutine_traits<exec::task<void>, fuchsia::http::SessionMgr&,
+                             const std::shared_ptr<fuchsia::http::Session>&> {
+    using promise_type = fuchsia::SlabPromise<exec::task<void>>;
+};
+
+template <>
+struct std::coroutine_traits<exec::task<void>, fuchsia::http::SessionMgr&,
+                             std::shared_ptr<fuchsia::http::Session>> {
+    using promise_type = fuchsia::SlabPromise<exec::task<void>>;
+};
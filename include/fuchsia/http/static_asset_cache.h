@@ -0,0 +1,130 @@
+//
+// Created by wenjuxu on 2023/9/3.
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include "exec/task.hpp"
+#include "fuchsia/epoll_context.h"
+#include "fuchsia/http/message.h"
+#include "fuchsia/http/mux.h"
+
+namespace fuchsia::http {
+
+struct StaticAssetCacheOptions {
+    // Files larger than that are left out, serve them with a FileServer.
+    size_t max_asset_size = 1 << 20;
+
+    // How often Watch() picks up the changes reported by inotify.
+    std::chrono::milliseconds watch_interval = std::chrono::milliseconds(100);
+};
+
+// Keeps every file below a directory mapped in memory, along with the response heads rendered for
+// it, so that a request is answered with two iovecs, the head and the mapped file, without copying
+// or allocating anything. Paths ending with `/` are served their `index.html`.
+//
+// Precompressed variants are picked up next to a file, `app.js.gz` and `app.js.br` for `app.js`,
+// and sent instead of it when the `Accept-Encoding:` of the request allows.
+//
+// The cache is shared by all the contexts of a server. Changes on disk are reported by inotify and
+// applied by Watch(), which swaps in a new snapshot of the assets; responses in flight keep the
+// one they were rendered from. Files are mapped rather than copied, so replace them by renaming
+// new ones into place: a file truncated while mapped cannot be sent anymore.
+//
+//     fuchsia::http::StaticAssetCache assets{"/var/www/assets", "/assets/"};
+//     mux.HandleFunc("/assets/", assets.Handler());
+//     scope.spawn(stdexec::on(context.GetScheduler(), assets.Watch(context)));
+class StaticAssetCache {
+public:
+    // Map the files below `root`, throws std::system_error if a directory cannot be watched.
+    // `prefix` is stripped from request paths. Directories that cannot be watched later on, e.g.
+    // once the inotify watch limit is reached, are logged and left out.
+    explicit StaticAssetCache(std::string root, std::string prefix = "/",
+                              StaticAssetCacheOptions options = {});
+
+    StaticAssetCache(const StaticAssetCache&) = delete;
+
+    ~StaticAssetCache();
+
+    exec::task<void> Serve(const Request& req, Response& resp);
+
+    // A handler for ServeMux::HandleFunc(), the cache must outlive the mux.
+    ServeMux::Handler Handler() {
+        return [this](const Request& req, Response& resp) { return Serve(req, resp); };
+    }
+
+    // Apply the changes on disk every watch_interval on `context`, until stopped.
+    exec::task<void> Watch(fuchsia::EpollContext& context);
+
+    // Apply the changes on disk reported since the last call, returns the number of changed paths.
+    size_t Refresh();
+
+    // Number of paths served, directory indexes included.
+    size_t Size() const { return assets_.load()->size(); }
+
+private:
+    enum Encoding { kIdentity, kGzip, kBrotli, kNumEncodings };
+
+    // A read-only mapping of a whole file.
+    struct Mapping {
+        Mapping() = default;
+        Mapping(const Mapping&) = delete;
+        ~Mapping();
+
+        const void* data = nullptr;
+        size_t size = 0;
+    };
+
+    struct Variant {
+        Mapping body;
+        std::string etag;
+        std::time_t mtime = 0;
+        std::string last_modified;
+        std::array<std::string, 2> ok_heads;            // indexed by keep-alive
+        std::array<std::string, 2> not_modified_heads;  // indexed by keep-alive
+    };
+
+    struct Asset {
+        std::array<std::unique_ptr<Variant>, kNumEncodings> variants;  // kIdentity is always there
+
+        // The variant to send for the `Accept-Encoding:` value `accept`.
+        const Variant& Select(std::string_view accept) const;
+    };
+
+    using AssetMap = std::map<std::string, std::shared_ptr<const Asset>, std::less<>>;
+
+    // Map the file at `full_path`, nullptr if it is not a regular file or too large.
+    std::unique_ptr<Variant> Map(const std::string& full_path) const;
+
+    // Map `path` and its precompressed variants, nullptr if it is not a regular file or too large.
+    std::shared_ptr<const Asset> Load(std::string_view path) const;
+
+    // Map the file `path` into `assets`, or drop it if it is gone.
+    void Reload(const std::string& path, AssetMap& assets) const;
+
+    // Watch the directory `dir`, relative to the root, and map everything below it into `assets`.
+    // Directories that cannot be watched are logged and skipped, returns the first such error.
+    std::error_code Scan(const std::string& dir, AssetMap& assets);
+
+    std::string root_;
+    std::string prefix_;
+    StaticAssetCacheOptions options_;
+    int inotify_fd_ = -1;
+    std::mutex refresh_mutex_;  // serializes Refresh()
+    // Directory of every inotify watch descriptor, guarded by refresh_mutex_.
+    std::map<int, std::string> watches_;
+    std::atomic<std::shared_ptr<const AssetMap>> assets_;
+};
+
+}  // namespace fuchsia::http
@@ -0,0 +1,121 @@
+//
+// Created by wenjuxu on 2023/8/25.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+#include "exec/task.hpp"
+#include "fuchsia/http/message.h"
+
+namespace fuchsia::http {
+
+// A string literal usable as a template argument.
+template <size_t N>
+struct FixedString {
+    constexpr FixedString(const char (&str)[N]) noexcept {  // NOLINT(google-explicit-constructor)
+        std::copy_n(str, N, data);
+    }
+
+    constexpr std::string_view View() const noexcept { return {data, N - 1}; }
+
+    char data[N]{};
+};
+
+// A route of a StaticServeMux: `Pattern` is static text, matched exactly, or ends with `/` to also
+// match every path below it. `Handler` is a function or a captureless lambda callable as
+// `exec::task<void>(const Request&, Response&)`.
+template <FixedString Pattern, auto Handler>
+struct Route {
+    static constexpr std::string_view kPattern = Pattern.View();
+    static constexpr bool kPrefix = kPattern.ends_with('/');
+
+    static_assert(kPattern.starts_with('/'), "pattern must start with /");
+    static_assert(kPattern.find('{') == std::string_view::npos,
+                  "StaticServeMux does not capture parameters, use ServeMux");
+
+    static exec::task<void> Call(const Request& req, Response& resp) {
+        return std::invoke(Handler, req, resp);
+    }
+};
+
+// A mux whose routes are fixed at compile time. Exact patterns are compared by length first, which
+// the compiler turns into a jump on the length of the path followed by a memcmp against constants,
+// then the longest prefix pattern wins; handlers are called directly rather than through
+// std::function. Same precedence as ServeMux, and the query string is not part of the match.
+//
+//     constexpr fuchsia::http::StaticServeMux<
+//         fuchsia::http::Route<"/health", HandleHealth>,
+//         fuchsia::http::Route<"/static/", HandleStatic>> mux;
+//     server.Serve(mux);
+template <typename... Routes>
+class StaticServeMux {
+    static constexpr std::array<std::string_view, sizeof...(Routes)> kPatterns{Routes::kPattern...};
+
+    static constexpr bool UniquePatterns() {
+        for (size_t i = 0; i < kPatterns.size(); ++i) {
+            for (size_t j = i + 1; j < kPatterns.size(); ++j) {
+                if (kPatterns[i] == kPatterns[j]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    static_assert(UniquePatterns(), "duplicate pattern");
+
+public:
+    static constexpr size_t kNoRoute = sizeof...(Routes);
+
+    // Index of the route `path` matches, kNoRoute if none.
+    static constexpr size_t Match(std::string_view path) noexcept {
+        path = path.substr(0, path.find('?'));
+        size_t route = kNoRoute;
+        size_t index = 0;
+        // Exact patterns, the first match ends the fold.
+        ((MatchExact<Routes>(path) ? (route = index, true) : (++index, false)) || ...);
+        if (route != kNoRoute) {
+            return route;
+        }
+        index = 0;
+        size_t longest = 0;
+        ((MatchPrefix<Routes>(path) && Routes::kPattern.size() > longest
+              ? (route = index, longest = Routes::kPattern.size())
+              : 0,
+          ++index),
+         ...);
+        return route;
+    }
+
+    std::optional<exec::task<void>> Dispatch(Request& req, Response& resp) const {
+        return Call(Match(req.Url()), req, resp, std::index_sequence_for<Routes...>{});
+    }
+
+private:
+    template <typename R>
+    static constexpr bool MatchExact(std::string_view path) noexcept {
+        return path.size() == R::kPattern.size() && path == R::kPattern;
+    }
+
+    template <typename R>
+    static constexpr bool MatchPrefix(std::string_view path) noexcept {
+        return R::kPrefix && path.size() > R::kPattern.size() && path.starts_with(R::kPattern);
+    }
+
+    template <size_t... I>
+    static std::optional<exec::task<void>> Call(size_t route, const Request& req, Response& resp,
+                                                std::index_sequence<I...>) {
+        std::optional<exec::task<void>> task;
+        ((route == I ? (task.emplace(Routes::Call(req, resp)), true) : false) || ...);
+        return task;
+    }
+};
+
+}  // namespace fuchsia::http
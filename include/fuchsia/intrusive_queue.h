@@ -53,6 +53,20 @@ public:
         return item;
     }
 
+    // Move all items of `other` in front of the items of this queue.
+    void Prepend(IntrusiveQueue&& other) noexcept {
+        if (other.Empty()) {
+            return;
+        }
+        if (Empty()) {
+            tail_ = other.tail_;
+        } else {
+            other.tail_->next = head_;
+        }
+        head_ = std::exchange(other.head_, nullptr);
+        other.tail_ = nullptr;
+    }
+
     static IntrusiveQueue MakeReversed(T* list) noexcept {
         T* new_head = nullptr;
         T* new_tail = list;
@@ -0,0 +1,218 @@
+//
+// Created by wenjuxu on 2023/9/4.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "fuchsia/buffer.h"
+#include "fuchsia/slab_allocator.h"
+
+namespace fuchsia {
+
+// An owning view of bytes in a reference counted block from SlabAllocator. Copies and slices share
+// the block instead of copying the bytes, which is freed with the last view of it, on any thread.
+// So received data can be handed from the parser to a handler, or kept past the next read, and
+// sent from where it was received.
+//
+// A view may grow into the free space behind it (Tail() and Commit()) only while it is the sole
+// owner of its block, the other views of a block are read-only.
+//
+//     auto buf = fuchsia::IOBuf::Create(4096);
+//     size_t n = co_await fuchsia::AsyncRecvSome(socket, buf.Tail());
+//     buf.Commit(n);
+//     auto header = buf.Slice(0, header_size);  // shares the block
+class IOBuf {
+public:
+    // An empty view without a block.
+    IOBuf() noexcept = default;
+
+    // An empty view at the start of a new block of `capacity` bytes.
+    static IOBuf Create(size_t capacity);
+
+    // A view of a copy of `data`.
+    static IOBuf CopyOf(ConstBuffer data);
+
+    IOBuf(const IOBuf& other) noexcept
+        : block_(other.block_), data_(other.data_), size_(other.size_) {
+        if (block_ != nullptr) {
+            block_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    IOBuf(IOBuf&& other) noexcept
+        : block_(std::exchange(other.block_, nullptr)),
+          data_(std::exchange(other.data_, nullptr)),
+          size_(std::exchange(other.size_, 0)) {}
+
+    IOBuf& operator=(IOBuf other) noexcept {
+        std::swap(block_, other.block_);
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        return *this;
+    }
+
+    ~IOBuf() { Release(); }
+
+    const char* Data() const noexcept { return data_; }
+
+    // The bytes of the view, only to be written while it is not shared.
+    char* WritableData() const noexcept { return data_; }
+
+    size_t Size() const noexcept { return size_; }
+
+    bool Empty() const noexcept { return size_ == 0; }
+
+    // Whether other views share the block.
+    bool IsShared() const noexcept {
+        return block_ != nullptr && block_->refs.load(std::memory_order_acquire) > 1;
+    }
+
+    // The free space behind the view, empty while the block is shared.
+    MutableBuffer Tail() const noexcept {
+        if (block_ == nullptr || IsShared()) {
+            return {};
+        }
+        return {data_ + size_, static_cast<size_t>(block_->End() - (data_ + size_))};
+    }
+
+    // Extend the view over the first `n` bytes of Tail(), once they have been written.
+    void Commit(size_t n) noexcept { size_ += n; }
+
+    // A view of `size` bytes from `offset` of this one, sharing the block. Clamped to this view.
+    IOBuf Slice(size_t offset, size_t size) const noexcept {
+        IOBuf slice{*this};
+        slice.TrimStart(offset);
+        slice.size_ = std::min(slice.size_, size);
+        return slice;
+    }
+
+    // Drop the first `n` bytes of the view.
+    void TrimStart(size_t n) noexcept {
+        n = std::min(n, size_);
+        data_ += n;
+        size_ -= n;
+    }
+
+    // Drop the last `n` bytes of the view.
+    void TrimEnd(size_t n) noexcept { size_ -= std::min(n, size_); }
+
+    std::string_view View() const noexcept { return {data_, size_}; }
+
+private:
+    struct Block {
+        std::atomic<uint32_t> refs;
+        uint32_t capacity;
+
+        char* Begin() noexcept { return reinterpret_cast<char*>(this + 1); }
+        char* End() noexcept { return Begin() + capacity; }
+    };
+
+    void Release() noexcept {
+        if (block_ != nullptr && block_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            block_->~Block();
+            SlabAllocator::Deallocate(block_);
+        }
+    }
+
+    Block* block_ = nullptr;
+    char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+inline MutableBuffer Buffer(const IOBuf& buf) noexcept {
+    return MutableBuffer{buf.WritableData(), buf.Size()};
+}
+
+// A sequence of IOBufs, e.g. a message received in several reads or a response made of a head and
+// a body, which can be sent as a whole, up to BufferSequenceAdapterBase::MaxBuffers of them at a
+// time. It is a MutableBufferSequence, and so a ConstBufferSequence, of the views.
+//
+//     fuchsia::IOBufChain chain;
+//     chain.Append(head);
+//     chain.Append(body);
+//     co_await fuchsia::AsyncSendAll(socket, chain);
+class IOBufChain {
+    using Storage = std::deque<IOBuf, SlabStdAllocator<IOBuf>>;
+
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = MutableBuffer;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = MutableBuffer;
+
+        Iterator() = default;
+
+        explicit Iterator(Storage::const_iterator it) : it_(it) {}
+
+        MutableBuffer operator*() const noexcept { return fuchsia::Buffer(*it_); }
+
+        Iterator& operator++() noexcept {
+            ++it_;
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept { return Iterator{it_++}; }
+
+        bool operator==(const Iterator& other) const noexcept = default;
+
+    private:
+        Storage::const_iterator it_;
+    };
+
+    IOBufChain() = default;
+
+    Iterator begin() const noexcept { return Iterator{bufs_.begin()}; }
+    Iterator end() const noexcept { return Iterator{bufs_.end()}; }
+
+    // Total number of bytes.
+    size_t Size() const noexcept { return size_; }
+
+    bool Empty() const noexcept { return size_ == 0; }
+
+    // Number of views.
+    size_t Count() const noexcept { return bufs_.size(); }
+
+    const IOBuf& Front() const { return bufs_.front(); }
+    const IOBuf& Back() const { return bufs_.back(); }
+
+    // Append a view, empty ones are dropped.
+    void Append(IOBuf buf);
+
+    void Append(IOBufChain&& chain);
+
+    // Drop the first `n` bytes, e.g. once they have been sent.
+    void TrimStart(size_t n);
+
+    // Take the first `n` bytes out as a chain of their own, sharing the blocks: the view that
+    // straddles the cut is sliced in two.
+    IOBufChain Split(size_t n);
+
+    // Copy up to `size` bytes from `offset` to `out`, returns the number of bytes copied.
+    size_t CopyTo(void* out, size_t size, size_t offset = 0) const;
+
+    std::string ToString() const;
+
+    void Clear() noexcept {
+        bufs_.clear();
+        size_ = 0;
+    }
+
+private:
+    Storage bufs_;
+    size_t size_ = 0;
+};
+
+}  // namespace fuchsia
@@ -0,0 +1,678 @@
+//
+// Created by wenjuxu on 2023/8/13.
+//
+
+#pragma once
+
+#include <liburing.h>
+
+#include <atomic>
+#include <chrono>
+
+#include "exec/timed_scheduler.hpp"
+#include "fuchsia/atomic_intrusive_queue.h"
+#include "fuchsia/buffer_sequence_adapter.h"
+#include "fuchsia/intrusive_queue.h"
+#include "fuchsia/operation_base.h"
+#include "fuchsia/net/acceptor.h"
+#include "fuchsia/net/socket.h"
+#include "fuchsia/socket_accept_op.h"
+#include "fuchsia/socket_recv_some_op.h"
+#include "fuchsia/socket_send_some_op.h"
+#include "stdexec/execution.hpp"
+
+namespace fuchsia {
+
+// An alternative to EpollContext built on io_uring. Socket operations are submitted to the ring
+// instead of being retried on readiness, and all submissions made during one loop iteration are
+// flushed with a single io_uring_enter(), which is also the call that waits for completions.
+//
+// Sockets bound to this context are `net::Socket<Protocol, IoUringContext>` and
+// `net::Acceptor<Protocol, IoUringContext>`, AsyncAccept, AsyncRecvSome and AsyncSendSome work on
+// them unchanged.
+class IoUringContext {
+public:
+    explicit IoUringContext(unsigned entries = 1024);
+    ~IoUringContext();
+
+    class Scheduler;
+    Scheduler GetScheduler() noexcept;
+
+    void Run();
+    void Stop() noexcept;
+
+private:
+    using OperationBase = fuchsia::OperationBase;
+
+    // An operation submitted to the ring, `result` holds the cqe result once it completes.
+    struct CompletionBase : OperationBase {
+        int result = 0;
+    };
+
+    struct OperationFlags {
+        static constexpr uint32_t None = 0;
+        static constexpr uint32_t Cancelled = 1 << 0;
+        static constexpr uint32_t Completed = 1 << 2;
+    };
+
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    template <typename Receiver>
+    class IoOperationBase;
+
+    template <typename Receiver>
+    class TimerOperation;
+
+    template <typename Receiver, typename Protocol>
+    class SocketAcceptOperation;
+
+    template <typename Receiver, typename Protocol, typename Buffers>
+    class SocketRecvSomeOperation;
+
+    template <typename Receiver, typename Protocol, typename Buffers>
+    class SocketSendSomeOperation;
+
+    template <typename Protocol>
+    friend class IoUringAcceptSender;
+
+    template <typename Protocol, typename Buffers>
+    friend class IoUringRecvSomeSender;
+
+    template <typename Protocol, typename Buffers>
+    friend class IoUringSendSomeSender;
+
+private:
+    void Schedule(OperationBase* op) noexcept;
+    void ScheduleLocal(OperationBase* op) noexcept;
+    void ScheduleRemote(OperationBase* op) noexcept;
+
+    // Get a free submission queue entry, flushing the queue to the kernel if it is full.
+    io_uring_sqe* GetSqe() noexcept;
+    void SubmitCancel(CompletionBase* op) noexcept;
+
+    bool IsRunningOnIOThread() const noexcept;
+    void ProcessLocalOperations() noexcept;
+    bool ProcessRemoteOperations() noexcept;
+    void SubmitAndWaitCompletions();
+    void ArmWakeup() noexcept;
+
+    void Wakeup();
+
+private:
+    using OperationQueue = IntrusiveQueue<OperationBase>;
+    using RemoteOperationQueue = AtomicIntrusiveQueue<OperationBase>;
+
+    io_uring ring_{};
+    int wakeup_fd_ = -1;
+    uint64_t wakeup_value_ = 0;
+    OperationQueue local_operation_queue_;
+    RemoteOperationQueue remote_operation_queue_;
+    stdexec::in_place_stop_source stop_source_;
+};
+
+// Common part of every operation submitted to the ring. The derived operation prepares the sqe
+// and interprets the cqe result, this class handles the remote start and cancellation handshake:
+// cancellation submits an IORING_OP_ASYNC_CANCEL for the in-flight operation, which then
+// completes with -ECANCELED through the normal completion path.
+template <typename Receiver>
+class IoUringContext::IoOperationBase : public CompletionBase {
+public:
+    struct Vtable {
+        void (*prepare)(IoOperationBase*, io_uring_sqe*) noexcept = nullptr;
+        void (*complete)(IoOperationBase*) noexcept = nullptr;
+    };
+
+    IoOperationBase(IoUringContext& context, Receiver receiver, const Vtable& vtable)
+        : receiver_(std::move(receiver)),
+          context_(context),
+          vtable_(vtable),
+          stop_callback_(stdexec::get_stop_token(stdexec::get_env(receiver_)), *this) {}
+
+    friend void tag_invoke(stdexec::start_t, IoOperationBase& self) noexcept { self.Start(); }
+
+private:
+    void Start() noexcept {
+        if (context_.IsRunningOnIOThread()) {
+            StartLocal();
+        } else {
+            execute = &OnStartRemoteScheduled;
+            context_.ScheduleRemote(this);
+        }
+    }
+
+    static void OnStartRemoteScheduled(OperationBase* op) noexcept {
+        static_cast<IoOperationBase*>(op)->StartLocal();
+    }
+
+    void StartLocal() noexcept {
+        execute = &OnCompletion;
+        if (stdexec::get_stop_token(stdexec::get_env(receiver_)).stop_requested()) {
+            result = -ECANCELED;
+            OnCompletion(this);
+            return;
+        }
+        auto sqe = context_.GetSqe();
+        vtable_.prepare(this, sqe);
+        io_uring_sqe_set_data(sqe, static_cast<CompletionBase*>(this));
+    }
+
+    static void OnCompletion(OperationBase* op) noexcept {
+        auto self = static_cast<IoOperationBase*>(op);
+        auto old_state =
+            self->state_.fetch_or(OperationFlags::Completed, std::memory_order_acq_rel);
+        if ((old_state & OperationFlags::Cancelled) != 0 && !self->cancel_executed_) {
+            // a cancel request is on its way to the io thread, let it deliver the completion,
+            // otherwise it would run on a destroyed operation.
+            return;
+        }
+        self->Complete();
+    }
+
+    void Complete() noexcept {
+        if (result == -ECANCELED) {
+            stdexec::set_stopped(std::move(receiver_));
+        } else {
+            vtable_.complete(this);
+        }
+    }
+
+    void RequestStop() noexcept {
+        auto old_state = state_.fetch_or(OperationFlags::Cancelled, std::memory_order_acq_rel);
+        if ((old_state & OperationFlags::Completed) == 0) {
+            cancel_operation_.execute = &OnCancelScheduled;
+            context_.Schedule(&cancel_operation_);
+        } else {
+            // io already completed thus cannot be canceled
+        }
+    }
+
+    static void OnCancelScheduled(OperationBase* op) noexcept {
+        auto self = static_cast<CancelOperation*>(op)->self;
+        self->cancel_executed_ = true;
+        if ((self->state_.load(std::memory_order_acquire) & OperationFlags::Completed) != 0) {
+            self->Complete();
+        } else {
+            self->context_.SubmitCancel(self);
+        }
+    }
+
+    struct CancelOperation : OperationBase {
+        explicit CancelOperation(IoOperationBase* self) noexcept : self(self) {}
+        IoOperationBase* self;
+    };
+
+    struct StopCallback {
+        IoOperationBase& operation;
+        void operator()() noexcept { operation.RequestStop(); }
+    };
+
+    using StopTokenType = stdexec::stop_token_of_t<stdexec::env_of_t<Receiver>>;
+
+public:
+    Receiver receiver_;
+    IoUringContext& context_;
+
+private:
+    const Vtable& vtable_;
+    std::atomic<uint32_t> state_ = 0;
+    bool cancel_executed_ = false;  // only accessed on io thread
+    CancelOperation cancel_operation_{this};
+    typename StopTokenType::template callback_type<StopCallback> stop_callback_;
+};
+
+template <typename Receiver>
+class IoUringContext::TimerOperation : public IoOperationBase<Receiver> {
+public:
+    using BaseType = IoOperationBase<Receiver>;
+
+    TimerOperation(IoUringContext& context, TimePoint expiration, Receiver receiver)
+        : BaseType(context, std::move(receiver), vtable_) {
+        auto since_epoch = expiration.time_since_epoch();
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+        timeout_.tv_sec = seconds.count();
+        timeout_.tv_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               since_epoch - seconds)
+                               .count();
+    }
+
+private:
+    static void Prepare(BaseType* base, io_uring_sqe* sqe) noexcept {
+        auto self = static_cast<TimerOperation*>(base);
+        // steady_clock is CLOCK_MONOTONIC, which is also the default clock of io_uring timeouts.
+        io_uring_prep_timeout(sqe, &self->timeout_, 0, IORING_TIMEOUT_ABS);
+    }
+
+    static void Complete(BaseType* base) noexcept {
+        if (base->result == -ETIME || base->result == 0) {
+            try {
+                stdexec::set_value(std::move(base->receiver_));
+            } catch (...) {
+                stdexec::set_error(std::move(base->receiver_), std::current_exception());
+            }
+        } else {
+            stdexec::set_error(
+                std::move(base->receiver_),
+                std::make_exception_ptr(std::system_error(-base->result, std::system_category(),
+                                                          "io_uring timeout failed")));
+        }
+    }
+
+    static constexpr typename BaseType::Vtable vtable_{&Prepare, &Complete};
+
+    __kernel_timespec timeout_{};
+};
+
+template <typename Receiver, typename Protocol>
+class IoUringContext::SocketAcceptOperation : public IoOperationBase<Receiver> {
+public:
+    using AcceptorType = net::Acceptor<Protocol, IoUringContext>;
+    using SocketType = net::Socket<Protocol, IoUringContext>;
+    using EndpointType = typename Protocol::Endpoint;
+    using BaseType = IoOperationBase<Receiver>;
+
+    SocketAcceptOperation(Receiver receiver, AcceptorType& acceptor)
+        : BaseType(acceptor.Context(), std::move(receiver), vtable_), acceptor_(acceptor) {}
+
+private:
+    static void Prepare(BaseType* base, io_uring_sqe* sqe) noexcept {
+        auto self = static_cast<SocketAcceptOperation*>(base);
+        self->addr_len_ = sizeof(self->addr_);
+        io_uring_prep_accept(sqe, self->acceptor_.Fd(),
+                             reinterpret_cast<::sockaddr*>(&self->addr_), &self->addr_len_,
+                             SOCK_NONBLOCK);
+    }
+
+    static void Complete(BaseType* base) noexcept {
+        if (base->result < 0) {
+            stdexec::set_error(std::move(base->receiver_),
+                               std::error_code(-base->result, std::system_category()));
+        } else {
+            stdexec::set_value(std::move(base->receiver_),
+                               SocketType{base->context_, base->result});
+        }
+    }
+
+    static constexpr typename BaseType::Vtable vtable_{&Prepare, &Complete};
+
+    AcceptorType& acceptor_;
+    ::sockaddr_storage addr_{};
+    ::socklen_t addr_len_ = 0;
+};
+
+template <typename Receiver, typename Protocol, typename Buffers>
+class IoUringContext::SocketRecvSomeOperation : public IoOperationBase<Receiver> {
+public:
+    using SocketType = net::Socket<Protocol, IoUringContext>;
+    using BaseType = IoOperationBase<Receiver>;
+    using BuffersType = BufferSequenceAdapter<MutableBuffer, Buffers>;
+
+    SocketRecvSomeOperation(Receiver receiver, SocketType& socket, Buffers buffers)
+        : BaseType(socket.Context(), std::move(receiver), vtable_),
+          socket_(socket),
+          buffers_(buffers) {}
+
+private:
+    static void Prepare(BaseType* base, io_uring_sqe* sqe) noexcept {
+        auto self = static_cast<SocketRecvSomeOperation*>(base);
+        if constexpr (BuffersType::IsSingleBuffer) {
+            auto&& buffer = self->buffers_.Buffers()[0];
+            io_uring_prep_recv(sqe, self->socket_.Fd(), buffer.iov_base, buffer.iov_len, 0);
+        } else {
+            self->msg_.msg_iov = self->buffers_.Buffers();
+            self->msg_.msg_iovlen = self->buffers_.Count();
+            io_uring_prep_recvmsg(sqe, self->socket_.Fd(), &self->msg_, 0);
+        }
+    }
+
+    static void Complete(BaseType* base) noexcept {
+        if (base->result == 0) {  // connection closed by peer
+            stdexec::set_error(std::move(base->receiver_),
+                               std::make_error_code(std::errc::connection_aborted));
+        } else if (base->result < 0) {
+            stdexec::set_error(std::move(base->receiver_),
+                               std::error_code(-base->result, std::system_category()));
+        } else {
+            stdexec::set_value(std::move(base->receiver_), static_cast<size_t>(base->result));
+        }
+    }
+
+    static constexpr typename BaseType::Vtable vtable_{&Prepare, &Complete};
+
+    SocketType& socket_;
+    BuffersType buffers_;
+    ::msghdr msg_{};
+};
+
+template <typename Receiver, typename Protocol, typename Buffers>
+class IoUringContext::SocketSendSomeOperation : public IoOperationBase<Receiver> {
+public:
+    using SocketType = net::Socket<Protocol, IoUringContext>;
+    using BaseType = IoOperationBase<Receiver>;
+    using BuffersType = BufferSequenceAdapter<ConstBuffer, Buffers>;
+
+    SocketSendSomeOperation(Receiver receiver, SocketType& socket, Buffers buffers)
+        : BaseType(socket.Context(), std::move(receiver), vtable_),
+          socket_(socket),
+          buffers_(buffers) {}
+
+private:
+    static void Prepare(BaseType* base, io_uring_sqe* sqe) noexcept {
+        auto self = static_cast<SocketSendSomeOperation*>(base);
+        if constexpr (BuffersType::IsSingleBuffer) {
+            auto&& buffer = self->buffers_.Buffers()[0];
+            io_uring_prep_send(sqe, self->socket_.Fd(), buffer.iov_base, buffer.iov_len,
+                               MSG_NOSIGNAL);
+        } else {
+            self->msg_.msg_iov = self->buffers_.Buffers();
+            self->msg_.msg_iovlen = self->buffers_.Count();
+            io_uring_prep_sendmsg(sqe, self->socket_.Fd(), &self->msg_, MSG_NOSIGNAL);
+        }
+    }
+
+    static void Complete(BaseType* base) noexcept {
+        if (base->result < 0) {
+            stdexec::set_error(std::move(base->receiver_),
+                               std::error_code(-base->result, std::system_category()));
+        } else {
+            stdexec::set_value(std::move(base->receiver_), static_cast<size_t>(base->result));
+        }
+    }
+
+    static constexpr typename BaseType::Vtable vtable_{&Prepare, &Complete};
+
+    SocketType& socket_;
+    BuffersType buffers_;
+    ::msghdr msg_{};
+};
+
+class IoUringContext::Scheduler {
+    struct ScheduleEnv {
+        IoUringContext* context;
+        friend Scheduler tag_invoke(stdexec::get_completion_scheduler_t<stdexec::set_value_t>,
+                                    const ScheduleEnv& env) noexcept {
+            return Scheduler(env.context);
+        }
+    };
+
+    class ScheduleSender {
+        template <typename Receiver>
+        class Operation : OperationBase {
+        public:
+            Operation(IoUringContext& context, Receiver&& receiver) noexcept
+                : context_(context), receiver_(std::move(receiver)) {
+                execute = &Execute;
+            }
+
+            Operation(Operation&&) = delete;
+            Operation(const Operation&) = delete;
+
+            friend void tag_invoke(stdexec::start_t, Operation& op) noexcept { op.Start(); }
+
+        private:
+            void Start() noexcept { context_.Schedule(this); }
+
+            static void Execute(OperationBase* op) noexcept {
+                auto self = static_cast<Operation*>(op);
+                if (stdexec::get_stop_token(self->receiver_).stop_requested()) {
+                    stdexec::set_stopped(std::move(self->receiver_));
+                    return;
+                }
+                try {
+                    stdexec::set_value(std::move(self->receiver_));
+                } catch (...) {
+                    stdexec::set_error(std::move(self->receiver_), std::current_exception());
+                }
+            }
+
+            IoUringContext& context_;
+            Receiver receiver_;
+        };
+
+    public:
+        using is_sender = void;
+        using completion_sigs =
+            stdexec::completion_signatures<stdexec::set_value_t(),
+                                           stdexec::set_error_t(std::exception_ptr),
+                                           stdexec::set_stopped_t()>;
+
+        template <typename Env>
+        friend completion_sigs tag_invoke(stdexec::get_completion_signatures_t,
+                                          const ScheduleSender&, Env) noexcept {
+            return {};
+        }
+
+        friend ScheduleEnv tag_invoke(stdexec::get_env_t, const ScheduleSender& sender) noexcept {
+            return sender.env_;
+        }
+
+        template <stdexec::receiver_of<completion_sigs> Receiver>
+        friend Operation<std::remove_cvref_t<Receiver>> tag_invoke(stdexec::connect_t,
+                                                                   const ScheduleSender& sender,
+                                                                   Receiver&& receiver) noexcept {
+            return {*sender.env_.context, std::forward<Receiver>(receiver)};
+        }
+
+    private:
+        friend class Scheduler;
+        explicit ScheduleSender(ScheduleEnv env) noexcept : env_(env) {}
+
+        ScheduleEnv env_;
+    };
+
+    class ScheduleAtSender {
+    public:
+        using is_sender = void;
+        using completion_sigs =
+            stdexec::completion_signatures<stdexec::set_value_t(),
+                                           stdexec::set_error_t(std::exception_ptr),
+                                           stdexec::set_stopped_t()>;
+
+        template <typename Env>
+        friend completion_sigs tag_invoke(stdexec::get_completion_signatures_t,
+                                          const ScheduleAtSender&, Env) noexcept {
+            return {};
+        }
+
+        friend ScheduleEnv tag_invoke(stdexec::get_env_t, const ScheduleAtSender& sender) noexcept {
+            return sender.env_;
+        }
+
+        template <stdexec::receiver_of<completion_sigs> Receiver>
+        friend TimerOperation<std::remove_cvref_t<Receiver>> tag_invoke(
+            stdexec::connect_t, const ScheduleAtSender& sender, Receiver&& receiver) {
+            return {*sender.env_.context, sender.expiration_, std::forward<Receiver>(receiver)};
+        }
+
+    private:
+        friend class Scheduler;
+        ScheduleAtSender(ScheduleEnv env, TimePoint expiration) noexcept
+            : env_(env), expiration_(expiration) {}
+
+        ScheduleEnv env_;
+        TimePoint expiration_;
+    };
+
+public:
+    explicit Scheduler(IoUringContext* context) noexcept : context_(context) {}
+
+    friend ScheduleSender tag_invoke(stdexec::schedule_t, const Scheduler& scheduler) noexcept {
+        return scheduler.Schedule();
+    }
+
+    friend ScheduleAtSender tag_invoke(exec::schedule_at_t, const Scheduler& scheduler,
+                                       TimePoint expiration) noexcept {
+        return scheduler.ScheduleAt(expiration);
+    }
+
+    friend ScheduleAtSender tag_invoke(exec::schedule_after_t, const Scheduler& scheduler,
+                                       TimePoint::duration duration) noexcept {
+        return scheduler.ScheduleAfter(duration);
+    }
+
+    friend TimePoint tag_invoke(exec::now_t, const Scheduler& scheduler) noexcept {
+        return Scheduler::Now();
+    }
+
+    friend bool operator==(const Scheduler& a, const Scheduler& b) noexcept {
+        return a.context_ == b.context_;
+    }
+
+private:
+    ScheduleSender Schedule() const noexcept { return ScheduleSender{ScheduleEnv{context_}}; }
+
+    ScheduleAtSender ScheduleAt(TimePoint expiration) const noexcept {
+        return ScheduleAtSender{ScheduleEnv{context_}, expiration};
+    }
+
+    ScheduleAtSender ScheduleAfter(TimePoint::duration duration) const noexcept {
+        return ScheduleAtSender{ScheduleEnv{context_}, Now() + duration};
+    }
+
+    static TimePoint Now() noexcept { return TimePoint::clock::now(); }
+
+    IoUringContext* context_;
+};
+
+inline IoUringContext::Scheduler IoUringContext::GetScheduler() noexcept {
+    return Scheduler{this};
+}
+
+template <typename Protocol>
+class IoUringAcceptSender {
+public:
+    template <typename Receiver>
+    using OperationType = IoUringContext::SocketAcceptOperation<Receiver, Protocol>;
+    using AcceptorType = net::Acceptor<Protocol, IoUringContext>;
+    using SocketType = net::Socket<Protocol, IoUringContext>;
+
+    explicit IoUringAcceptSender(AcceptorType& acceptor) noexcept : acceptor_(acceptor) {}
+
+    using is_sender = void;
+    using completion_sigs = stdexec::completion_signatures<stdexec::set_value_t(SocketType&&),
+                                                           stdexec::set_error_t(std::error_code),
+                                                           stdexec::set_stopped_t()>;
+
+    template <typename Env>
+    friend completion_sigs tag_invoke(stdexec::get_completion_signatures_t,
+                                      const IoUringAcceptSender&, Env) noexcept {
+        return {};
+    }
+
+    friend stdexec::empty_env tag_invoke(stdexec::get_env_t,
+                                         const IoUringAcceptSender& sender) noexcept {
+        return {};
+    }
+
+    template <stdexec::__decays_to<IoUringAcceptSender> Sender,
+              stdexec::receiver_of<completion_sigs> Receiver>
+    friend OperationType<std::remove_cvref_t<Receiver>> tag_invoke(stdexec::connect_t,
+                                                                   Sender&& sender,
+                                                                   Receiver receiver) {
+        return {std::move(receiver), sender.acceptor_};
+    }
+
+private:
+    AcceptorType& acceptor_;
+};
+
+template <typename Protocol, typename Buffers>
+class IoUringRecvSomeSender {
+public:
+    template <typename Receiver>
+    using OperationType = IoUringContext::SocketRecvSomeOperation<Receiver, Protocol, Buffers>;
+    using SocketType = net::Socket<Protocol, IoUringContext>;
+
+    IoUringRecvSomeSender(SocketType& socket, Buffers buffers) noexcept
+        : socket_(socket), buffers_(buffers) {}
+
+    using is_sender = void;
+    using completion_sigs = stdexec::completion_signatures<stdexec::set_value_t(size_t),
+                                                           stdexec::set_error_t(std::error_code),
+                                                           stdexec::set_stopped_t()>;
+
+    template <typename Env>
+    friend completion_sigs tag_invoke(stdexec::get_completion_signatures_t,
+                                      const IoUringRecvSomeSender&, Env) noexcept {
+        return {};
+    }
+
+    friend stdexec::empty_env tag_invoke(stdexec::get_env_t,
+                                         const IoUringRecvSomeSender& sender) noexcept {
+        return {};
+    }
+
+    template <stdexec::__decays_to<IoUringRecvSomeSender> Sender,
+              stdexec::receiver_of<completion_sigs> Receiver>
+    friend OperationType<std::remove_cvref_t<Receiver>> tag_invoke(stdexec::connect_t,
+                                                                   Sender&& sender,
+                                                                   Receiver receiver) {
+        return {std::move(receiver), sender.socket_, sender.buffers_};
+    }
+
+private:
+    SocketType& socket_;
+    Buffers buffers_;
+};
+
+template <typename Protocol, typename Buffers>
+class IoUringSendSomeSender {
+public:
+    template <typename Receiver>
+    using OperationType = IoUringContext::SocketSendSomeOperation<Receiver, Protocol, Buffers>;
+    using SocketType = net::Socket<Protocol, IoUringContext>;
+
+    IoUringSendSomeSender(SocketType& socket, Buffers buffers) noexcept
+        : socket_(socket), buffers_(buffers) {}
+
+    using is_sender = void;
+    using completion_sigs = stdexec::completion_signatures<stdexec::set_value_t(size_t),
+                                                           stdexec::set_error_t(std::error_code),
+                                                           stdexec::set_stopped_t()>;
+
+    template <typename Env>
+    friend completion_sigs tag_invoke(stdexec::get_completion_signatures_t,
+                                      const IoUringSendSomeSender&, Env) noexcept {
+        return {};
+    }
+
+    friend stdexec::empty_env tag_invoke(stdexec::get_env_t,
+                                         const IoUringSendSomeSender& sender) noexcept {
+        return {};
+    }
+
+    template <stdexec::__decays_to<IoUringSendSomeSender> Sender,
+              stdexec::receiver_of<completion_sigs> Receiver>
+    friend OperationType<std::remove_cvref_t<Receiver>> tag_invoke(stdexec::connect_t,
+                                                                   Sender&& sender,
+                                                                   Receiver receiver) {
+        return {std::move(receiver), sender.socket_, sender.buffers_};
+    }
+
+private:
+    SocketType& socket_;
+    Buffers buffers_;
+};
+
+// Customizations of the socket CPOs for sockets bound to an IoUringContext, found by ADL.
+
+template <typename Protocol>
+IoUringAcceptSender<Protocol> tag_invoke(
+    cpo::AsyncAccept, net::Acceptor<Protocol, IoUringContext>& acceptor) noexcept {
+    return IoUringAcceptSender<Protocol>{acceptor};
+}
+
+template <typename Protocol, MutableBufferSequence Buffers>
+IoUringRecvSomeSender<Protocol, Buffers> tag_invoke(cpo::AsyncRecvSome,
+                                                    net::Socket<Protocol, IoUringContext>& socket,
+                                                    Buffers buffers) noexcept {
+    return {socket, buffers};
+}
+
+template <typename Protocol, ConstBufferSequence Buffers>
+IoUringSendSomeSender<Protocol, Buffers> tag_invoke(cpo::AsyncSendSome,
+                                                    net::Socket<Protocol, IoUringContext>& socket,
+                                                    Buffers buffers) noexcept {
+    return {socket, buffers};
+}
+
+}  // namespace fuchsia
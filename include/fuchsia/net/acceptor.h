@@ -8,20 +8,26 @@
 
 namespace fuchsia::net {
 
-template <typename Protocol>
-class Acceptor : public Socket<Protocol> {
+template <typename Protocol, typename Context = EpollContext>
+class Acceptor : public Socket<Protocol, Context> {
 public:
     using EndpointType = typename Protocol::Endpoint;
-    using ContextType = typename Socket<Protocol>::ContextType;
+    using ContextType = Context;
     using ProtocolType = Protocol;
 
-    Acceptor(ContextType& context, const EndpointType& endpoint, bool reuse_addr = true) noexcept
-        : Socket<Protocol>{context, endpoint.Protocol()} {
+    // With `reuse_port` set, several acceptors (typically one per EpollContext) can bind the same
+    // endpoint and the kernel load-balances incoming connections between them.
+    Acceptor(ContextType& context, const EndpointType& endpoint, bool reuse_addr = true,
+             bool reuse_port = false) noexcept
+        : Socket<Protocol, Context>{context, endpoint.Protocol()} {
         if (reuse_addr) {
-            Socket<Protocol>::SetReuseAddr();
+            Socket<Protocol, Context>::SetReuseAddr();
         }
-        Socket<Protocol>::Bind(endpoint);
-        Socket<Protocol>::Listen();
+        if (reuse_port) {
+            Socket<Protocol, Context>::SetReusePort();
+        }
+        Socket<Protocol, Context>::Bind(endpoint);
+        Socket<Protocol, Context>::Listen();
     }
 
     Acceptor(Acceptor&& other) noexcept = default;
@@ -0,0 +1,66 @@
+//
+// Created by wenjuxu on 2023/8/30.
+//
+
+#pragma once
+
+#include <netinet/udp.h>
+#include <sys/socket.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "fuchsia/buffer.h"
+
+namespace fuchsia::net {
+
+// Datagrams sent or received by one syscall at most, the rest of a batch waits for the next call.
+inline constexpr size_t kMaxDatagramBatch = 64;
+
+// One datagram of a batch sent with AsyncSendMany() or received with AsyncRecvMany(): `buffer` to
+// send from or receive into, and `endpoint` the datagram goes to or came from. For a received
+// datagram, `size` is filled in with its length.
+//
+// `segment_size` is for UDP offload. When sending, a non-zero value has the kernel (or the NIC)
+// split `buffer` into datagrams of that size, the last one may be shorter (UDP_SEGMENT, GSO). When
+// receiving on a socket with SetUdpGro(true), it is filled in with the size of the datagrams that
+// have been coalesced into `buffer`, 0 if the buffer holds a single one.
+template <typename Protocol, typename BufferType>
+struct Datagram {
+    BufferType buffer;
+    typename Protocol::Endpoint endpoint;
+    size_t size = 0;
+    uint16_t segment_size = 0;
+};
+
+// Room for the control message carrying a segment size, UDP_SEGMENT (uint16_t) when sending and
+// UDP_GRO (int) when receiving.
+struct alignas(::cmsghdr) SegmentControl {
+    char data[CMSG_SPACE(sizeof(int))];
+};
+
+// Attach `segment_size` to `msg` as a UDP_SEGMENT control message stored in `control`.
+inline void SetSegmentSize(::msghdr& msg, SegmentControl& control, uint16_t segment_size) noexcept {
+    msg.msg_control = control.data;
+    msg.msg_controllen = CMSG_SPACE(sizeof(segment_size));
+    auto cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_UDP;
+    cmsg->cmsg_type = UDP_SEGMENT;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(segment_size));
+    std::memcpy(CMSG_DATA(cmsg), &segment_size, sizeof(segment_size));
+}
+
+// The UDP_GRO segment size among the control messages of a received `msg`, 0 if there is none.
+inline uint16_t GetSegmentSize(::msghdr& msg) noexcept {
+    for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+            int segment_size = 0;
+            std::memcpy(&segment_size, CMSG_DATA(cmsg), sizeof(segment_size));
+            return static_cast<uint16_t>(segment_size);
+        }
+    }
+    return 0;
+}
+
+}  // namespace fuchsia::net
@@ -97,6 +97,11 @@ public:
 
     const ::sockaddr* Data() const noexcept { return &data_.base; }
 
+    // Where a syscall such as recvfrom() can store an address of up to Capacity() bytes.
+    ::sockaddr* Data() noexcept { return &data_.base; }
+
+    static constexpr std::size_t Capacity() noexcept { return sizeof(data_); }
+
     std::size_t Size() const noexcept {
         if (IsV4()) {
             return sizeof(data_.v4);
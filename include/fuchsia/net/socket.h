@@ -4,16 +4,32 @@
 
 #pragma once
 
+#include <linux/errqueue.h>
+#include <netinet/udp.h>
+#include <sys/sendfile.h>
+
+#include <algorithm>
+#include <compare>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+
 #include "fuchsia/epoll_context.h"
 
 namespace fuchsia::net {
 
 enum class ShutdownMode { Read = SHUT_RD, Write = SHUT_WR, Both = SHUT_RDWR };
 
-template <typename Protocol>
+// Context is the execution context driving asynchronous operations on the socket, EpollContext by
+// default. Sockets of other backends (e.g. IoUringContext) share the same synchronous interface.
+//
+// Closing a socket, and so destroying it, forgets its descriptor in the context, which is only safe
+// on the io thread of the context or while the context is not running: close sockets from the
+// operations running on the context, or stop the context and join its thread first.
+template <typename Protocol, typename Context = EpollContext>
 class Socket {
 public:
-    using ContextType = EpollContext;
+    using ContextType = Context;
     using ProtocolType = Protocol;
     using EndpointType = typename ProtocolType::Endpoint;
 
@@ -34,13 +50,19 @@ public:
         Bind(endpoint);
     }
 
-    Socket(Socket&& other) noexcept : fd_{std::exchange(other.fd_, -1)}, context_{other.context_} {}
+    Socket(Socket&& other) noexcept
+        : fd_{std::exchange(other.fd_, -1)},
+          context_{other.context_},
+          zero_copy_{other.zero_copy_},
+          zero_copy_sequence_{other.zero_copy_sequence_} {}
 
     Socket& operator=(Socket&& other) noexcept {
         if (this != &other) {
             Close();
             fd_ = std::exchange(other.fd_, -1);
             context_ = other.context_;
+            zero_copy_ = other.zero_copy_;
+            zero_copy_sequence_ = other.zero_copy_sequence_;
         }
         return *this;
     }
@@ -48,6 +70,7 @@ public:
     Socket(const Socket&) = delete;
     Socket& operator=(const Socket&) = delete;
 
+    // Closes the socket, see Close() for the thread it must run on.
     ~Socket() noexcept { Close(); }
 
     ContextType& Context() const noexcept { return *context_; }
@@ -74,6 +97,66 @@ public:
         }
     }
 
+    void SetReusePort() {
+        int optval = 1;
+        if (::setsockopt(fd_, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval)) < 0) {
+            throw std::system_error(errno, std::system_category(),
+                                    "setsockopt SO_REUSEPORT failed");
+        }
+    }
+
+    // Let the kernel busy poll the device queue for up to `duration` on blocking reads and
+    // on epoll_wait (SO_BUSY_POLL), raising it above net.core.busy_read requires CAP_NET_ADMIN.
+    void SetBusyPoll(std::chrono::microseconds duration) {
+        int optval = static_cast<int>(duration.count());
+        if (::setsockopt(fd_, SOL_SOCKET, SO_BUSY_POLL, &optval, sizeof(optval)) < 0) {
+            throw std::system_error(errno, std::system_category(),
+                                    "setsockopt SO_BUSY_POLL failed");
+        }
+    }
+
+    // UDP only: split every datagram sent into datagrams of `segment_size` bytes (UDP_SEGMENT), so
+    // that a large buffer goes down the stack once. 0 turns it off, Datagram::segment_size sets it
+    // per datagram instead.
+    void SetUdpSegment(uint16_t segment_size) {
+        int optval = segment_size;
+        if (::setsockopt(fd_, SOL_UDP, UDP_SEGMENT, &optval, sizeof(optval)) < 0) {
+            throw std::system_error(errno, std::system_category(),
+                                    "setsockopt UDP_SEGMENT failed");
+        }
+    }
+
+    // UDP only: let the kernel coalesce datagrams of the same flow into one buffer (UDP_GRO), with
+    // their size reported in Datagram::segment_size by AsyncRecvMany().
+    void SetUdpGro(bool on) {
+        int optval = on ? 1 : 0;
+        if (::setsockopt(fd_, SOL_UDP, UDP_GRO, &optval, sizeof(optval)) < 0) {
+            throw std::system_error(errno, std::system_category(), "setsockopt UDP_GRO failed");
+        }
+    }
+
+    // Allow sends with MSG_ZEROCOPY (SO_ZEROCOPY), without it the flag is ignored.
+    void SetZeroCopy(bool on) {
+        std::error_code ec;
+        if (!SetZeroCopy(on, ec)) {
+            throw std::system_error(ec, "setsockopt SO_ZEROCOPY failed");
+        }
+    }
+
+    bool SetZeroCopy(bool on, std::error_code& ec) noexcept {
+        int optval = on ? 1 : 0;
+        if (::setsockopt(fd_, SOL_SOCKET, SO_ZEROCOPY, &optval, sizeof(optval)) < 0) {
+            ec = std::error_code(errno, std::system_category());
+            return false;
+        }
+        zero_copy_ = on;
+        return true;
+    }
+
+    // The number the kernel gives to the next MSG_ZEROCOPY send of the socket. Sends are numbered
+    // from 0 in the order they are made, and completion notifications refer to ranges of them.
+    uint32_t ZeroCopySequence() const noexcept { return zero_copy_sequence_; }
+
     std::optional<std::pair<Socket, EndpointType>> Accept(std::error_code& ec) {
         ::sockaddr_storage addr;
         ::socklen_t len = sizeof(addr);
@@ -94,9 +177,32 @@ public:
         }
     }
 
+    // Start connecting to `endpoint`. Returns false with `ec` set if the connection is not
+    // established yet: std::errc::operation_in_progress means it goes on in the background, the
+    // socket becomes writable once it is done and Error() tells the outcome.
+    bool Connect(const EndpointType& endpoint, std::error_code& ec) {
+        if (::connect(fd_, endpoint.Data(), endpoint.Size()) == 0) {
+            return true;
+        }
+        // An interrupted connect goes on in the background as well.
+        int error = errno == EINTR ? EINPROGRESS : errno;
+        ec = std::error_code(error, std::system_category());
+        return false;
+    }
+
+    // The pending error of the socket (SO_ERROR), which reading clears.
+    std::error_code Error() const noexcept {
+        int error = 0;
+        ::socklen_t len = sizeof(error);
+        if (::getsockopt(fd_, SOL_SOCKET, SO_ERROR, &error, &len) < 0) {
+            error = errno;
+        }
+        return {error, std::system_category()};
+    }
+
     std::optional<size_t> Send(const void* data, size_t size, std::error_code& ec) {
         while (true) {
-            ssize_t n = ::send(fd_, data, size, 0);
+            ssize_t n = ::send(fd_, data, size, MSG_NOSIGNAL);
             if (n >= 0) {
                 return static_cast<size_t>(n);
             }
@@ -129,10 +235,32 @@ public:
         }
     }
 
-    std::optional<size_t> SendMsg(iovec* bufs, uint64_t count, std::error_code& ec) {
+    // `flags` are added to the ones of sendmsg(), e.g. MSG_ZEROCOPY.
+    std::optional<size_t> SendMsg(iovec* bufs, uint64_t count, std::error_code& ec,
+                                  int flags = 0) {
         msghdr msg{.msg_iov = bufs, .msg_iovlen = count};
         while (true) {
-            ssize_t n = ::sendmsg(fd_, &msg, 0);
+            ssize_t n = ::sendmsg(fd_, &msg, MSG_NOSIGNAL | flags);
+            if (n >= 0) {
+                if (n > 0 && zero_copy_ && (flags & MSG_ZEROCOPY) != 0) {
+                    ++zero_copy_sequence_;  // in step with the kernel, which numbered this send
+                }
+                return static_cast<size_t>(n);
+            }
+
+            if (errno == EINTR) {
+                continue;
+            }
+
+            ec = std::error_code(errno, std::system_category());
+            return std::nullopt;
+        }
+    }
+
+    // Send up to `count` bytes of the file `in_fd` from `offset`, which is advanced past them.
+    std::optional<size_t> SendFile(int in_fd, ::off_t& offset, size_t count, std::error_code& ec) {
+        while (true) {
+            ssize_t n = ::sendfile(fd_, in_fd, &offset, count);
             if (n >= 0) {
                 return static_cast<size_t>(n);
             }
@@ -166,18 +294,146 @@ public:
         }
     }
 
+    // Send a datagram to `endpoint`.
+    std::optional<size_t> SendTo(const void* data, size_t size, const EndpointType& endpoint,
+                                 std::error_code& ec) {
+        while (true) {
+            ssize_t n = ::sendto(fd_, data, size, MSG_NOSIGNAL, endpoint.Data(), endpoint.Size());
+            if (n >= 0) {
+                return static_cast<size_t>(n);
+            }
+
+            if (errno == EINTR) {
+                continue;
+            }
+
+            ec = std::error_code(errno, std::system_category());
+            return std::nullopt;
+        }
+    }
+
+    // Receive a datagram, which may be empty, and the endpoint it came from.
+    std::optional<size_t> RecvFrom(void* data, size_t size, EndpointType& endpoint,
+                                   std::error_code& ec) {
+        while (true) {
+            ::socklen_t len = EndpointType::Capacity();
+            ssize_t n = ::recvfrom(fd_, data, size, 0, endpoint.Data(), &len);
+            if (n >= 0) {
+                return static_cast<size_t>(n);
+            }
+
+            if (errno == EINTR) {
+                continue;
+            }
+
+            ec = std::error_code(errno, std::system_category());
+            return std::nullopt;
+        }
+    }
+
+    // Send up to `count` datagrams with one syscall, returns how many were sent.
+    std::optional<size_t> SendMMsg(::mmsghdr* msgs, unsigned int count, std::error_code& ec) {
+        while (true) {
+            int n = ::sendmmsg(fd_, msgs, count, MSG_NOSIGNAL);
+            if (n >= 0) {
+                return static_cast<size_t>(n);
+            }
+
+            if (errno == EINTR) {
+                continue;
+            }
+
+            ec = std::error_code(errno, std::system_category());
+            return std::nullopt;
+        }
+    }
+
+    // Receive up to `count` datagrams with one syscall, as many as are queued, returns how many
+    // were received.
+    std::optional<size_t> RecvMMsg(::mmsghdr* msgs, unsigned int count, std::error_code& ec) {
+        while (true) {
+            int n = ::recvmmsg(fd_, msgs, count, 0, nullptr);
+            if (n >= 0) {
+                return static_cast<size_t>(n);
+            }
+
+            if (errno == EINTR) {
+                continue;
+            }
+
+            ec = std::error_code(errno, std::system_category());
+            return std::nullopt;
+        }
+    }
+
+    // Take the completion notifications of MSG_ZEROCOPY sends from the error queue, once there are
+    // any, and returns how many of the `count` sends numbered from `first` (see ZeroCopySequence())
+    // they cover; notifications of other sends, e.g. of an earlier send that was given up on, do
+    // not count. `copied` is set if the kernel copied the data of any of them after all, e.g. over
+    // loopback.
+    std::optional<uint32_t> RecvZeroCopyCompletions(uint32_t first, uint32_t count, bool& copied,
+                                                    std::error_code& ec) {
+        bool any = false;
+        uint32_t completions = 0;
+        while (true) {
+            alignas(::cmsghdr) char control[CMSG_SPACE(sizeof(::sock_extended_err)) + 64];
+            msghdr msg{.msg_control = control, .msg_controllen = sizeof(control)};
+            if (::recvmsg(fd_, &msg, MSG_ERRQUEUE) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (any && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                    return completions;
+                }
+                ec = std::error_code(errno, std::system_category());
+                return std::nullopt;
+            }
+            any = true;
+            for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+                ::sock_extended_err err;
+                std::memcpy(&err, CMSG_DATA(cmsg), sizeof(err));
+                if (err.ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+                    continue;
+                }
+                // The range [ee_info, ee_data], relative to `first` so that the numbers may wrap.
+                int64_t begin = static_cast<int32_t>(err.ee_info - first);
+                int64_t end = static_cast<int64_t>(static_cast<int32_t>(err.ee_data - first)) + 1;
+                begin = std::max<int64_t>(begin, 0);
+                end = std::min<int64_t>(end, count);
+                if (begin < end) {
+                    completions += static_cast<uint32_t>(end - begin);
+                    copied = copied || (err.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0;
+                }
+            }
+        }
+    }
+
     void Shutdown(ShutdownMode type) {
         if (::shutdown(fd_, static_cast<int>(type)) < 0) {
             throw std::system_error(errno, std::system_category(), "shutdown socket failed");
         }
     }
 
+    // Must be called on the io thread of the context, or while the context is not running.
     void Close() {
+        if (fd_ < 0) {
+            return;
+        }
+        if constexpr (requires { context_->ReleaseDescriptor(fd_); }) {
+            context_->ReleaseDescriptor(fd_);
+        }
         ::close(fd_);
         fd_ = -1;
     }
 
-    constexpr auto operator<=>(const Socket&) const noexcept = default;
+    // Sockets are the same if they have the same descriptor, whatever their state.
+    constexpr auto operator<=>(const Socket& other) const noexcept {
+        return std::tie(fd_, context_) <=> std::tie(other.fd_, other.context_);
+    }
+
+    constexpr bool operator==(const Socket& other) const noexcept {
+        return fd_ == other.fd_ && context_ == other.context_;
+    }
 
 private:
     void OpenNonBlocking(ProtocolType protocol) {
@@ -188,8 +444,10 @@ private:
     }
 
 private:
-    int fd_;
+    int fd_ = -1;
     ContextType* context_;
+    bool zero_copy_ = false;  // SO_ZEROCOPY is on
+    uint32_t zero_copy_sequence_ = 0;
 };
 
 }  // namespace fuchsia::net
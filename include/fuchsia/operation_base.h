@@ -0,0 +1,31 @@
+//
+// Created by wenjuxu on 2023/8/19.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace fuchsia {
+
+// Base of every operation queued on an execution context (EpollContext, IoUringContext,
+// WorkStealingPool). `next` is the intrusive link of whatever queue the operation is in.
+struct OperationBase {
+#ifndef NDEBUG
+    uint64_t uuid;
+    static inline std::atomic<uint64_t> uuid_generator = 1;
+    OperationBase() noexcept : uuid(uuid_generator.fetch_add(1, std::memory_order_acq_rel)) {}
+#else
+    OperationBase() noexcept = default;
+#endif
+    // Operations are neither copyable nor movable
+    OperationBase(OperationBase&&) = delete;
+    OperationBase(const OperationBase&) = delete;
+
+    using ExecuteFunction = void(OperationBase*) noexcept;
+    std::atomic<ExecuteFunction*> execute = nullptr;
+    OperationBase* next = nullptr;
+};
+
+}  // namespace fuchsia
@@ -0,0 +1,123 @@
+//
+// Created by wenjuxu on 2023/8/21.
+//
+
+#pragma once
+
+#include <array>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "fuchsia/atomic_intrusive_queue.h"
+
+namespace fuchsia {
+
+// A size class allocator for the objects that come and go with connections and requests, such as
+// coroutine frames and sessions, so that a steady stream of requests does not hit malloc.
+//
+// Every EpollContext owns one and installs it as the current allocator of its thread while it
+// runs, Allocate() draws from the current allocator (or from the global heap if there is none).
+// Blocks remember their owner and can be freed from any thread: frees from other threads are
+// pushed onto a lock-free list that the owner takes back when it runs out of blocks.
+//
+// All chunks are released together when the allocator is destroyed, so all blocks must have been
+// freed by then.
+class SlabAllocator {
+public:
+    SlabAllocator() = default;
+    ~SlabAllocator();
+
+    SlabAllocator(const SlabAllocator&) = delete;
+    SlabAllocator& operator=(const SlabAllocator&) = delete;
+
+    // The allocator of the calling thread, or nullptr.
+    static SlabAllocator* Current() noexcept;
+
+    // Make `allocator` the one of the calling thread, returns the previous one.
+    static SlabAllocator* SetCurrent(SlabAllocator* allocator) noexcept;
+
+    // Blocks are aligned to 16 bytes, sizes above 16KB always come from the global heap.
+    static void* Allocate(size_t size);
+    static void Deallocate(void* ptr) noexcept;
+
+    // Number of 64KB chunks obtained from the global heap so far.
+    size_t ChunkCount() const noexcept { return chunks_.size(); }
+
+private:
+    struct alignas(16) BlockHeader {
+        SlabAllocator* owner;  // nullptr for blocks from the global heap
+        uint32_t size_class;
+    };
+
+    // A block in a free list, `next` lives in the (unused) payload.
+    struct FreeBlock : BlockHeader {
+        FreeBlock* next;
+    };
+
+    static constexpr size_t kMinBlockShift = 6;  // 64 bytes, header included
+    static constexpr size_t kNumSizeClasses = 9;  // up to 16KB
+    static constexpr size_t kMaxBlockSize = size_t{1} << (kMinBlockShift + kNumSizeClasses - 1);
+    static constexpr size_t kChunkSize = 64 * 1024;
+
+    static uint32_t SizeClassOf(size_t size) noexcept;
+
+    void* AllocateLocal(uint32_t size_class);
+    void DeallocateLocal(FreeBlock* block) noexcept;
+    void Refill(uint32_t size_class);
+    void DrainRemoteFrees() noexcept;
+
+    std::array<FreeBlock*, kNumSizeClasses> free_lists_{};
+    std::vector<void*> chunks_;
+    AtomicIntrusiveQueue<FreeBlock> remote_frees_;
+};
+
+// A standard allocator on top of SlabAllocator::Allocate(), e.g. for std::allocate_shared.
+template <typename T>
+struct SlabStdAllocator {
+    static_assert(alignof(T) <= 16, "SlabAllocator blocks are aligned to 16 bytes");
+
+    using value_type = T;
+
+    SlabStdAllocator() noexcept = default;
+
+    template <typename U>
+    SlabStdAllocator(const SlabStdAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) { return static_cast<T*>(SlabAllocator::Allocate(n * sizeof(T))); }
+
+    void deallocate(T* ptr, size_t) noexcept { SlabAllocator::Deallocate(ptr); }
+
+    template <typename U>
+    friend bool operator==(const SlabStdAllocator&, const SlabStdAllocator<U>&) noexcept {
+        return true;
+    }
+};
+
+// The promise type of `Task` with its coroutine frames allocated by SlabAllocator. Opt a coroutine
+// signature in by specializing std::coroutine_traits, e.g.
+//
+//     template <>
+//     struct std::coroutine_traits<exec::task<void>, Foo&> {
+//         using promise_type = fuchsia::SlabPromise<exec::task<void>>;
+//     };
+//
+// The base promise's get_return_object() is inherited, and it makes the task's handle from the
+// base subobject with coroutine_handle::from_promise(*this). That only finds the frame because
+// SlabPromise adds nothing to the base, so the two promises start at the same address, which the
+// static_assert below keeps true.
+template <typename Task>
+struct SlabPromise : Task::promise_type {
+    static void* operator new(size_t size) {
+        static_assert(sizeof(SlabPromise) == sizeof(typename Task::promise_type) &&
+                          !std::is_polymorphic_v<typename Task::promise_type>,
+                      "SlabPromise must share the address of its base promise");
+        return SlabAllocator::Allocate(size);
+    }
+
+    static void operator delete(void* ptr) noexcept { SlabAllocator::Deallocate(ptr); }
+};
+
+}  // namespace fuchsia
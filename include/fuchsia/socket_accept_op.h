@@ -97,6 +97,14 @@ struct AsyncAccept {
         -> SocketAcceptSender<Protocol> {
         return SocketAcceptSender<Protocol>{acceptor};
     }
+
+    // Acceptors of other contexts (e.g. IoUringContext) customize the operation with tag_invoke.
+    template <typename Protocol, typename Context>
+    requires stdexec::tag_invocable<AsyncAccept, net::Acceptor<Protocol, Context>&>
+    constexpr auto operator()(net::Acceptor<Protocol, Context>& acceptor) const noexcept
+        -> stdexec::tag_invoke_result_t<AsyncAccept, net::Acceptor<Protocol, Context>&> {
+        return stdexec::tag_invoke(*this, acceptor);
+    }
 };
 
 }  // namespace cpo
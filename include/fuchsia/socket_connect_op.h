@@ -0,0 +1,129 @@
+//
+// Created by wenjuxu on 2023/8/28.
+//
+
+#pragma once
+
+#include "fuchsia/epoll_context.h"
+#include "fuchsia/net/socket.h"
+#include "fuchsia/socket_op_base.h"
+
+namespace fuchsia {
+
+// A non-blocking connect: the first attempt usually reports EINPROGRESS, then the operation waits
+// for the socket to become writable and takes the outcome from SO_ERROR.
+template <typename Receiver, typename Protocol>
+class EpollContext::SocketConnectOperation : public SocketOperationBase<Receiver, Protocol> {
+public:
+    using EndpointType = typename Protocol::Endpoint;
+    using SocketType = typename Protocol::Socket;
+    using BaseType = SocketOperationBase<Receiver, Protocol>;
+
+    SocketConnectOperation(Receiver receiver, SocketType& socket, const EndpointType& endpoint)
+        : BaseType(std::move(receiver), socket, vtable_, BaseType::OperationType::Write),
+          endpoint_(endpoint) {}
+
+private:
+    static void Start(BaseType* base) noexcept {
+        auto self = static_cast<SocketConnectOperation*>(base);
+        if (self->in_progress_) {
+            // Woken up by writability, the connection is either established or failed.
+            base->ec_ = self->socket_.Error();
+            return;
+        }
+        if (self->socket_.Connect(self->endpoint_, base->ec_)) {
+            return;
+        }
+        if (base->ec_ == std::errc::operation_in_progress) {
+            self->in_progress_ = true;
+            base->ec_ = std::make_error_code(std::errc::operation_would_block);  // wait for write
+        }
+    }
+
+    static void Complete(BaseType* base) noexcept {
+        if (base->ec_ == std::errc::operation_canceled) {
+            stdexec::set_stopped(std::move(base->receiver_));
+        } else if (base->ec_) {
+            stdexec::set_error(std::move(base->receiver_), base->ec_);
+        } else {
+            stdexec::set_value(std::move(base->receiver_));
+        }
+    }
+
+    static constexpr typename BaseType::Vtable vtable_{&Start, &Complete};
+
+    EndpointType endpoint_;
+    bool in_progress_ = false;
+};
+
+template <typename Protocol>
+class SocketConnectSender {
+public:
+    template <typename Receiver>
+    using OperationType = EpollContext::SocketConnectOperation<Receiver, Protocol>;
+    using EndpointType = typename Protocol::Endpoint;
+    using SocketType = typename Protocol::Socket;
+
+    SocketConnectSender(SocketType& socket, const EndpointType& endpoint) noexcept
+        : socket_(socket), endpoint_(endpoint) {}
+
+    using is_sender = void;
+    using completion_sigs = stdexec::completion_signatures<stdexec::set_value_t(),
+                                                           stdexec::set_error_t(std::error_code),
+                                                           stdexec::set_stopped_t()>;
+
+    template <typename Env>
+    friend completion_sigs tag_invoke(stdexec::get_completion_signatures_t,
+                                      const SocketConnectSender&, Env) noexcept {
+        return {};
+    }
+
+    friend stdexec::empty_env tag_invoke(stdexec::get_env_t,
+                                         const SocketConnectSender& sender) noexcept {
+        return {};
+    }
+
+    template <stdexec::__decays_to<SocketConnectSender> Sender,
+              stdexec::receiver_of<completion_sigs> Receiver>
+    friend OperationType<std::remove_cvref_t<Receiver>> tag_invoke(stdexec::connect_t,
+                                                                   Sender&& sender,
+                                                                   Receiver receiver) noexcept {
+        return {std::move(receiver), sender.socket_, sender.endpoint_};
+    }
+
+private:
+    SocketType& socket_;
+    EndpointType endpoint_;
+};
+
+namespace cpo {
+
+// Connect an open socket to `endpoint`, e.g.
+//
+//     fuchsia::net::Tcp::Socket socket{context, fuchsia::net::Tcp::V4()};
+//     co_await fuchsia::AsyncConnect(socket, endpoint);
+struct AsyncConnect {
+    template <typename Protocol>
+    constexpr auto operator()(net::Socket<Protocol>& socket,
+                              const typename Protocol::Endpoint& endpoint) const noexcept
+        -> SocketConnectSender<Protocol> {
+        return {socket, endpoint};
+    }
+
+    // Sockets of other contexts (e.g. IoUringContext) customize the operation with tag_invoke.
+    template <typename Protocol, typename Context>
+    requires stdexec::tag_invocable<AsyncConnect, net::Socket<Protocol, Context>&,
+                                    const typename Protocol::Endpoint&>
+    constexpr auto operator()(net::Socket<Protocol, Context>& socket,
+                              const typename Protocol::Endpoint& endpoint) const noexcept
+        -> stdexec::tag_invoke_result_t<AsyncConnect, net::Socket<Protocol, Context>&,
+                                        const typename Protocol::Endpoint&> {
+        return stdexec::tag_invoke(*this, socket, endpoint);
+    }
+};
+
+}  // namespace cpo
+
+inline constexpr cpo::AsyncConnect AsyncConnect;
+
+}  // namespace fuchsia
@@ -4,12 +4,19 @@
 
 #pragma once
 
-#include <sys/epoll.h>
+#include <optional>
 
 #include "fuchsia/epoll_context.h"
 
 namespace fuchsia {
 
+// Base of all socket operations. The operation first tries the syscall right away, and only if it
+// would block, parks itself in the read or write slot of the socket's descriptor state until the
+// (edge-triggered) readiness event arrives, then tries again.
+//
+// Cancellation may be requested from any thread, while completion is always delivered on the io
+// thread by exactly one party: either the operation itself (which marks `Completed`), or the cancel
+// operation once it is known that no other wakeup of this operation is still queued.
 template <typename Receiver, typename Protocol>
 class EpollContext::SocketOperationBase : OperationBase {
 public:
@@ -22,7 +29,9 @@ public:
         void (*complete)(SocketOperationBase*) noexcept = nullptr;
     };
 
-    enum class OperationType { Read, Write };
+    // What the operation waits for when it would block. An operation may change it in its start
+    // function, before reporting that it would block.
+    enum class OperationType { Read, Write, Error };
 
     SocketOperationBase(Receiver receiver, SocketType& socket, const Vtable& vtable,
                         OperationType op_type)
@@ -31,104 +40,126 @@ public:
           context_(&socket.Context()),
           vtable_(vtable),
           state_(0),
-          stop_callback_(stdexec::get_stop_token(stdexec::get_env(receiver_)), *this),
+          cancel_operation_(this),
           op_type_(op_type),
           ec_() {}
 
     friend void tag_invoke(stdexec::start_t, SocketOperationBase& self) noexcept { self.Start(); }
 
 private:
+    // Where the operation is, as seen from the io thread.
+    enum class Stage {
+        Idle,       // running, completed or not started yet
+        Scheduled,  // start has been scheduled from a remote thread
+        Parked,     // waiting in the descriptor slot, or its wakeup is queued
+    };
+
     void Start() noexcept {
-        if (context_->IsRunningOnIOThread()) {
+        bool local = context_->IsRunningOnIOThread();
+        if (!local) {
+            stage_ = Stage::Scheduled;
+        }
+        // Registered on start rather than on construction, so that a completion can never be
+        // delivered before the operation is started.
+        stop_callback_.emplace(stdexec::get_stop_token(stdexec::get_env(receiver_)), *this);
+        if (local) {
             StartLocal();
         } else {
-            StartRemote();
+            execute = &OnStartRemoteScheduled;
+            context_->ScheduleRemote(this);
         }
     }
 
+    static void OnStartRemoteScheduled(OperationBase* op) noexcept {
+        auto self = static_cast<SocketOperationBase*>(op);
+        self->stage_ = Stage::Idle;
+        self->StartLocal();
+    }
+
     void StartLocal() noexcept {
+        if ((state_.load(std::memory_order_acquire) & OperationFlags::Cancelled) != 0) {
+            // The cancel operation is responsible for the completion.
+            return;
+        }
+        Perform();
+    }
+
+    void Perform() noexcept {
         vtable_.start(this);
         if (ec_ == std::errc::resource_unavailable_try_again ||
             ec_ == std::errc::operation_would_block) {
-            ec_.clear();
-            AddEpollEvent();
-            execute = &ExecuteOnWakeup;
-            return;
+            ec_ = context_->WaitDescriptor(socket_.Fd(), this, ToWaitType(op_type_));
+            if (!ec_) {
+                stage_ = Stage::Parked;
+                execute = &ExecuteOnWakeup;
+                return;
+            }
         }
 
         auto old_state = state_.fetch_or(OperationFlags::Completed, std::memory_order_acq_rel);
         if ((old_state & OperationFlags::Cancelled) != 0) {
-            // io has been cancelled by a remote thread.
-            // The other thread is responsible for enqueueing the operation completion.
+            // io has been cancelled, the cancel operation is responsible for the completion.
             return;
         }
 
         vtable_.complete(this);
     }
 
-    void StartRemote() noexcept {
-        execute = &OnStartRemoteScheduled;
-        context_->ScheduleRemote(this);
-    }
-
-    static void OnStartRemoteScheduled(OperationBase* op) noexcept {
-        static_cast<SocketOperationBase*>(op)->StartLocal();
-    }
-
-    static void ExecuteAlreadyCanceled(OperationBase* op) noexcept {
-        auto self = static_cast<SocketOperationBase*>(op);
-        stdexec::set_stopped(std::move(self->receiver_));
-    }
-
     static void ExecuteOnWakeup(OperationBase* op) noexcept {
         auto self = static_cast<SocketOperationBase*>(op);
-        self->RemoveEpollEvent();
-
-        auto old_state =
-            self->state_.fetch_or(OperationFlags::Completed, std::memory_order_acq_rel);
-        if ((old_state & OperationFlags::Cancelled) != 0) {
-            // io has been cancelled by a remote thread.
-            // The other thread is responsible for enqueueing the operation completion
-            return;
-        }
-
-        // trigger start again to obtain the result of this operation.
-        self->vtable_.start(self);
-        self->vtable_.complete(self);
+        self->stage_ = Stage::Idle;
+        self->StartLocal();  // try again to obtain the result of this operation
     }
 
     void RequestStop() noexcept {
         auto old_state = state_.fetch_or(OperationFlags::Cancelled, std::memory_order_acq_rel);
         if ((old_state & OperationFlags::Completed) == 0) {
             // io not completed yet
-            RemoveEpollEvent();
-            execute = &ExecuteAlreadyCanceled;
-            context_->ScheduleRemote(this);
+            cancel_operation_.execute = &OnCancelScheduled;
+            context_->Schedule(&cancel_operation_);
         } else {
             // io already completed thus cannot be canceled
         }
     }
 
-    void AddEpollEvent() noexcept {
-        struct epoll_event event {};
-        if (op_type_ == OperationType::Read) {
-            event.events = EPOLLIN | EPOLLRDHUP | EPOLLHUP;
-        } else {
-            event.events = EPOLLOUT | EPOLLRDHUP | EPOLLHUP;
-        }
-        event.data.ptr = this;
-        if (::epoll_ctl(context_->epoll_fd_, EPOLL_CTL_ADD, socket_.Fd(), &event) != 0) {
-            ec_ = std::make_error_code(std::errc(errno));
+    static void OnCancelScheduled(OperationBase* op) noexcept {
+        auto self = static_cast<CancelOperation*>(op)->self;
+        switch (self->stage_) {
+            case Stage::Scheduled:
+                // the start is still queued, run after it.
+                self->context_->ScheduleLocal(op);
+                return;
+            case Stage::Parked:
+                if (!self->context_->CancelWait(self->socket_.Fd(), self,
+                                                ToWaitType(self->op_type_))) {
+                    // readiness arrived and the wakeup is already queued, run after it.
+                    self->context_->ScheduleLocal(op);
+                    return;
+                }
+                self->stage_ = Stage::Idle;
+                break;
+            case Stage::Idle:
+                break;
         }
+        stdexec::set_stopped(std::move(self->receiver_));
     }
 
-    void RemoveEpollEvent() noexcept {
-        struct epoll_event event {};
-        if (::epoll_ctl(context_->epoll_fd_, EPOLL_CTL_DEL, socket_.Fd(), &event) != 0) {
-            ec_ = std::make_error_code(std::errc(errno));
+    static constexpr WaitType ToWaitType(OperationType op_type) noexcept {
+        switch (op_type) {
+            case OperationType::Read:
+                return WaitType::Read;
+            case OperationType::Write:
+                return WaitType::Write;
+            default:
+                return WaitType::Error;
         }
     }
 
+    struct CancelOperation : OperationBase {
+        explicit CancelOperation(SocketOperationBase* self) noexcept : self(self) {}
+        SocketOperationBase* self;
+    };
+
     struct StopCallback {
         SocketOperationBase& operation;
         void operator()() noexcept { operation.RequestStop(); }
@@ -140,7 +171,9 @@ public:
     ContextType* context_;
     const Vtable& vtable_;
     std::atomic<uint32_t> state_;
-    typename StopTokenType::template callback_type<StopCallback> stop_callback_;
+    Stage stage_ = Stage::Idle;
+    CancelOperation cancel_operation_;
+    std::optional<typename StopTokenType::template callback_type<StopCallback>> stop_callback_;
     OperationType op_type_;
     std::error_code ec_;
 };
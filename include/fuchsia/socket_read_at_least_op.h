@@ -0,0 +1,141 @@
+//
+// Created by wenjuxu on 2023/9/5.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <new>
+
+#include "fuchsia/dynamic_buffer.h"
+#include "fuchsia/epoll_context.h"
+#include "fuchsia/net/socket.h"
+#include "fuchsia/socket_op_base.h"
+
+namespace fuchsia {
+
+// Reads into a DynamicBuffer until it holds at least a given number of readable bytes, e.g. a
+// length prefix and then the whole frame. Unlike SocketRecvExactlyOperation it reads whatever is
+// there, so the bytes of the next frames end up in the buffer too rather than costing reads of
+// their own. The peer closing the connection before is an error, and so is a count past the max
+// size of the buffer, with std::errc::message_size.
+template <typename Receiver, typename Protocol>
+class EpollContext::SocketReadAtLeastOperation : public SocketOperationBase<Receiver, Protocol> {
+public:
+    using SocketType = typename Protocol::Socket;
+    using BaseType = SocketOperationBase<Receiver, Protocol>;
+
+    SocketReadAtLeastOperation(Receiver receiver, SocketType& socket, DynamicBuffer& buffer,
+                               size_t count)
+        : BaseType(std::move(receiver), socket, vtable_, BaseType::OperationType::Read),
+          buffer_(buffer),
+          count_(count) {}
+
+private:
+    static void Start(BaseType* base) noexcept {
+        auto self = static_cast<SocketReadAtLeastOperation*>(base);
+        if (self->count_ > self->buffer_.MaxSize()) {
+            base->ec_ = std::make_error_code(std::errc::message_size);
+            return;
+        }
+        while (self->buffer_.Size() < self->count_) {
+            MutableBuffer space;
+            try {
+                space = self->buffer_.Prepare(std::max(self->buffer_.ReadSize(),
+                                                       self->count_ - self->buffer_.Size()));
+            } catch (const std::bad_alloc&) {
+                base->ec_ = std::make_error_code(std::errc::not_enough_memory);
+                return;
+            }
+            auto res = self->socket_.Recv(space.Data(), space.Size(), base->ec_);
+            if (!res.has_value()) {
+                return;
+            }
+            self->buffer_.Commit(res.value());
+        }
+    }
+
+    static void Complete(BaseType* base) noexcept {
+        if (base->ec_ == std::errc::operation_canceled) {
+            stdexec::set_stopped(std::move(base->receiver_));
+        } else if (base->ec_) {
+            stdexec::set_error(std::move(base->receiver_), base->ec_);
+        } else {
+            auto self = static_cast<SocketReadAtLeastOperation*>(base);
+            stdexec::set_value(std::move(base->receiver_), self->buffer_.Size());
+        }
+    }
+
+    static constexpr typename BaseType::Vtable vtable_{&Start, &Complete};
+
+    DynamicBuffer& buffer_;
+    size_t count_;
+};
+
+template <typename Protocol>
+class SocketReadAtLeastSender {
+public:
+    template <typename Receiver>
+    using OperationType = EpollContext::SocketReadAtLeastOperation<Receiver, Protocol>;
+    using SocketType = typename Protocol::Socket;
+
+    SocketReadAtLeastSender(SocketType& socket, DynamicBuffer& buffer, size_t count) noexcept
+        : socket_(socket), buffer_(buffer), count_(count) {}
+
+    using is_sender = void;
+    using completion_sigs = stdexec::completion_signatures<stdexec::set_value_t(size_t),
+                                                           stdexec::set_error_t(std::error_code),
+                                                           stdexec::set_stopped_t()>;
+
+    template <typename Env>
+    friend completion_sigs tag_invoke(stdexec::get_completion_signatures_t,
+                                      const SocketReadAtLeastSender&, Env) noexcept {
+        return {};
+    }
+
+    friend stdexec::empty_env tag_invoke(stdexec::get_env_t,
+                                         const SocketReadAtLeastSender& sender) noexcept {
+        return {};
+    }
+
+    template <stdexec::__decays_to<SocketReadAtLeastSender> Sender,
+              stdexec::receiver_of<completion_sigs> Receiver>
+    friend OperationType<std::remove_cvref_t<Receiver>> tag_invoke(stdexec::connect_t,
+                                                                   Sender&& sender,
+                                                                   Receiver receiver) noexcept {
+        return {std::move(receiver), sender.socket_, sender.buffer_, sender.count_};
+    }
+
+private:
+    SocketType& socket_;
+    DynamicBuffer& buffer_;
+    size_t count_;
+};
+
+namespace cpo {
+
+// Completes with the number of readable bytes of `buffer` once there are at least `count` of them.
+struct AsyncReadAtLeast {
+    template <typename Protocol>
+    constexpr auto operator()(net::Socket<Protocol>& socket, DynamicBuffer& buffer,
+                              size_t count) const noexcept -> SocketReadAtLeastSender<Protocol> {
+        return {socket, buffer, count};
+    }
+
+    // Sockets of other contexts (e.g. IoUringContext) customize the operation with tag_invoke.
+    template <typename Protocol, typename Context>
+    requires stdexec::tag_invocable<AsyncReadAtLeast, net::Socket<Protocol, Context>&,
+                                    DynamicBuffer&, size_t>
+    constexpr auto operator()(net::Socket<Protocol, Context>& socket, DynamicBuffer& buffer,
+                              size_t count) const noexcept
+        -> stdexec::tag_invoke_result_t<AsyncReadAtLeast, net::Socket<Protocol, Context>&,
+                                        DynamicBuffer&, size_t> {
+        return stdexec::tag_invoke(*this, socket, buffer, count);
+    }
+};
+
+}  // namespace cpo
+
+inline constexpr cpo::AsyncReadAtLeast AsyncReadAtLeast;
+
+}  // namespace fuchsia
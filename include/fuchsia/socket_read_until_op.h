@@ -0,0 +1,177 @@
+//
+// Created by wenjuxu on 2023/9/5.
+//
+
+#pragma once
+
+#include <cstring>
+#include <new>
+#include <string_view>
+
+#include "fuchsia/dynamic_buffer.h"
+#include "fuchsia/epoll_context.h"
+#include "fuchsia/net/socket.h"
+#include "fuchsia/socket_op_base.h"
+
+namespace fuchsia {
+
+// Reads into a DynamicBuffer until its readable bytes contain the delimiter. The bytes already in
+// the buffer are searched first, so a message read along with the previous one completes without
+// a syscall; after every read only the new bytes, plus the delimiter size - 1 before them, are
+// searched again. The search is memchr() / memmem(), vectorized by the C library.
+//
+// The peer closing the connection before the delimiter is an error, and so is a full buffer,
+// with std::errc::message_size.
+template <typename Receiver, typename Protocol>
+class EpollContext::SocketReadUntilOperation : public SocketOperationBase<Receiver, Protocol> {
+public:
+    using SocketType = typename Protocol::Socket;
+    using BaseType = SocketOperationBase<Receiver, Protocol>;
+
+    SocketReadUntilOperation(Receiver receiver, SocketType& socket, DynamicBuffer& buffer,
+                             std::string_view delimiter)
+        : BaseType(std::move(receiver), socket, vtable_, BaseType::OperationType::Read),
+          buffer_(buffer),
+          delimiter_(delimiter),
+          scanned_(0),
+          size_(0) {}
+
+private:
+    static void Start(BaseType* base) noexcept {
+        auto self = static_cast<SocketReadUntilOperation*>(base);
+        while (!self->Search()) {
+            size_t read_size = self->buffer_.ReadSize();
+            if (read_size == 0) {
+                base->ec_ = std::make_error_code(std::errc::message_size);
+                return;
+            }
+            MutableBuffer space;
+            try {
+                space = self->buffer_.Prepare(read_size);
+            } catch (const std::bad_alloc&) {
+                base->ec_ = std::make_error_code(std::errc::not_enough_memory);
+                return;
+            }
+            auto res = self->socket_.Recv(space.Data(), space.Size(), base->ec_);
+            if (!res.has_value()) {
+                return;
+            }
+            self->buffer_.Commit(res.value());
+        }
+    }
+
+    static void Complete(BaseType* base) noexcept {
+        if (base->ec_ == std::errc::operation_canceled) {
+            stdexec::set_stopped(std::move(base->receiver_));
+        } else if (base->ec_) {
+            stdexec::set_error(std::move(base->receiver_), base->ec_);
+        } else {
+            auto self = static_cast<SocketReadUntilOperation*>(base);
+            stdexec::set_value(std::move(base->receiver_), self->size_);
+        }
+    }
+
+    // Look for the delimiter in the readable bytes not ruled out yet, and set size_ up to the end
+    // of it if found.
+    bool Search() noexcept {
+        auto data = buffer_.View();
+        if (delimiter_.size() > data.size()) {
+            return false;
+        }
+        const char* begin = data.data() + scanned_;
+        size_t size = data.size() - scanned_;
+        const void* found = nullptr;
+        if (delimiter_.empty()) {
+            found = begin;
+        } else if (delimiter_.size() == 1) {
+            found = std::memchr(begin, delimiter_.front(), size);
+        } else {
+            found = ::memmem(begin, size, delimiter_.data(), delimiter_.size());
+        }
+        if (found == nullptr) {
+            scanned_ = data.size() - delimiter_.size() + 1;  // a match could still start there
+            return false;
+        }
+        size_ = static_cast<const char*>(found) - data.data() + delimiter_.size();
+        return true;
+    }
+
+    static constexpr typename BaseType::Vtable vtable_{&Start, &Complete};
+
+    DynamicBuffer& buffer_;
+    std::string_view delimiter_;
+    size_t scanned_;  // offset in the readable bytes the delimiter cannot start before
+    size_t size_;
+};
+
+template <typename Protocol>
+class SocketReadUntilSender {
+public:
+    template <typename Receiver>
+    using OperationType = EpollContext::SocketReadUntilOperation<Receiver, Protocol>;
+    using SocketType = typename Protocol::Socket;
+
+    SocketReadUntilSender(SocketType& socket, DynamicBuffer& buffer,
+                          std::string_view delimiter) noexcept
+        : socket_(socket), buffer_(buffer), delimiter_(delimiter) {}
+
+    using is_sender = void;
+    using completion_sigs = stdexec::completion_signatures<stdexec::set_value_t(size_t),
+                                                           stdexec::set_error_t(std::error_code),
+                                                           stdexec::set_stopped_t()>;
+
+    template <typename Env>
+    friend completion_sigs tag_invoke(stdexec::get_completion_signatures_t,
+                                      const SocketReadUntilSender&, Env) noexcept {
+        return {};
+    }
+
+    friend stdexec::empty_env tag_invoke(stdexec::get_env_t,
+                                         const SocketReadUntilSender& sender) noexcept {
+        return {};
+    }
+
+    template <stdexec::__decays_to<SocketReadUntilSender> Sender,
+              stdexec::receiver_of<completion_sigs> Receiver>
+    friend OperationType<std::remove_cvref_t<Receiver>> tag_invoke(stdexec::connect_t,
+                                                                   Sender&& sender,
+                                                                   Receiver receiver) noexcept {
+        return {std::move(receiver), sender.socket_, sender.buffer_, sender.delimiter_};
+    }
+
+private:
+    SocketType& socket_;
+    DynamicBuffer& buffer_;
+    std::string_view delimiter_;
+};
+
+namespace cpo {
+
+// Completes with the number of readable bytes of `buffer` up to and including the first
+// `delimiter`, which must outlive the operation. The bytes read past it are left in the buffer,
+// consume the message before reading the next one.
+struct AsyncReadUntil {
+    template <typename Protocol>
+    constexpr auto operator()(net::Socket<Protocol>& socket, DynamicBuffer& buffer,
+                              std::string_view delimiter) const noexcept
+        -> SocketReadUntilSender<Protocol> {
+        return {socket, buffer, delimiter};
+    }
+
+    // Sockets of other contexts (e.g. IoUringContext) customize the operation with tag_invoke.
+    template <typename Protocol, typename Context>
+    requires stdexec::tag_invocable<AsyncReadUntil, net::Socket<Protocol, Context>&,
+                                    DynamicBuffer&, std::string_view>
+    constexpr auto operator()(net::Socket<Protocol, Context>& socket, DynamicBuffer& buffer,
+                              std::string_view delimiter) const noexcept
+        -> stdexec::tag_invoke_result_t<AsyncReadUntil, net::Socket<Protocol, Context>&,
+                                        DynamicBuffer&, std::string_view> {
+        return stdexec::tag_invoke(*this, socket, buffer, delimiter);
+    }
+};
+
+}  // namespace cpo
+
+inline constexpr cpo::AsyncReadUntil AsyncReadUntil;
+
+}  // namespace fuchsia
@@ -0,0 +1,131 @@
+//
+// Created by wenjuxu on 2023/8/23.
+//
+
+#pragma once
+
+#include "fuchsia/buffer_sequence_adapter.h"
+#include "fuchsia/epoll_context.h"
+#include "fuchsia/net/socket.h"
+#include "fuchsia/socket_op_base.h"
+
+namespace fuchsia {
+
+// Fills the whole buffer sequence, the counterpart of SocketSendAllOperation: the iovecs are
+// advanced in place after every partial read, and the operation waits for readability whenever
+// the socket runs dry. The peer closing the connection before is an error.
+template <typename Receiver, typename Protocol, typename Buffers>
+class EpollContext::SocketRecvExactlyOperation : public SocketOperationBase<Receiver, Protocol> {
+public:
+    using SocketType = typename Protocol::Socket;
+    using BaseType = SocketOperationBase<Receiver, Protocol>;
+    using BuffersType = BufferSequenceAdapter<MutableBuffer, Buffers>;
+
+    SocketRecvExactlyOperation(Receiver receiver, SocketType& socket, Buffers buffers)
+        : BaseType(std::move(receiver), socket, vtable_, BaseType::OperationType::Read),
+          buffers_(buffers),
+          bytes_transferred_(0) {}
+
+private:
+    static void Start(BaseType* base) noexcept {
+        auto self = static_cast<SocketRecvExactlyOperation*>(base);
+        while (!self->buffers_.AllEmpty()) {
+            std::optional<size_t> res;
+            if constexpr (BuffersType::IsSingleBuffer) {
+                auto buffer = self->buffers_.Buffers();
+                res = self->socket_.Recv(buffer->iov_base, buffer->iov_len, base->ec_);
+            } else {
+                res = self->socket_.RecvMsg(self->buffers_.Buffers(), self->buffers_.Count(),
+                                            base->ec_);
+            }
+            if (!res.has_value()) {
+                return;
+            }
+            self->bytes_transferred_ += res.value();
+            self->buffers_.Advance(res.value());
+        }
+    }
+
+    static void Complete(BaseType* base) noexcept {
+        if (base->ec_ == std::errc::operation_canceled) {
+            stdexec::set_stopped(std::move(base->receiver_));
+        } else if (base->ec_) {
+            stdexec::set_error(std::move(base->receiver_), base->ec_);
+        } else {
+            auto self = static_cast<SocketRecvExactlyOperation*>(base);
+            stdexec::set_value(std::move(base->receiver_), self->bytes_transferred_);
+        }
+    }
+
+    static constexpr typename BaseType::Vtable vtable_{&Start, &Complete};
+
+    BuffersType buffers_;
+    size_t bytes_transferred_;
+};
+
+template <typename Protocol, typename Buffers>
+class SocketRecvExactlySender {
+public:
+    template <typename Receiver>
+    using OperationType = EpollContext::SocketRecvExactlyOperation<Receiver, Protocol, Buffers>;
+    using SocketType = typename Protocol::Socket;
+
+    SocketRecvExactlySender(SocketType& socket, Buffers buffers) noexcept
+        : socket_(socket), buffers_(buffers) {}
+
+    using is_sender = void;
+    using completion_sigs = stdexec::completion_signatures<stdexec::set_value_t(size_t),
+                                                           stdexec::set_error_t(std::error_code),
+                                                           stdexec::set_stopped_t()>;
+
+    template <typename Env>
+    friend completion_sigs tag_invoke(stdexec::get_completion_signatures_t,
+                                      const SocketRecvExactlySender&, Env) noexcept {
+        return {};
+    }
+
+    friend stdexec::empty_env tag_invoke(stdexec::get_env_t,
+                                         const SocketRecvExactlySender& sender) noexcept {
+        return {};
+    }
+
+    template <stdexec::__decays_to<SocketRecvExactlySender> Sender,
+              stdexec::receiver_of<completion_sigs> Receiver>
+    friend OperationType<std::remove_cvref_t<Receiver>> tag_invoke(stdexec::connect_t,
+                                                                   Sender&& sender,
+                                                                   Receiver receiver) noexcept {
+        return {std::move(receiver), sender.socket_, sender.buffers_};
+    }
+
+private:
+    SocketType& socket_;
+    Buffers buffers_;
+};
+
+namespace cpo {
+
+// Completes with the total number of bytes received once all of `buffers` (up to
+// BufferSequenceAdapterBase::MaxBuffers of them) has been filled.
+struct AsyncRecvExactly {
+    template <typename Protocol, MutableBufferSequence Buffers>
+    constexpr auto operator()(net::Socket<Protocol>& socket, Buffers buffers) const noexcept
+        -> SocketRecvExactlySender<Protocol, Buffers> {
+        return {socket, buffers};
+    }
+
+    // Sockets of other contexts (e.g. IoUringContext) customize the operation with tag_invoke.
+    template <typename Protocol, typename Context, MutableBufferSequence Buffers>
+    requires stdexec::tag_invocable<AsyncRecvExactly, net::Socket<Protocol, Context>&, Buffers>
+    constexpr auto operator()(net::Socket<Protocol, Context>& socket,
+                              Buffers buffers) const noexcept
+        -> stdexec::tag_invoke_result_t<AsyncRecvExactly, net::Socket<Protocol, Context>&,
+                                        Buffers> {
+        return stdexec::tag_invoke(*this, socket, buffers);
+    }
+};
+
+}  // namespace cpo
+
+inline constexpr cpo::AsyncRecvExactly AsyncRecvExactly;
+
+}  // namespace fuchsia
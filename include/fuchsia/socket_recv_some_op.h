@@ -107,6 +107,15 @@ struct AsyncRecvSome {
         -> SocketRecvSomeSender<Protocol, Buffers> {
         return {socket, buffers};
     }
+
+    // Sockets of other contexts (e.g. IoUringContext) customize the operation with tag_invoke.
+    template <typename Protocol, typename Context, MutableBufferSequence Buffers>
+    requires stdexec::tag_invocable<AsyncRecvSome, net::Socket<Protocol, Context>&, Buffers>
+    constexpr auto operator()(net::Socket<Protocol, Context>& socket,
+                              Buffers buffers) const noexcept
+        -> stdexec::tag_invoke_result_t<AsyncRecvSome, net::Socket<Protocol, Context>&, Buffers> {
+        return stdexec::tag_invoke(*this, socket, buffers);
+    }
 };
 
 }  // namespace cpo
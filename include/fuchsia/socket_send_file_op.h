@@ -0,0 +1,139 @@
+//
+// Created by wenjuxu on 2023/9/2.
+//
+
+#pragma once
+
+#include <sys/types.h>
+
+#include "fuchsia/epoll_context.h"
+#include "fuchsia/net/socket.h"
+#include "fuchsia/socket_op_base.h"
+
+namespace fuchsia {
+
+// Sends a range of a file with sendfile(), the data going from the page cache to the socket without
+// passing through user space. Partial writes are continued from the readiness event, same as
+// SocketSendAllOperation; a file that turns out shorter than the range fails with
+// std::errc::io_error.
+template <typename Receiver, typename Protocol>
+class EpollContext::SocketSendFileOperation : public SocketOperationBase<Receiver, Protocol> {
+public:
+    using SocketType = typename Protocol::Socket;
+    using BaseType = SocketOperationBase<Receiver, Protocol>;
+
+    SocketSendFileOperation(Receiver receiver, SocketType& socket, int fd, ::off_t offset,
+                            size_t count)
+        : BaseType(std::move(receiver), socket, vtable_, BaseType::OperationType::Write),
+          fd_(fd),
+          offset_(offset),
+          remaining_(count),
+          bytes_transferred_(0) {}
+
+private:
+    static void Start(BaseType* base) noexcept {
+        auto self = static_cast<SocketSendFileOperation*>(base);
+        while (self->remaining_ > 0) {
+            auto res =
+                self->socket_.SendFile(self->fd_, self->offset_, self->remaining_, base->ec_);
+            if (!res.has_value()) {
+                return;
+            }
+            if (res.value() == 0) {  // end of file
+                base->ec_ = std::make_error_code(std::errc::io_error);
+                return;
+            }
+            self->bytes_transferred_ += res.value();
+            self->remaining_ -= res.value();
+        }
+    }
+
+    static void Complete(BaseType* base) noexcept {
+        if (base->ec_ == std::errc::operation_canceled) {
+            stdexec::set_stopped(std::move(base->receiver_));
+        } else if (base->ec_) {
+            stdexec::set_error(std::move(base->receiver_), base->ec_);
+        } else {
+            auto self = static_cast<SocketSendFileOperation*>(base);
+            stdexec::set_value(std::move(base->receiver_), self->bytes_transferred_);
+        }
+    }
+
+    static constexpr typename BaseType::Vtable vtable_{&Start, &Complete};
+
+    int fd_;
+    ::off_t offset_;
+    size_t remaining_;
+    size_t bytes_transferred_;
+};
+
+template <typename Protocol>
+class SocketSendFileSender {
+public:
+    template <typename Receiver>
+    using OperationType = EpollContext::SocketSendFileOperation<Receiver, Protocol>;
+    using SocketType = typename Protocol::Socket;
+
+    SocketSendFileSender(SocketType& socket, int fd, ::off_t offset, size_t count) noexcept
+        : socket_(socket), fd_(fd), offset_(offset), count_(count) {}
+
+    using is_sender = void;
+    using completion_sigs = stdexec::completion_signatures<stdexec::set_value_t(size_t),
+                                                           stdexec::set_error_t(std::error_code),
+                                                           stdexec::set_stopped_t()>;
+
+    template <typename Env>
+    friend completion_sigs tag_invoke(stdexec::get_completion_signatures_t,
+                                      const SocketSendFileSender&, Env) noexcept {
+        return {};
+    }
+
+    friend stdexec::empty_env tag_invoke(stdexec::get_env_t,
+                                         const SocketSendFileSender& sender) noexcept {
+        return {};
+    }
+
+    template <stdexec::__decays_to<SocketSendFileSender> Sender,
+              stdexec::receiver_of<completion_sigs> Receiver>
+    friend OperationType<std::remove_cvref_t<Receiver>> tag_invoke(stdexec::connect_t,
+                                                                   Sender&& sender,
+                                                                   Receiver receiver) noexcept {
+        return {std::move(receiver), sender.socket_, sender.fd_, sender.offset_, sender.count_};
+    }
+
+private:
+    SocketType& socket_;
+    int fd_;
+    ::off_t offset_;
+    size_t count_;
+};
+
+namespace cpo {
+
+// Completes with the number of bytes sent once `count` bytes of the file `fd`, starting at
+// `offset`, have been sent. The file offset of `fd` is left alone, so one fd can be sent by any
+// number of operations at once.
+struct AsyncSendFile {
+    template <typename Protocol>
+    constexpr auto operator()(net::Socket<Protocol>& socket, int fd, ::off_t offset,
+                              size_t count) const noexcept -> SocketSendFileSender<Protocol> {
+        return {socket, fd, offset, count};
+    }
+
+    // Sockets of other contexts (e.g. IoUringContext) customize the operation with tag_invoke.
+    template <typename Protocol, typename Context>
+    requires stdexec::tag_invocable<AsyncSendFile, net::Socket<Protocol, Context>&, int, ::off_t,
+                                    size_t>
+    constexpr auto operator()(net::Socket<Protocol, Context>& socket, int fd, ::off_t offset,
+                              size_t count) const noexcept
+        -> stdexec::tag_invoke_result_t<AsyncSendFile, net::Socket<Protocol, Context>&, int,
+                                        ::off_t, size_t> {
+        return stdexec::tag_invoke(*this, socket, fd, offset, count);
+    }
+};
+
+}  // namespace cpo
+
+inline constexpr cpo::AsyncSendFile AsyncSendFile;
+
+}  // namespace fuchsia
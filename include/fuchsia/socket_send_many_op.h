@@ -0,0 +1,156 @@
+//
+// Created by wenjuxu on 2023/8/30.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <type_traits>
+
+#include "fuchsia/buffer.h"
+#include "fuchsia/epoll_context.h"
+#include "fuchsia/net/datagram.h"
+#include "fuchsia/net/socket.h"
+#include "fuchsia/socket_op_base.h"
+
+namespace fuchsia {
+
+// Sends a batch of datagrams with one sendmmsg(). The message headers and their control buffers
+// live in the operation state, nothing is allocated.
+template <typename Receiver, typename Protocol>
+class EpollContext::SocketSendManyOperation : public SocketOperationBase<Receiver, Protocol> {
+public:
+    using DatagramType = net::Datagram<Protocol, ConstBuffer>;
+    using SocketType = typename Protocol::Socket;
+    using BaseType = SocketOperationBase<Receiver, Protocol>;
+
+    SocketSendManyOperation(Receiver receiver, SocketType& socket,
+                            std::span<DatagramType> datagrams)
+        : BaseType(std::move(receiver), socket, vtable_, BaseType::OperationType::Write),
+          datagrams_(datagrams.first(std::min(datagrams.size(), net::kMaxDatagramBatch))),
+          count_(0) {}
+
+private:
+    static void Start(BaseType* base) noexcept {
+        auto self = static_cast<SocketSendManyOperation*>(base);
+        auto& datagrams = self->datagrams_;
+        for (size_t i = 0; i < datagrams.size(); ++i) {
+            self->iovecs_[i] = {const_cast<void*>(datagrams[i].buffer.Data()),
+                                datagrams[i].buffer.Size()};
+            self->msgs_[i] = {};
+            self->msgs_[i].msg_hdr.msg_name = datagrams[i].endpoint.Data();
+            self->msgs_[i].msg_hdr.msg_namelen = datagrams[i].endpoint.Size();
+            self->msgs_[i].msg_hdr.msg_iov = &self->iovecs_[i];
+            self->msgs_[i].msg_hdr.msg_iovlen = 1;
+            if (datagrams[i].segment_size != 0) {
+                net::SetSegmentSize(self->msgs_[i].msg_hdr, self->controls_[i],
+                                    datagrams[i].segment_size);
+            }
+        }
+        auto res = self->socket_.SendMMsg(self->msgs_.data(),
+                                          static_cast<unsigned int>(datagrams.size()), base->ec_);
+        if (!res.has_value()) {
+            return;
+        }
+        self->count_ = res.value();
+        for (size_t i = 0; i < self->count_; ++i) {
+            datagrams[i].size = self->msgs_[i].msg_len;
+        }
+    }
+
+    static void Complete(BaseType* base) noexcept {
+        if (base->ec_ == std::errc::operation_canceled) {
+            stdexec::set_stopped(std::move(base->receiver_));
+        } else if (base->ec_) {
+            stdexec::set_error(std::move(base->receiver_), base->ec_);
+        } else {
+            auto self = static_cast<SocketSendManyOperation*>(base);
+            stdexec::set_value(std::move(base->receiver_), self->count_);
+        }
+    }
+
+    static constexpr typename BaseType::Vtable vtable_{&Start, &Complete};
+
+    std::span<DatagramType> datagrams_;
+    std::array<::mmsghdr, net::kMaxDatagramBatch> msgs_;
+    std::array<::iovec, net::kMaxDatagramBatch> iovecs_;
+    std::array<net::SegmentControl, net::kMaxDatagramBatch> controls_;  // for UDP_SEGMENT
+    size_t count_;
+};
+
+template <typename Protocol>
+class SocketSendManySender {
+public:
+    template <typename Receiver>
+    using OperationType = EpollContext::SocketSendManyOperation<Receiver, Protocol>;
+    using DatagramType = net::Datagram<Protocol, ConstBuffer>;
+    using SocketType = typename Protocol::Socket;
+
+    SocketSendManySender(SocketType& socket, std::span<DatagramType> datagrams) noexcept
+        : socket_(socket), datagrams_(datagrams) {}
+
+    using is_sender = void;
+    using completion_sigs = stdexec::completion_signatures<stdexec::set_value_t(size_t),
+                                                           stdexec::set_error_t(std::error_code),
+                                                           stdexec::set_stopped_t()>;
+
+    template <typename Env>
+    friend completion_sigs tag_invoke(stdexec::get_completion_signatures_t,
+                                      const SocketSendManySender&, Env) noexcept {
+        return {};
+    }
+
+    friend stdexec::empty_env tag_invoke(stdexec::get_env_t,
+                                         const SocketSendManySender& sender) noexcept {
+        return {};
+    }
+
+    template <stdexec::__decays_to<SocketSendManySender> Sender,
+              stdexec::receiver_of<completion_sigs> Receiver>
+    friend OperationType<std::remove_cvref_t<Receiver>> tag_invoke(stdexec::connect_t,
+                                                                   Sender&& sender,
+                                                                   Receiver receiver) noexcept {
+        return {std::move(receiver), sender.socket_, sender.datagrams_};
+    }
+
+private:
+    SocketType& socket_;
+    std::span<DatagramType> datagrams_;
+};
+
+namespace cpo {
+
+// Send the buffers of `datagrams` (up to net::kMaxDatagramBatch of them) to their endpoints,
+// waiting until at least one can be sent. Completes with how many were sent, the first ones of
+// `datagrams` then have their size filled in with the bytes sent.
+struct AsyncSendMany {
+    // Anything convertible to a span, e.g. a std::array or std::vector of datagrams.
+    template <typename Protocol>
+    using Datagrams = std::type_identity_t<std::span<net::Datagram<Protocol, ConstBuffer>>>;
+
+    template <typename Protocol>
+    constexpr auto operator()(net::Socket<Protocol>& socket,
+                              Datagrams<Protocol> datagrams) const noexcept
+        -> SocketSendManySender<Protocol> {
+        return {socket, datagrams};
+    }
+
+    // Sockets of other contexts (e.g. IoUringContext) customize the operation with tag_invoke.
+    template <typename Protocol, typename Context>
+    requires stdexec::tag_invocable<AsyncSendMany, net::Socket<Protocol, Context>&,
+                                    Datagrams<Protocol>>
+    constexpr auto operator()(net::Socket<Protocol, Context>& socket,
+                              Datagrams<Protocol> datagrams) const noexcept
+        -> stdexec::tag_invoke_result_t<AsyncSendMany, net::Socket<Protocol, Context>&,
+                                        Datagrams<Protocol>> {
+        return stdexec::tag_invoke(*this, socket, datagrams);
+    }
+};
+
+}  // namespace cpo
+
+inline constexpr cpo::AsyncSendMany AsyncSendMany;
+
+}  // namespace fuchsia
@@ -0,0 +1,126 @@
+//
+// Created by wenjuxu on 2023/8/30.
+//
+
+#pragma once
+
+#include "fuchsia/buffer.h"
+#include "fuchsia/epoll_context.h"
+#include "fuchsia/net/socket.h"
+#include "fuchsia/socket_op_base.h"
+
+namespace fuchsia {
+
+template <typename Receiver, typename Protocol>
+class EpollContext::SocketSendToOperation : public SocketOperationBase<Receiver, Protocol> {
+public:
+    using EndpointType = typename Protocol::Endpoint;
+    using SocketType = typename Protocol::Socket;
+    using BaseType = SocketOperationBase<Receiver, Protocol>;
+
+    SocketSendToOperation(Receiver receiver, SocketType& socket, ConstBuffer buffer,
+                          const EndpointType& endpoint)
+        : BaseType(std::move(receiver), socket, vtable_, BaseType::OperationType::Write),
+          buffer_(buffer),
+          endpoint_(endpoint),
+          bytes_transferred_(0) {}
+
+private:
+    static void Start(BaseType* base) noexcept {
+        auto self = static_cast<SocketSendToOperation*>(base);
+        auto res = self->socket_.SendTo(self->buffer_.Data(), self->buffer_.Size(),
+                                        self->endpoint_, base->ec_);
+        if (!res.has_value()) {
+            return;
+        }
+        self->bytes_transferred_ = res.value();
+    }
+
+    static void Complete(BaseType* base) noexcept {
+        if (base->ec_ == std::errc::operation_canceled) {
+            stdexec::set_stopped(std::move(base->receiver_));
+        } else if (base->ec_) {
+            stdexec::set_error(std::move(base->receiver_), base->ec_);
+        } else {
+            auto self = static_cast<SocketSendToOperation*>(base);
+            stdexec::set_value(std::move(base->receiver_), self->bytes_transferred_);
+        }
+    }
+
+    static constexpr typename BaseType::Vtable vtable_{&Start, &Complete};
+
+    ConstBuffer buffer_;
+    EndpointType endpoint_;
+    size_t bytes_transferred_;
+};
+
+template <typename Protocol>
+class SocketSendToSender {
+public:
+    template <typename Receiver>
+    using OperationType = EpollContext::SocketSendToOperation<Receiver, Protocol>;
+    using EndpointType = typename Protocol::Endpoint;
+    using SocketType = typename Protocol::Socket;
+
+    SocketSendToSender(SocketType& socket, ConstBuffer buffer,
+                       const EndpointType& endpoint) noexcept
+        : socket_(socket), buffer_(buffer), endpoint_(endpoint) {}
+
+    using is_sender = void;
+    using completion_sigs = stdexec::completion_signatures<stdexec::set_value_t(size_t),
+                                                           stdexec::set_error_t(std::error_code),
+                                                           stdexec::set_stopped_t()>;
+
+    template <typename Env>
+    friend completion_sigs tag_invoke(stdexec::get_completion_signatures_t,
+                                      const SocketSendToSender&, Env) noexcept {
+        return {};
+    }
+
+    friend stdexec::empty_env tag_invoke(stdexec::get_env_t,
+                                         const SocketSendToSender& sender) noexcept {
+        return {};
+    }
+
+    template <stdexec::__decays_to<SocketSendToSender> Sender,
+              stdexec::receiver_of<completion_sigs> Receiver>
+    friend OperationType<std::remove_cvref_t<Receiver>> tag_invoke(stdexec::connect_t,
+                                                                   Sender&& sender,
+                                                                   Receiver receiver) noexcept {
+        return {std::move(receiver), sender.socket_, sender.buffer_, sender.endpoint_};
+    }
+
+private:
+    SocketType& socket_;
+    ConstBuffer buffer_;
+    EndpointType endpoint_;
+};
+
+namespace cpo {
+
+// Send `buffer` as one datagram to `endpoint`, completes with the number of bytes sent.
+struct AsyncSendTo {
+    template <typename Protocol>
+    constexpr auto operator()(net::Socket<Protocol>& socket, ConstBuffer buffer,
+                              const typename Protocol::Endpoint& endpoint) const noexcept
+        -> SocketSendToSender<Protocol> {
+        return {socket, buffer, endpoint};
+    }
+
+    // Sockets of other contexts (e.g. IoUringContext) customize the operation with tag_invoke.
+    template <typename Protocol, typename Context>
+    requires stdexec::tag_invocable<AsyncSendTo, net::Socket<Protocol, Context>&, ConstBuffer,
+                                    const typename Protocol::Endpoint&>
+    constexpr auto operator()(net::Socket<Protocol, Context>& socket, ConstBuffer buffer,
+                              const typename Protocol::Endpoint& endpoint) const noexcept
+        -> stdexec::tag_invoke_result_t<AsyncSendTo, net::Socket<Protocol, Context>&, ConstBuffer,
+                                        const typename Protocol::Endpoint&> {
+        return stdexec::tag_invoke(*this, socket, buffer, endpoint);
+    }
+};
+
+}  // namespace cpo
+
+inline constexpr cpo::AsyncSendTo AsyncSendTo;
+
+}  // namespace fuchsia
@@ -0,0 +1,164 @@
+//
+// Created by wenjuxu on 2023/9/1.
+//
+
+#pragma once
+
+#include <cstdint>
+
+#include "fuchsia/buffer_sequence_adapter.h"
+#include "fuchsia/epoll_context.h"
+#include "fuchsia/net/socket.h"
+#include "fuchsia/socket_op_base.h"
+
+namespace fuchsia {
+
+// Sends the whole buffer sequence with MSG_ZEROCOPY: the kernel pins the pages of the buffers
+// instead of copying them, and tells on the error queue of the socket when it is done with them.
+// The operation goes through two stages, the sends, waiting for writability like
+// SocketSendAllOperation, then the completion notifications, waiting for EPOLLERR.
+//
+// The sends are matched with the notifications by the numbers the kernel gives them, so that
+// notifications of other sends of the socket, e.g. of an earlier operation that was stopped, do not
+// count. Still only one zero-copy send may be pending on a socket at a time: the notifications are
+// taken from the error queue of the socket by whichever operation waits for them.
+template <typename Receiver, typename Protocol, typename Buffers>
+class EpollContext::SocketSendZeroCopyOperation : public SocketOperationBase<Receiver, Protocol> {
+public:
+    using SocketType = typename Protocol::Socket;
+    using BaseType = SocketOperationBase<Receiver, Protocol>;
+    using BuffersType = BufferSequenceAdapter<ConstBuffer, Buffers>;
+
+    SocketSendZeroCopyOperation(Receiver receiver, SocketType& socket, Buffers buffers)
+        : BaseType(std::move(receiver), socket, vtable_, BaseType::OperationType::Write),
+          buffers_(buffers) {}
+
+private:
+    static void Start(BaseType* base) noexcept {
+        auto self = static_cast<SocketSendZeroCopyOperation*>(base);
+        if (!self->enabled_) {
+            if (!self->socket_.SetZeroCopy(true, base->ec_)) {
+                return;
+            }
+            self->enabled_ = true;
+        }
+
+        if (self->sends_ == 0) {
+            self->first_ = self->socket_.ZeroCopySequence();
+        }
+        while (!self->buffers_.AllEmpty()) {
+            auto res = self->socket_.SendMsg(self->buffers_.Buffers(), self->buffers_.Count(),
+                                             base->ec_, MSG_ZEROCOPY);
+            if (!res.has_value()) {
+                return;
+            }
+            self->bytes_transferred_ += res.value();
+            self->buffers_.Advance(res.value());
+            self->sends_ = self->socket_.ZeroCopySequence() - self->first_;
+        }
+
+        // Everything has been handed over, wait until the kernel lets go of the buffers.
+        base->op_type_ = BaseType::OperationType::Error;
+        while (self->completions_ < self->sends_) {
+            auto res = self->socket_.RecvZeroCopyCompletions(self->first_, self->sends_,
+                                                             self->copied_, base->ec_);
+            if (!res.has_value()) {
+                return;
+            }
+            self->completions_ += res.value();
+        }
+    }
+
+    static void Complete(BaseType* base) noexcept {
+        if (base->ec_ == std::errc::operation_canceled) {
+            stdexec::set_stopped(std::move(base->receiver_));
+        } else if (base->ec_) {
+            stdexec::set_error(std::move(base->receiver_), base->ec_);
+        } else {
+            auto self = static_cast<SocketSendZeroCopyOperation*>(base);
+            stdexec::set_value(std::move(base->receiver_), self->bytes_transferred_);
+        }
+    }
+
+    static constexpr typename BaseType::Vtable vtable_{&Start, &Complete};
+
+    BuffersType buffers_;
+    size_t bytes_transferred_ = 0;
+    uint32_t first_ = 0;  // the sequence number of the first send
+    uint32_t sends_ = 0;
+    uint32_t completions_ = 0;  // of [first_, first_ + sends_)
+    bool enabled_ = false;
+    bool copied_ = false;  // the kernel fell back to copying, e.g. over loopback
+};
+
+template <typename Protocol, typename Buffers>
+class SocketSendZeroCopySender {
+public:
+    template <typename Receiver>
+    using OperationType = EpollContext::SocketSendZeroCopyOperation<Receiver, Protocol, Buffers>;
+    using SocketType = typename Protocol::Socket;
+
+    SocketSendZeroCopySender(SocketType& socket, Buffers buffers) noexcept
+        : socket_(socket), buffers_(buffers) {}
+
+    using is_sender = void;
+    using completion_sigs = stdexec::completion_signatures<stdexec::set_value_t(size_t),
+                                                           stdexec::set_error_t(std::error_code),
+                                                           stdexec::set_stopped_t()>;
+
+    template <typename Env>
+    friend completion_sigs tag_invoke(stdexec::get_completion_signatures_t,
+                                      const SocketSendZeroCopySender&, Env) noexcept {
+        return {};
+    }
+
+    friend stdexec::empty_env tag_invoke(stdexec::get_env_t,
+                                         const SocketSendZeroCopySender& sender) noexcept {
+        return {};
+    }
+
+    template <stdexec::__decays_to<SocketSendZeroCopySender> Sender,
+              stdexec::receiver_of<completion_sigs> Receiver>
+    friend OperationType<std::remove_cvref_t<Receiver>> tag_invoke(stdexec::connect_t,
+                                                                   Sender&& sender,
+                                                                   Receiver receiver) noexcept {
+        return {std::move(receiver), sender.socket_, sender.buffers_};
+    }
+
+private:
+    SocketType& socket_;
+    Buffers buffers_;
+};
+
+namespace cpo {
+
+// Completes with the total number of bytes sent once all of `buffers` (up to
+// BufferSequenceAdapterBase::MaxBuffers of them) has been sent and the kernel no longer uses them,
+// so that they may be released or modified. Worth it for large payloads only, the notifications
+// cost more than copying a few kilobytes.
+//
+// If the operation fails or is stopped after some of the data was sent, the kernel may still read
+// the buffers for a while.
+struct AsyncSendZeroCopy {
+    template <typename Protocol, ConstBufferSequence Buffers>
+    constexpr auto operator()(net::Socket<Protocol>& socket, Buffers buffers) const noexcept
+        -> SocketSendZeroCopySender<Protocol, Buffers> {
+        return {socket, buffers};
+    }
+
+    // Sockets of other contexts (e.g. IoUringContext) customize the operation with tag_invoke.
+    template <typename Protocol, typename Context, ConstBufferSequence Buffers>
+    requires stdexec::tag_invocable<AsyncSendZeroCopy, net::Socket<Protocol, Context>&, Buffers>
+    constexpr auto operator()(net::Socket<Protocol, Context>& socket,
+                              Buffers buffers) const noexcept
+        -> stdexec::tag_invoke_result_t<AsyncSendZeroCopy, net::Socket<Protocol, Context>&,
+                                        Buffers> {
+        return stdexec::tag_invoke(*this, socket, buffers);
+    }
+};
+
+}  // namespace cpo
+
+inline constexpr cpo::AsyncSendZeroCopy AsyncSendZeroCopy;
+
+}  // namespace fuchsia
@@ -0,0 +1,245 @@
+//
+// Created by wenjuxu on 2023/8/16.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "fuchsia/intrusive_queue.h"
+
+namespace fuchsia {
+
+// The bucket of a node that is in no TimingWheel, nodes start out with it.
+inline constexpr uint32_t kNoTimingWheelBucket = ~uint32_t{0};
+
+template <typename T>
+concept TimingWheelNode = IntrusiveQueueNode<T> && requires(T t) {
+    { t.prev } -> std::same_as<T*&>;
+    { t.bucket } -> std::same_as<uint32_t&>;
+    t.expiration.time_since_epoch();
+};
+
+// A hierarchical timing wheel with a resolution of 1ms: 6 levels of 64 slots each, level n slot
+// spans 64^n ticks, which covers about 2 years ahead. Insertion and removal are O(1), a timer is
+// moved down at most once per level before it expires.
+//
+// Timers never expire early, but may expire up to one tick late, and timers expiring within the
+// same tick are popped in insertion order.
+template <TimingWheelNode T>
+class TimingWheel {
+public:
+    using TimePoint = std::remove_cvref_t<decltype(std::declval<T>().expiration)>;
+    using Tick = std::chrono::milliseconds;
+
+    TimingWheel() noexcept : TimingWheel(TimePoint::clock::now()) {}
+
+    explicit TimingWheel(TimePoint start) noexcept : start_(start) {}
+
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+
+    ~TimingWheel() { assert(Empty()); }
+
+    bool Empty() const noexcept { return size_ == 0; }
+
+    size_t Size() const noexcept { return size_; }
+
+    void Push(T* item) noexcept {
+        Insert(item, TickOf(item->expiration));
+        ++size_;
+    }
+
+    // `item` must be in the wheel, that is pushed and not popped yet.
+    void Remove(T* item) noexcept {
+        assert(item->bucket != kNoBucket);
+        Unlink(item);
+        --size_;
+    }
+
+    // A lower bound of the earliest expiration, it is exact for timers within 64 ticks from the
+    // last `PopExpired()`, otherwise the start of the slot holding the earliest timer.
+    std::optional<TimePoint> NextExpiration() const noexcept {
+        if (Empty()) {
+            return std::nullopt;
+        }
+        if (buckets_[kPendingBucket].head != nullptr) {
+            return TimeOf(elapsed_);
+        }
+        return TimeOf(NextOccupiedDeadline().second);
+    }
+
+    // Advance the wheel to `now`, remove and return all timers that have expired by then.
+    IntrusiveQueue<T> PopExpired(TimePoint now) noexcept {
+        IntrusiveQueue<T> expired;
+        TakeAll(kPendingBucket, expired);
+
+        uint64_t now_tick = std::max(FloorTickOf(now), elapsed_);
+        while (true) {
+            auto [level, deadline] = NextOccupiedDeadline();
+            if (level == kNumLevels || deadline > now_tick) {
+                break;
+            }
+            // Every slot before this one is empty, so it is safe to jump straight to its start.
+            elapsed_ = deadline;
+            uint32_t slot = SlotOf(deadline, level);
+            T* item = std::exchange(buckets_[BucketOf(level, slot)].head, nullptr);
+            buckets_[BucketOf(level, slot)].tail = nullptr;
+            occupied_[level] &= ~(uint64_t{1} << slot);
+            while (item != nullptr) {
+                T* next = item->next;
+                uint64_t tick = TickOf(item->expiration);
+                if (tick <= elapsed_) {
+                    item->bucket = kNoBucket;
+                    expired.PushBack(item);
+                    --size_;
+                } else {
+                    Insert(item, tick);  // moves to a lower level
+                }
+                item = next;
+            }
+        }
+        elapsed_ = now_tick;
+        return expired;
+    }
+
+private:
+    static constexpr uint32_t kSlotBits = 6;
+    static constexpr uint32_t kNumSlots = 1 << kSlotBits;
+    static constexpr uint32_t kNumLevels = 6;
+    static constexpr uint64_t kMaxTicks = uint64_t{1} << (kSlotBits * kNumLevels);
+    static constexpr uint32_t kPendingBucket = kNumLevels * kNumSlots;  // expired when pushed
+    static constexpr uint32_t kNoBucket = kNoTimingWheelBucket;
+
+    struct Bucket {
+        T* head = nullptr;
+        T* tail = nullptr;
+    };
+
+    static constexpr uint32_t BucketOf(uint32_t level, uint32_t slot) noexcept {
+        return level * kNumSlots + slot;
+    }
+
+    static constexpr uint32_t SlotOf(uint64_t tick, uint32_t level) noexcept {
+        return (tick >> (level * kSlotBits)) & (kNumSlots - 1);
+    }
+
+    // Round up, so that a timer never expires before its expiration.
+    uint64_t TickOf(TimePoint expiration) const noexcept {
+        if (expiration <= start_) {
+            return 0;
+        }
+        auto ticks = std::chrono::ceil<Tick>(expiration - start_).count();
+        return static_cast<uint64_t>(ticks);
+    }
+
+    uint64_t FloorTickOf(TimePoint now) const noexcept {
+        if (now <= start_) {
+            return 0;
+        }
+        return static_cast<uint64_t>(std::chrono::floor<Tick>(now - start_).count());
+    }
+
+    TimePoint TimeOf(uint64_t tick) const noexcept {
+        return start_ + Tick{static_cast<typename Tick::rep>(tick)};
+    }
+
+    void Insert(T* item, uint64_t tick) noexcept {
+        uint32_t bucket;
+        if (tick <= elapsed_) {
+            bucket = kPendingBucket;
+        } else {
+            tick = std::min(tick, elapsed_ + kMaxTicks - 1);
+            // The level is given by the highest bit in which the tick differs from now, so that
+            // the timer is in a slot strictly after the current one at that level.
+            uint64_t masked = (tick ^ elapsed_) | (kNumSlots - 1);
+            uint32_t level = (63 - std::countl_zero(masked)) / kSlotBits;
+            level = std::min(level, kNumLevels - 1);
+            uint32_t slot = SlotOf(tick, level);
+            occupied_[level] |= uint64_t{1} << slot;
+            bucket = BucketOf(level, slot);
+        }
+
+        auto& b = buckets_[bucket];
+        item->bucket = bucket;
+        item->prev = b.tail;
+        item->next = nullptr;
+        if (b.tail == nullptr) {
+            b.head = item;
+        } else {
+            b.tail->next = item;
+        }
+        b.tail = item;
+    }
+
+    void Unlink(T* item) noexcept {
+        auto& b = buckets_[item->bucket];
+        if (item->prev == nullptr) {
+            b.head = item->next;
+        } else {
+            item->prev->next = item->next;
+        }
+        if (item->next == nullptr) {
+            b.tail = item->prev;
+        } else {
+            item->next->prev = item->prev;
+        }
+        if (b.head == nullptr && item->bucket != kPendingBucket) {
+            occupied_[item->bucket / kNumSlots] &= ~(uint64_t{1} << (item->bucket % kNumSlots));
+        }
+        item->bucket = kNoBucket;
+    }
+
+    void TakeAll(uint32_t bucket, IntrusiveQueue<T>& out) noexcept {
+        T* item = std::exchange(buckets_[bucket].head, nullptr);
+        buckets_[bucket].tail = nullptr;
+        while (item != nullptr) {
+            T* next = item->next;
+            item->bucket = kNoBucket;
+            out.PushBack(item);
+            --size_;
+            item = next;
+        }
+    }
+
+    // The start tick of the first occupied slot of `level` after now, the level must not be empty.
+    uint64_t NextDeadline(uint32_t level) const noexcept {
+        uint64_t slot_range = uint64_t{1} << (level * kSlotBits);
+        uint64_t level_range = slot_range << kSlotBits;
+        uint32_t now_slot = SlotOf(elapsed_, level);
+        uint32_t slot = (std::countr_zero(std::rotr(occupied_[level], now_slot)) + now_slot) %
+                        kNumSlots;
+        uint64_t deadline = (elapsed_ & ~(level_range - 1)) + slot * slot_range;
+        if (deadline <= elapsed_) {
+            // Only possible on the top level, which wraps around.
+            deadline += level_range;
+        }
+        return deadline;
+    }
+
+    // The lowest occupied level holds the earliest timers, returns kNumLevels if all are empty.
+    std::pair<uint32_t, uint64_t> NextOccupiedDeadline() const noexcept {
+        for (uint32_t level = 0; level < kNumLevels; ++level) {
+            if (occupied_[level] != 0) {
+                return {level, NextDeadline(level)};
+            }
+        }
+        return {kNumLevels, 0};
+    }
+
+    TimePoint start_;
+    uint64_t elapsed_ = 0;  // ticks since start_, everything up to it has been popped
+    size_t size_ = 0;
+    std::array<uint64_t, kNumLevels> occupied_{};
+    std::array<Bucket, kNumLevels * kNumSlots + 1> buckets_{};
+};
+
+}  // namespace fuchsia
@@ -0,0 +1,41 @@
+//
+// Created by wenjuxu on 2023/8/27.
+//
+
+#pragma once
+
+#include <chrono>
+#include <system_error>
+
+#include "exec/timed_scheduler.hpp"
+#include "exec/when_any.hpp"
+#include "stdexec/execution.hpp"
+
+namespace fuchsia {
+
+// Turns the completion of a timer into an error.
+inline constexpr auto TimedOut = [] {
+    return stdexec::just_error(std::make_error_code(std::errc::timed_out));
+};
+
+// Complete as `sender` does, unless `deadline` passes on `scheduler` first: then `sender` is
+// stopped (socket operations cancel through their stop callback) and the result is an error of
+// std::errc::timed_out, which a task throws as std::system_error. Both race within the operation
+// state, nothing is allocated.
+//
+//     auto n = co_await fuchsia::WithTimeout(context.GetScheduler(),
+//                                            fuchsia::AsyncRecvSome(socket, buffer), 5s);
+template <typename Scheduler, stdexec::sender Sender, typename TimePoint>
+auto WithDeadline(Scheduler scheduler, Sender&& sender, TimePoint deadline) {
+    return exec::when_any(std::forward<Sender>(sender),
+                          exec::schedule_at(scheduler, deadline) | stdexec::let_value(TimedOut));
+}
+
+// Same as WithDeadline(), with the deadline `timeout` after the start of the operation.
+template <typename Scheduler, stdexec::sender Sender, typename Rep, typename Period>
+auto WithTimeout(Scheduler scheduler, Sender&& sender, std::chrono::duration<Rep, Period> timeout) {
+    return exec::when_any(std::forward<Sender>(sender),
+                          exec::schedule_after(scheduler, timeout) | stdexec::let_value(TimedOut));
+}
+
+}  // namespace fuchsia
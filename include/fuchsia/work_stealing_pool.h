@@ -0,0 +1,177 @@
+//
+// Created by wenjuxu on 2023/8/19.
+//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "fuchsia/atomic_intrusive_queue.h"
+#include "fuchsia/chase_lev_deque.h"
+#include "fuchsia/operation_base.h"
+#include "stdexec/execution.hpp"
+
+namespace fuchsia {
+
+// A pool of worker threads for CPU-bound work, so that it does not stall the io threads. Each
+// worker owns a Chase-Lev deque: work scheduled from a worker goes to its own deque, work
+// scheduled from anywhere else goes to a shared injection queue, and idle workers steal from the
+// others before going to sleep.
+//
+// Use Offload() from a coroutine to run a function on the pool and come back to the reactor
+// afterwards.
+class WorkStealingPool {
+public:
+    // Workers are started right away.
+    explicit WorkStealingPool(size_t num_workers = std::thread::hardware_concurrency());
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    ~WorkStealingPool();
+
+    class Scheduler;
+    Scheduler GetScheduler() noexcept;
+
+    size_t Size() const noexcept { return workers_.size(); }
+
+    // Let the workers finish all work scheduled so far, then join them. Must not be called from a
+    // worker.
+    void Stop() noexcept;
+
+private:
+    struct Worker {
+        explicit Worker(WorkStealingPool& pool) : pool(pool), deque(kDequeCapacity) {}
+
+        WorkStealingPool& pool;
+        ChaseLevDeque<OperationBase> deque;
+        std::jthread thread;
+    };
+
+    static constexpr size_t kDequeCapacity = 1024;
+
+    void Schedule(OperationBase* op) noexcept;
+    void Run(Worker& worker) noexcept;
+    OperationBase* FindWork(Worker& worker) noexcept;
+    void Notify() noexcept;
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    AtomicIntrusiveQueue<OperationBase> injection_queue_;
+    std::atomic<uint32_t> epoch_ = 0;  // bumped to wake up sleeping workers
+    std::atomic<uint32_t> sleepers_ = 0;
+    std::atomic<bool> stopped_ = false;
+};
+
+class WorkStealingPool::Scheduler {
+    struct ScheduleEnv {
+        WorkStealingPool* pool;
+        friend Scheduler tag_invoke(stdexec::get_completion_scheduler_t<stdexec::set_value_t>,
+                                    const ScheduleEnv& env) noexcept {
+            return Scheduler(env.pool);
+        }
+    };
+
+    class ScheduleSender {
+        template <typename Receiver>
+        class Operation : OperationBase {
+        public:
+            Operation(WorkStealingPool& pool, Receiver&& receiver) noexcept
+                : pool_(pool), receiver_(std::move(receiver)) {
+                execute = &Execute;
+            }
+
+            Operation(Operation&&) = delete;
+            Operation(const Operation&) = delete;
+
+            friend void tag_invoke(stdexec::start_t, Operation& op) noexcept { op.Start(); }
+
+        private:
+            void Start() noexcept { pool_.Schedule(this); }
+
+            static void Execute(OperationBase* op) noexcept {
+                auto self = static_cast<Operation*>(op);
+                if (stdexec::get_stop_token(stdexec::get_env(self->receiver_)).stop_requested()) {
+                    stdexec::set_stopped(std::move(self->receiver_));
+                    return;
+                }
+                try {
+                    stdexec::set_value(std::move(self->receiver_));
+                } catch (...) {
+                    stdexec::set_error(std::move(self->receiver_), std::current_exception());
+                }
+            }
+
+            WorkStealingPool& pool_;
+            Receiver receiver_;
+        };
+
+    public:
+        using is_sender = void;
+        using completion_sigs =
+            stdexec::completion_signatures<stdexec::set_value_t(),
+                                           stdexec::set_error_t(std::exception_ptr),
+                                           stdexec::set_stopped_t()>;
+
+        template <typename Env>
+        friend completion_sigs tag_invoke(stdexec::get_completion_signatures_t,
+                                          const ScheduleSender&, Env) noexcept {
+            return {};
+        }
+
+        friend ScheduleEnv tag_invoke(stdexec::get_env_t, const ScheduleSender& sender) noexcept {
+            return sender.env_;
+        }
+
+        template <stdexec::receiver_of<completion_sigs> Receiver>
+        friend Operation<std::remove_cvref_t<Receiver>> tag_invoke(stdexec::connect_t,
+                                                                   const ScheduleSender& sender,
+                                                                   Receiver&& receiver) noexcept {
+            return {*sender.env_.pool, std::forward<Receiver>(receiver)};
+        }
+
+    private:
+        friend class Scheduler;
+        explicit ScheduleSender(ScheduleEnv env) noexcept : env_(env) {}
+
+        ScheduleEnv env_;
+    };
+
+public:
+    explicit Scheduler(WorkStealingPool* pool) noexcept : pool_(pool) {}
+
+    friend ScheduleSender tag_invoke(stdexec::schedule_t, const Scheduler& scheduler) noexcept {
+        return ScheduleSender{ScheduleEnv{scheduler.pool_}};
+    }
+
+    friend stdexec::forward_progress_guarantee tag_invoke(
+        stdexec::get_forward_progress_guarantee_t, const Scheduler&) noexcept {
+        return stdexec::forward_progress_guarantee::parallel;
+    }
+
+    friend bool operator==(const Scheduler& a, const Scheduler& b) noexcept {
+        return a.pool_ == b.pool_;
+    }
+
+private:
+    WorkStealingPool* pool_;
+};
+
+inline WorkStealingPool::Scheduler WorkStealingPool::GetScheduler() noexcept {
+    return Scheduler{this};
+}
+
+// Run `fn` on `pool` and complete with its result. Awaited from an exec::task, such as an HTTP
+// handler, the task resumes on its own scheduler afterwards (the reactor): that hop back is the
+// task's, Offload() does not add another one. The operation state lives in the awaiting coroutine
+// frame, nothing is allocated (see test_offload_allocations.cpp).
+//
+//     auto digest = co_await fuchsia::Offload(pool, [&] { return Sha256(req.Body()); });
+template <typename Fn>
+auto Offload(WorkStealingPool& pool, Fn&& fn) {
+    return stdexec::schedule(pool.GetScheduler()) | stdexec::then(std::forward<Fn>(fn));
+}
+
+}  // namespace fuchsia
@@ -16,7 +16,26 @@ namespace fuchsia {
 
 static thread_local EpollContext* current_context = nullptr;
 
-EpollContext::EpollContext() {
+static void BusyPollRelax(EpollContext::Options::BusyPollYield yield) noexcept {
+    switch (yield) {
+        case EpollContext::Options::BusyPollYield::Spin:
+            break;
+        case EpollContext::Options::BusyPollYield::Pause:
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#elif defined(__aarch64__)
+            asm volatile("yield");
+#endif
+            break;
+        case EpollContext::Options::BusyPollYield::Yield:
+            std::this_thread::yield();
+            break;
+    }
+}
+
+EpollContext::EpollContext() : EpollContext(Options{}) {}
+
+EpollContext::EpollContext(Options options) : options_(options) {
     epoll_fd_ = epoll_create(1);
     if (epoll_fd_ < 0) {
         int err = errno;
@@ -32,7 +51,7 @@ EpollContext::EpollContext() {
     }
 
     struct epoll_event event {};
-    event.data.fd = timer_fd_;
+    event.data.ptr = &timer_fd_;
     event.events = EPOLLIN;
     if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, timer_fd_, &event) < 0) {
         int err = errno;
@@ -47,7 +66,7 @@ EpollContext::EpollContext() {
         throw std::system_error{err, std::system_category(), "eventfd create failed"};
     }
 
-    event.data.fd = wakeup_fd_;
+    event.data.ptr = &wakeup_fd_;
     event.events = EPOLLIN;
     if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &event) < 0) {
         int err = errno;
@@ -68,15 +87,15 @@ EpollContext::~EpollContext() {
 void EpollContext::Run() {
     LOG_TRACE("epoll context started running on thread: {}", std::this_thread::get_id());
     current_context = this;
-    ScopeGuard _{[&]() noexcept { current_context = nullptr; }};
+    auto previous_allocator = SlabAllocator::SetCurrent(&allocator_);
+    ScopeGuard _{[&]() noexcept {
+        current_context = nullptr;
+        SlabAllocator::SetCurrent(previous_allocator);
+    }};
 
     while (true) {
         ProcessLocalOperations();
-
-        bool has_remote_operations = ProcessRemoteOperations();
-        if (has_remote_operations) {
-            continue;
-        }
+        ProcessRemoteOperations();
 
         if (stop_source_.stop_requested()) {
             LOG_TRACE("epoll context stopped running");
@@ -110,8 +129,17 @@ void EpollContext::ScheduleLocal(OperationBase* op) noexcept {
 void EpollContext::ScheduleRemote(OperationBase* op) noexcept {
     LOG_TRACE("schedule remote operation: {} from thread: {}", op->uuid,
               std::this_thread::get_id());
-    remote_operation_queue_.PushFront(op);
-    Wakeup();
+    if (remote_operation_queue_.PushFront(op)) {
+        // the loop is (about to go) sleeping, only the first push after that has to wake it up.
+        Wakeup();
+    }
+}
+
+void EpollContext::ScheduleRemote(IntrusiveQueue<OperationBase>&& ops) noexcept {
+    LOG_TRACE("schedule remote operations from thread: {}", std::this_thread::get_id());
+    if (remote_operation_queue_.PushAllFront(std::move(ops))) {
+        Wakeup();
+    }
 }
 
 void EpollContext::ScheduleAt(EpollContext::TimerOperation* op) noexcept {
@@ -119,7 +147,7 @@ void EpollContext::ScheduleAt(EpollContext::TimerOperation* op) noexcept {
     assert(op->execute != nullptr);
     assert(IsRunningOnIOThread());
     timer_queue_.Push(op);
-    if (timer_queue_.Top() == op) {
+    if (!next_expiration_time_ || op->expiration < *next_expiration_time_) {
         UpdateNextExpirationTime();
     }
 }
@@ -127,11 +155,67 @@ void EpollContext::ScheduleAt(EpollContext::TimerOperation* op) noexcept {
 void EpollContext::RemoveTimer(EpollContext::TimerOperation* op) noexcept {
     LOG_TRACE("remove timer operation: {}", op->uuid);
     assert(IsRunningOnIOThread());
-    bool need_update = timer_queue_.Top() == op;
+    // The timerfd is left armed, the worst case is one spurious wakeup, which is much cheaper than
+    // a timerfd_settime() for every timeout that is cancelled before it fires.
     timer_queue_.Remove(op);
-    if (need_update) {
-        UpdateNextExpirationTime();
+}
+
+std::error_code EpollContext::WaitDescriptor(int fd, OperationBase* op, WaitType type) noexcept {
+    assert(IsRunningOnIOThread());
+    if (fd < 0) {
+        return std::make_error_code(std::errc::bad_file_descriptor);
+    }
+    if (static_cast<size_t>(fd) >= descriptors_.size()) {
+        descriptors_.resize(fd + 1);
+    }
+
+    auto& state = descriptors_[fd];
+    if (!state.registered) {
+        struct epoll_event event {};
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.ptr = &state;
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+            int err = errno;
+            LOG_ERROR("epoll add fd {} failed: {}", fd, strerror(err));
+            return std::make_error_code(std::errc(err));
+        }
+        LOG_TRACE("fd {} registered", fd);
+        state.fd = fd;
+        state.registered = true;
     }
+
+    auto& slot = state.Slot(type);
+    assert(slot == nullptr);  // only one pending operation per direction
+    LOG_TRACE("operation {} waiting for fd {}", op->uuid, fd);
+    slot = op;
+    return {};
+}
+
+bool EpollContext::CancelWait(int fd, OperationBase* op, WaitType type) noexcept {
+    assert(IsRunningOnIOThread());
+    if (fd < 0 || static_cast<size_t>(fd) >= descriptors_.size()) {
+        return false;
+    }
+    auto& state = descriptors_[fd];
+    auto& slot = state.Slot(type);
+    if (slot != op) {
+        return false;
+    }
+    slot = nullptr;
+    return true;
+}
+
+void EpollContext::ReleaseDescriptor(int fd) noexcept {
+    if (fd < 0 || static_cast<size_t>(fd) >= descriptors_.size()) {
+        return;
+    }
+    auto& state = descriptors_[fd];
+    if (state.registered) {
+        struct epoll_event event {};
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, &event);
+        LOG_TRACE("fd {} released", fd);
+    }
+    state = DescriptorState{};
 }
 
 void EpollContext::ProcessLocalOperations() noexcept {
@@ -142,9 +226,23 @@ void EpollContext::ProcessLocalOperations() noexcept {
 
     LOG_TRACE("processing local operations");
 
+    // Only operations queued before this point run in this iteration, and at most as many as the
+    // budget allows, the rest waits until epoll has been polled again.
     size_t count = 0;
+    size_t max_count = options_.max_operations_per_iteration;
+    bool timed = options_.max_time_per_iteration.count() > 0;
+    auto deadline = timed ? TimePoint::clock::now() + options_.max_time_per_iteration : TimePoint{};
     auto pending_queue = std::move(local_operation_queue_);
     while (!pending_queue.Empty()) {
+        if ((max_count != 0 && count == max_count) ||
+            (timed && TimePoint::clock::now() >= deadline)) {
+            LOG_TRACE("operation budget exhausted after {} local operations", count);
+            local_operation_queue_.Prepend(std::move(pending_queue));
+            metrics_.budget_exhausted.store(
+                metrics_.budget_exhausted.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+            break;
+        }
         auto op = pending_queue.PopFront();
         op->execute.load()(op);
         ++count;
@@ -176,9 +274,9 @@ bool EpollContext::ProcessRemoteOperations() noexcept {
 void EpollContext::ProcessTimers() noexcept {
     LOG_TRACE("processing timers");
 
-    auto now = TimePoint::clock::now();
-    while (!timer_queue_.Empty() && timer_queue_.Top()->expiration <= now) {
-        auto op = static_cast<TimerOperation*>(timer_queue_.Pop());
+    auto expired = timer_queue_.PopExpired(TimePoint::clock::now());
+    while (!expired.Empty()) {
+        auto op = expired.PopFront();
         auto old_state = op->state.fetch_or(OperationFlags::Expired, std::memory_order_acq_rel);
         if (old_state & OperationFlags::Cancelled) {
             LOG_TRACE("timer operation {} already cancelled", op->uuid);
@@ -202,7 +300,7 @@ void EpollContext::UpdateNextExpirationTime() noexcept {
             next_expiration_time_.reset();
         }
     } else {
-        auto earliest_expiration = timer_queue_.Top()->expiration;
+        auto earliest_expiration = *timer_queue_.NextExpiration();
         auto duration = earliest_expiration - TimePoint::clock::now();
         LOG_TRACE("next timer operation will expire in {} ms",
                   std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
@@ -233,36 +331,84 @@ void EpollContext::BlockingWaitEvents() {
 
     static constexpr size_t kMaxEventsPerLoop = 128;
     struct epoll_event events[kMaxEventsPerLoop];
-    int num_events =
-        epoll_wait(epoll_fd_, events, kMaxEventsPerLoop, local_operation_queue_.Empty() ? -1 : 0);
+
+    if (local_operation_queue_.Empty() && options_.busy_poll_duration.count() > 0) {
+        // The remote queue stays active meanwhile, so remote threads do not write the eventfd.
+        auto deadline = TimePoint::clock::now() + options_.busy_poll_duration;
+        while (true) {
+            int num_events = WaitEvents(events, kMaxEventsPerLoop, 0);
+            metrics_.busy_polls.store(metrics_.busy_polls.load(std::memory_order_relaxed) + 1,
+                                      std::memory_order_relaxed);
+            if (num_events > 0 || !remote_operation_queue_.Empty() ||
+                stop_source_.stop_requested()) {
+                DispatchEvents(events, num_events);
+                return;
+            }
+            if (TimePoint::clock::now() >= deadline) {
+                LOG_TRACE("busy poll window passed idle");
+                break;
+            }
+            BusyPollRelax(options_.busy_poll_yield);
+        }
+    }
+
+    // Only block if there is nothing left to do, remote threads see the queue inactive from now on
+    // and wake us up with the eventfd. If it is not empty, just poll and come back to it.
+    bool block = local_operation_queue_.Empty() && remote_operation_queue_.TryMarkInactive();
+    int num_events = WaitEvents(events, kMaxEventsPerLoop, block ? -1 : 0);
+    if (block) {
+        remote_operation_queue_.MarkActive();
+    }
+
+    LOG_TRACE("blocking wait finished, {} events received", num_events);
+    DispatchEvents(events, num_events);
+}
+
+int EpollContext::WaitEvents(struct epoll_event* events, int max_events, int timeout) {
+    int num_events = epoll_wait(epoll_fd_, events, max_events, timeout);
+    metrics_.polls.store(metrics_.polls.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_relaxed);
     if (num_events < 0) {
         int err = errno;
         if (err != EINTR) {
             LOG_ERROR("epoll_wait failed: {}", strerror(err));
             throw std::system_error{err, std::system_category(), "epoll_wait failed"};
         }
+        return 0;
     }
+    return num_events;
+}
 
-    LOG_TRACE("blocking wait finished, {} events received", num_events);
-
+void EpollContext::DispatchEvents(const struct epoll_event* events, int num_events) {
     for (int i = 0; i < num_events; ++i) {
-        if (events[i].data.fd == timer_fd_) {
+        if (events[i].data.ptr == &timer_fd_) {
             LOG_TRACE("timer event received");
             Drain(timer_fd_);
             ProcessTimers();
-        } else if (events[i].data.fd == wakeup_fd_) {
+        } else if (events[i].data.ptr == &wakeup_fd_) {
             LOG_TRACE("wakeup event received");
             Drain(wakeup_fd_);
             // Do nothing
         } else {
-            auto op = reinterpret_cast<OperationBase*>(events[i].data.ptr);
-            LOG_TRACE("event received for operation {}", op->uuid);
-            ScheduleLocal(op);
+            auto state = static_cast<DescriptorState*>(events[i].data.ptr);
+            auto ready = events[i].events;
+            LOG_TRACE("event {:#x} received for fd {}", ready, state->fd);
+            if ((ready & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0 &&
+                state->read_op != nullptr) {
+                ScheduleLocal(std::exchange(state->read_op, nullptr));
+            }
+            if ((ready & (EPOLLOUT | EPOLLHUP | EPOLLERR)) != 0 && state->write_op != nullptr) {
+                ScheduleLocal(std::exchange(state->write_op, nullptr));
+            }
+            if ((ready & EPOLLERR) != 0 && state->error_op != nullptr) {
+                ScheduleLocal(std::exchange(state->error_op, nullptr));
+            }
         }
     }
 }
 
 void EpollContext::Wakeup() {
+    metrics_.wakeups.fetch_add(1, std::memory_order_relaxed);
     uint64_t value = 1;
     ssize_t n = ::write(wakeup_fd_, &value, sizeof(value));
     if (n < 0) {
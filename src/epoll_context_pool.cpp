@@ -0,0 +1,58 @@
+//
+// Created by wenjuxu on 2023/8/12.
+//
+
+#include "fuchsia/epoll_context_pool.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "fuchsia/logging.h"
+
+namespace fuchsia {
+
+EpollContextPool::EpollContextPool(size_t size, bool pin_threads, EpollContext::Options options)
+    : pin_threads_(pin_threads) {
+    if (size == 0) {
+        size = 1;
+    }
+    contexts_.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        contexts_.push_back(std::make_unique<EpollContext>(options));
+    }
+    LOG_TRACE("epoll context pool created with {} contexts", size);
+}
+
+EpollContextPool::~EpollContextPool() { Stop(); }
+
+EpollContext& EpollContextPool::Next() noexcept {
+    auto index = next_.fetch_add(1, std::memory_order_relaxed);
+    return *contexts_[index % contexts_.size()];
+}
+
+void EpollContextPool::Start() {
+    assert(threads_.empty());
+    threads_.reserve(contexts_.size());
+    for (size_t i = 0; i < contexts_.size(); ++i) {
+        threads_.emplace_back([this, i] { contexts_[i]->Run(); });
+        if (pin_threads_) {
+            cpu_set_t cpu_set;
+            CPU_ZERO(&cpu_set);
+            CPU_SET(i % std::thread::hardware_concurrency(), &cpu_set);
+            int err = pthread_setaffinity_np(threads_.back().native_handle(), sizeof(cpu_set),
+                                             &cpu_set);
+            if (err != 0) {
+                LOG_WARN("pin epoll context thread {} failed: {}", i, strerror(err));
+            }
+        }
+    }
+}
+
+void EpollContextPool::Stop() noexcept {
+    for (auto& context : contexts_) {
+        context->Stop();
+    }
+    threads_.clear();  // join
+}
+
+}  // namespace fuchsia
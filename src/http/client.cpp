@@ -0,0 +1,149 @@
+//
+// Created by wenjuxu on 2023/8/29.
+//
+
+#include "fuchsia/http/client.h"
+
+#include <string_view>
+#include <system_error>
+
+#include "fuchsia/logging.h"
+#include "fuchsia/socket_connect_op.h"
+#include "fuchsia/socket_recv_some_op.h"
+#include "fuchsia/socket_send_all_op.h"
+
+namespace fuchsia::http {
+
+void ClientRequest::AppendTo(std::string& out, std::string_view host) const {
+    out.append(method).append(" ").append(target).append(" HTTP/1.1\r\n");
+    bool has_host = false;
+    for (const auto& header : headers) {
+        out.append(header.key).append(": ").append(header.value).append("\r\n");
+        has_host = has_host || header.key == "Host";
+    }
+    if (!has_host) {
+        out.append("Host: ").append(host).append("\r\n");
+    }
+    if (!body.empty()) {
+        char digits[20];
+        out.append("Content-Length: ").append(FormatDecimal(digits, body.size())).append("\r\n");
+    }
+    out.append("\r\n").append(body);
+}
+
+// Methods whose requests may be sent twice with the same effect as once, RFC 9110 9.2.2.
+static bool IsIdempotent(std::string_view method) noexcept {
+    return method == "GET" || method == "HEAD" || method == "PUT" || method == "DELETE" ||
+           method == "OPTIONS" || method == "TRACE";
+}
+
+exec::task<void> Client::Send(const fuchsia::net::Tcp::Endpoint& endpoint,
+                              const ClientRequest& request, ClientResponse& response) {
+    auto [it, inserted] = hosts_.try_emplace(endpoint);
+    auto& host = it->second;
+    if (inserted) {
+        host.name = endpoint.ToString();
+    }
+
+    bool retry = false;
+    while (true) {
+        // The retry goes to a new connection, the other pooled ones may well be stale too.
+        auto connection = retry ? nullptr : Checkout(host);
+        bool reused = connection != nullptr;
+        if (!reused) {
+            connection = std::make_unique<Connection>(context_, endpoint.Protocol());
+            co_await fuchsia::AsyncConnect(connection->socket, endpoint);
+            LOG_TRACE("Client connected to {}", host.name);
+        }
+
+        connection->write_buffer.clear();
+        request.AppendTo(connection->write_buffer, host.name);
+        response.Reset();
+        response.skip_body_ = request.method == "HEAD";
+
+        bool sent = false;
+        bool received = false;
+        bool keep_alive = false;
+        try {
+            co_await fuchsia::AsyncSendAll(connection->socket,
+                                           fuchsia::Buffer(connection->write_buffer));
+            sent = true;
+            keep_alive = co_await Receive(*connection, response, received);
+        } catch (const std::system_error& e) {
+            // Once sent, the server may have acted on the request even though no answer came
+            // back, so only what is safe to repeat is sent again.
+            if (!reused || received || (sent && !IsIdempotent(request.method))) {
+                throw;
+            }
+            LOG_DEBUG("Client retries on a new connection to {}: {}", host.name, e.what());
+            retry = true;
+            continue;
+        }
+
+        if (keep_alive) {
+            Checkin(host, std::move(connection));
+        }
+        co_return;
+    }
+}
+
+size_t Client::IdleConnections(const fuchsia::net::Tcp::Endpoint& endpoint) const {
+    auto it = hosts_.find(endpoint);
+    return it == hosts_.end() ? 0 : it->second.idle.size();
+}
+
+std::unique_ptr<Client::Connection> Client::Checkout(Host& host) {
+    auto now = EpollContext::Now();
+    while (!host.idle.empty()) {
+        auto connection = std::move(host.idle.back());
+        host.idle.pop_back();
+        if (now - connection->idle_since < options_.idle_timeout) {
+            return connection;
+        }
+    }
+    return nullptr;
+}
+
+void Client::Checkin(Host& host, std::unique_ptr<Connection> connection) {
+    if (host.idle.size() >= options_.max_idle_per_host) {
+        return;
+    }
+    connection->idle_since = EpollContext::Now();
+    host.idle.push_back(std::move(connection));
+}
+
+exec::task<bool> Client::Receive(Connection& connection, ClientResponse& response,
+                                 bool& received) {
+    while (true) {
+        size_t size = 0;
+        try {
+            size = co_await fuchsia::AsyncRecvSome(connection.socket,
+                                                   fuchsia::Buffer(response.buffer_));
+        } catch (const std::system_error& e) {
+            if (e.code() != std::errc::connection_aborted || !received) {
+                throw;
+            }
+        }
+        if (size == 0) {
+            // Closed by the server, which ends a response without Content-Length.
+            if (response.Finish() != ParseResult::Ok) {
+                throw std::system_error(std::make_error_code(std::errc::connection_aborted),
+                                        "connection closed before the end of the response");
+            }
+            co_return false;
+        }
+        received = true;
+
+        auto result = response.Parse(response.buffer_, size);
+        if (result == ParseResult::Error) {
+            throw std::system_error(std::make_error_code(std::errc::bad_message),
+                                    "malformed http response");
+        }
+        if (result == ParseResult::Ok) {
+            // Anything after the response was not asked for, do not reuse such a connection.
+            co_return response.KeepAlive() && response.Consumed() == size;
+        }
+    }
+}
+
+}  // namespace fuchsia::http
@@ -0,0 +1,26 @@
+//
+// Created by wenjuxu on 2023/8/26.
+//
+
+#include "fuchsia/http/date_cache.h"
+
+namespace fuchsia::http {
+
+static thread_local DateCache* current_cache = nullptr;
+
+DateCache* DateCache::Current() noexcept { return current_cache; }
+
+DateCache* DateCache::SetCurrent(DateCache* cache) noexcept {
+    auto previous = current_cache;
+    current_cache = cache;
+    return previous;
+}
+
+void DateCache::Refresh() noexcept {
+    std::time_t now = std::time(nullptr);
+    std::tm tm{};
+    ::gmtime_r(&now, &tm);
+    size_ = std::strftime(header_, sizeof(header_), "Date: %a, %d %b %Y %H:%M:%S GMT\r\n", &tm);
+}
+
+}  // namespace fuchsia::http
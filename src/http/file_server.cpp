@@ -0,0 +1,191 @@
+//
+// Created by wenjuxu on 2023/9/2.
+//
+
+#include "fuchsia/http/file_server.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <utility>
+
+#include "fuchsia/logging.h"
+
+namespace fuchsia::http {
+
+namespace {
+
+// Whether `path`, relative to the root, stays below it.
+bool IsSafePath(std::string_view path) {
+    while (!path.empty()) {
+        auto slash = path.find('/');
+        auto segment = path.substr(0, slash);
+        if (segment == ".." || segment.find('\0') != std::string_view::npos) {
+            return false;
+        }
+        if (slash == std::string_view::npos) {
+            break;
+        }
+        path.remove_prefix(slash + 1);
+    }
+    return true;
+}
+
+}  // namespace
+
+FileServer::File::~File() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+FileServer::FileServer(std::string root, std::string prefix, FileServerOptions options)
+    : root_(std::move(root)), prefix_(std::move(prefix)), options_(options) {
+    while (!root_.empty() && root_.back() == '/') {
+        root_.pop_back();
+    }
+}
+
+exec::task<void> FileServer::Serve(const Request& req, Response& resp) {
+    resp.SetKeepAlive(req.KeepAlive());
+    bool head = req.Method() == "HEAD";
+    if (!head && req.Method() != "GET") {
+        resp.SetStatusCode(StatusCode::MethodNotAllowed);
+        resp.AddHeader("Allow", "GET, HEAD");
+        co_return;
+    }
+
+    auto path = req.Url().substr(0, req.Url().find('?'));
+    if (!path.starts_with(prefix_)) {
+        resp.SetStatusCode(StatusCode::NotFound);
+        co_return;
+    }
+    path.remove_prefix(prefix_.size());
+    while (path.starts_with('/')) {
+        path.remove_prefix(1);
+    }
+    if (!IsSafePath(path)) {
+        resp.SetStatusCode(StatusCode::Forbidden);
+        co_return;
+    }
+
+    std::shared_ptr<File> file;
+    if (path.empty() || path.ends_with('/')) {
+        std::string index{path};
+        index.append("index.html");
+        file = Open(index);
+    } else {
+        file = Open(path);
+    }
+    if (file == nullptr) {
+        resp.SetStatusCode(StatusCode::NotFound);
+        co_return;
+    }
+
+    resp.AddHeader("ETag", file->etag);
+    resp.AddHeader("Last-Modified", file->last_modified);
+    auto if_none_match = req.Header("If-None-Match");
+    if (if_none_match.empty() ? NotModifiedSince(req.Header("If-Modified-Since"), file->mtime.tv_sec)
+                              : MatchesETag(if_none_match, file->etag)) {
+        resp.SetStatusCode(StatusCode::NotModified);
+        co_return;
+    }
+
+    resp.SetStatusCode(StatusCode::Ok);
+    resp.AddHeader("Content-Type", std::string{file->content_type});
+    if (head || file->size == 0) {
+        // No body to take the length from, a HEAD gets the one a GET would.
+        char digits[20];
+        resp.AddHeader("Content-Length", std::string{FormatDecimal(digits, file->size)});
+    } else {
+        auto fd = file->fd;
+        auto size = file->size;
+        resp.SetFileBody({.fd = fd, .offset = 0, .size = size, .owner = std::move(file)});
+    }
+}
+
+size_t FileServer::OpenFiles() const {
+    std::lock_guard lock(mutex_);
+    return files_.size();
+}
+
+std::shared_ptr<FileServer::File> FileServer::Open(std::string_view path) {
+    auto now = Clock::now();
+    std::shared_ptr<File> cached;
+    {
+        std::lock_guard lock(mutex_);
+        if (auto it = files_.find(path); it != files_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            cached = *it->second;
+            if (now - cached->checked < options_.revalidate_interval) {
+                return cached;
+            }
+        }
+    }
+
+    // Not cached, or due for revalidation: a file replaced or modified since is opened again.
+    if (cached != nullptr) {
+        std::string full_path = root_ + '/' + cached->path;
+        struct ::stat st {};
+        if (::stat(full_path.c_str(), &st) == 0 && st.st_ino == cached->inode &&
+            static_cast<size_t>(st.st_size) == cached->size &&
+            st.st_mtim.tv_sec == cached->mtime.tv_sec &&
+            st.st_mtim.tv_nsec == cached->mtime.tv_nsec) {
+            std::lock_guard lock(mutex_);
+            cached->checked = now;
+            return cached;
+        }
+        LOG_DEBUG("FileServer reloads {}", cached->path);
+    }
+
+    auto file = Load(path);
+    std::lock_guard lock(mutex_);
+    if (auto it = files_.find(path); it != files_.end()) {
+        lru_.erase(it->second);
+        files_.erase(it);
+    }
+    if (file != nullptr) {
+        file->checked = now;
+        Insert(file);
+    }
+    return file;
+}
+
+std::shared_ptr<FileServer::File> FileServer::Load(std::string_view path) const {
+    auto file = std::make_shared<File>();
+    file->path = path;
+    std::string full_path = root_ + '/' + file->path;
+    // Non-blocking, so that opening a FIFO does not wait for a writer on the reactor thread.
+    file->fd = ::open(full_path.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+    if (file->fd < 0) {
+        return nullptr;
+    }
+    struct ::stat st {};
+    if (::fstat(file->fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return nullptr;
+    }
+    ::fcntl(file->fd, F_SETFL, ::fcntl(file->fd, F_GETFL) & ~O_NONBLOCK);  // a plain file again
+    file->size = static_cast<size_t>(st.st_size);
+    file->inode = st.st_ino;
+    file->mtime = st.st_mtim;
+    file->content_type = ContentType(path);
+
+    char etag[64];
+    file->etag = FormatETag(etag, st.st_mtim, file->size);
+    char date[32];
+    file->last_modified = FormatHttpDate(date, st.st_mtim.tv_sec);
+    return file;
+}
+
+void FileServer::Insert(std::shared_ptr<File> file) {
+    lru_.push_front(file);
+    files_.emplace(file->path, lru_.begin());
+    while (files_.size() > options_.max_open_files) {
+        // Responses still sending the file hold it open until they are done.
+        files_.erase(lru_.back()->path);
+        lru_.pop_back();
+    }
+}
+
+}  // namespace fuchsia::http
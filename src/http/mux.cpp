@@ -4,27 +4,299 @@
 
 #include "fuchsia/http/mux.h"
 
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
 #include <utility>
 
 namespace fuchsia::http {
 
+ServeMux::ServeMux() : nodes_(1), lookup_nodes_(1) {}
+
 void ServeMux::HandleFunc(const std::string& pattern, ServeMux::Handler handler) {
-    if (handlers_.find(pattern) != handlers_.end()) {
+    // Nothing is inserted until the whole pattern is known to fit in.
+    auto pieces = ParsePattern(pattern);
+    CheckConflicts(pieces);
+
+    uint32_t node = 0;
+    for (const auto& piece : pieces) {
+        node = piece.param ? InsertParam(node, piece.text) : InsertStatic(node, piece.text);
+    }
+    nodes_[node].handler = static_cast<uint32_t>(handlers_.size());
+    nodes_[node].wildcard = pattern.back() == '/';
+    handlers_.push_back(std::move(handler));
+    Compile();
+}
+
+std::vector<ServeMux::Piece> ServeMux::ParsePattern(std::string_view pattern) {
+    if (pattern.empty() || pattern.front() != '/') {
+        throw std::runtime_error("pattern must start with /");
+    }
+
+    std::vector<Piece> pieces;
+    std::string_view rest = pattern;
+    while (!rest.empty()) {
+        auto open = rest.find('{');
+        if (open != 0) {
+            pieces.push_back({rest.substr(0, open), false});
+        }
+        if (open == std::string_view::npos) {
+            break;
+        }
+        auto close = rest.find('}', open);
+        if (close == std::string_view::npos || close == open + 1 || rest[open - 1] != '/' ||
+            (close + 1 < rest.size() && rest[close + 1] != '/')) {
+            throw std::runtime_error("{name} must be a whole path segment");
+        }
+        pieces.push_back({rest.substr(open + 1, close - open - 1), true});
+        rest = rest.substr(close + 1);
+    }
+    return pieces;
+}
+
+void ServeMux::CheckConflicts(const std::vector<Piece>& pieces) const {
+    // Follow the pattern down the tree as far as it goes, past that point it adds new nodes only.
+    uint32_t node = 0;
+    for (const auto& piece : pieces) {
+        if (piece.param) {
+            uint32_t child = nodes_[node].param_child;
+            if (child == kNone) {
+                return;
+            }
+            if (Label(nodes_[child].param_name, nodes_[child].param_name_size) != piece.text) {
+                throw std::runtime_error("conflicting {name} segments at the same position");
+            }
+            node = child;
+            continue;
+        }
+        std::string_view text = piece.text;
+        while (!text.empty()) {
+            auto k = nodes_[node].indices.find(text.front());
+            if (k == std::string::npos) {
+                return;
+            }
+            uint32_t child = nodes_[node].children[k];
+            auto prefix = Label(nodes_[child].prefix, nodes_[child].prefix_size);
+            if (!text.starts_with(prefix)) {
+                return;  // the node would be split
+            }
+            text.remove_prefix(prefix.size());
+            node = child;
+        }
+    }
+    if (nodes_[node].handler != kNone) {
         throw std::runtime_error("pattern already exists");
     }
-    handlers_[pattern] = std::move(handler);
 }
 
-const ServeMux::Handler* ServeMux::Match(const std::string& path) const {
-    for (const auto& [p, handler] : handlers_) {
-        if (p == path) {
-            return &handler;
+uint32_t ServeMux::AddLabel(std::string_view text) {
+    auto offset = static_cast<uint32_t>(labels_.size());
+    labels_.append(text);
+    return offset;
+}
+
+// Returns the node at the end of `text`, below `node`, splitting nodes whose prefix diverges.
+uint32_t ServeMux::InsertStatic(uint32_t node, std::string_view text) {
+    while (!text.empty()) {
+        auto k = nodes_[node].indices.find(text.front());
+        if (k == std::string::npos) {
+            auto child = static_cast<uint32_t>(nodes_.size());
+            nodes_.push_back(Node{.prefix = AddLabel(text),
+                                  .prefix_size = static_cast<uint32_t>(text.size())});
+            nodes_[node].indices.push_back(text.front());
+            nodes_[node].children.push_back(child);
+            return child;
+        }
+
+        uint32_t child = nodes_[node].children[k];
+        auto prefix = Label(nodes_[child].prefix, nodes_[child].prefix_size);
+        uint32_t common = 0;
+        while (common < prefix.size() && common < text.size() && prefix[common] == text[common]) {
+            ++common;
+        }
+        if (common < prefix.size()) {
+            // Put a new node holding the common part between `node` and `child`.
+            auto middle = static_cast<uint32_t>(nodes_.size());
+            Node split{.prefix = nodes_[child].prefix, .prefix_size = common};
+            split.indices.push_back(prefix[common]);
+            split.children.push_back(child);
+            nodes_[child].prefix += common;
+            nodes_[child].prefix_size -= common;
+            nodes_.push_back(std::move(split));
+            nodes_[node].children[k] = middle;
+            child = middle;
+        }
+        node = child;
+        text.remove_prefix(common);
+    }
+    return node;
+}
+
+uint32_t ServeMux::InsertParam(uint32_t node, std::string_view name) {
+    if (nodes_[node].param_child == kNone) {
+        auto child = static_cast<uint32_t>(nodes_.size());
+        nodes_.push_back(Node{.param_name = AddLabel(name),
+                              .param_name_size = static_cast<uint32_t>(name.size())});
+        nodes_[node].param_child = child;
+        return child;
+    }
+    uint32_t child = nodes_[node].param_child;
+    if (Label(nodes_[child].param_name, nodes_[child].param_name_size) != name) {
+        throw std::runtime_error("conflicting {name} segments at the same position");
+    }
+    return child;
+}
+
+void ServeMux::Compile() {
+    std::vector<LookupNode> lookup(nodes_.size());
+    std::vector<uint32_t> order{0};  // the node of nodes_ at every position of `lookup`
+    order.reserve(nodes_.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        const Node& node = nodes_[order[i]];
+        LookupNode& l = lookup[i];
+        l.prefix = node.param_name_size > 0 ? node.param_name : node.prefix;
+        l.prefix_size = node.param_name_size > 0 ? node.param_name_size : node.prefix_size;
+        l.handler = node.handler;
+        l.wildcard = node.wildcard;
+        l.first_child = static_cast<uint32_t>(order.size());
+        l.num_children = static_cast<uint16_t>(node.children.size());
+        for (size_t k = 0; k < node.children.size(); ++k) {
+            if (k < LookupNode::kInlineChildren) {
+                auto c = static_cast<uint64_t>(static_cast<unsigned char>(node.indices[k]));
+                l.child_chars |= c << (k * 8);
+            }
+            order.push_back(node.children[k]);
+        }
+        if (node.param_child != kNone) {
+            l.param_child = static_cast<uint32_t>(order.size());
+            order.push_back(node.param_child);
+        }
+    }
+    lookup_nodes_ = std::move(lookup);
+}
+
+const ServeMux::Handler* ServeMux::Match(std::string_view path) const {
+    RouteParams params;
+    return Match(path, params);
+}
+
+const ServeMux::Handler* ServeMux::Match(std::string_view path, RouteParams& params) const {
+    params.Clear();
+    path = path.substr(0, path.find('?'));
+    return Lookup(0, path, params);
+}
+
+std::optional<exec::task<void>> ServeMux::Dispatch(Request& req, Response& resp) const {
+    RouteParams params;
+    auto handler = Match(req.Url(), params);
+    if (handler == nullptr) {
+        return std::nullopt;
+    }
+    req.SetParams(params);
+    return (*handler)(req, resp);
+}
+
+namespace {
+
+template <typename T>
+T Load(const char* p) noexcept {
+    T value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+}  // namespace
+
+// The static child of `node` whose prefix starts with `c`, kNone if there is none.
+uint32_t ServeMux::FindChild(const LookupNode& node, char c) const noexcept {
+    constexpr uint64_t kOnes = 0x0101010101010101;
+    constexpr uint64_t kHighs = 0x8080808080808080;
+    uint32_t inline_children = std::min<uint32_t>(node.num_children, LookupNode::kInlineChildren);
+    // The lowest byte of `x` that is zero is the child, the bytes above it may be off.
+    uint64_t x = node.child_chars ^ (kOnes * static_cast<unsigned char>(c));
+    uint64_t zeros = (x - kOnes) & ~x & kHighs;
+    if (zeros != 0) {
+        uint32_t k = std::countr_zero(zeros) / 8;
+        return k < inline_children ? node.first_child + k : kNone;
+    }
+    for (uint32_t k = inline_children; k < node.num_children; ++k) {
+        if (labels_[lookup_nodes_[node.first_child + k].prefix] == c) {
+            return node.first_child + k;
+        }
+    }
+    return kNone;
+}
+
+// Compares words of the path and of the prefix, the last one overlapping the one before if the
+// size is not a multiple, rather than byte by byte.
+bool ServeMux::HasPrefix(std::string_view path, const LookupNode& node) const noexcept {
+    uint32_t size = node.prefix_size;
+    if (path.size() < size) {
+        return false;
+    }
+    const char* a = path.data();
+    const char* b = labels_.data() + node.prefix;
+    if (size >= 8) {
+        for (uint32_t i = 0; i + 8 < size; i += 8) {
+            if (Load<uint64_t>(a + i) != Load<uint64_t>(b + i)) {
+                return false;
+            }
+        }
+        return Load<uint64_t>(a + size - 8) == Load<uint64_t>(b + size - 8);
+    }
+    if (size >= 4) {
+        return Load<uint32_t>(a) == Load<uint32_t>(b) &&
+               Load<uint32_t>(a + size - 4) == Load<uint32_t>(b + size - 4);
+    }
+    return size == 0 || (a[0] == b[0] && a[size / 2] == b[size / 2] && a[size - 1] == b[size - 1]);
+}
+
+// `path` is what follows the prefix of `node`. Descends without recursing until a node with a
+// `{name}` child or a trailing `/` pattern, which the static child may have to backtrack to.
+const ServeMux::Handler* ServeMux::Lookup(uint32_t node, std::string_view path,
+                                          RouteParams& params) const {
+    while (true) {
+        const LookupNode& n = lookup_nodes_[node];
+        if (path.empty()) {
+            return n.handler == kNone ? nullptr : &handlers_[n.handler];
         }
-        if (p.back() == '/' && path.size() > p.size() && path.substr(0, p.size()) == p) {
-            return &handler;
+
+        uint32_t child = FindChild(n, path.front());
+        if (child != kNone && !HasPrefix(path, lookup_nodes_[child])) {
+            child = kNone;
+        }
+
+        if (n.param_child == kNone && !n.wildcard) {
+            if (child == kNone) {
+                return nullptr;
+            }
+            path.remove_prefix(lookup_nodes_[child].prefix_size);
+            node = child;
+            continue;
+        }
+
+        if (child != kNone) {
+            auto rest = path.substr(lookup_nodes_[child].prefix_size);
+            if (auto handler = Lookup(child, rest, params)) {
+                return handler;
+            }
+        }
+
+        if (n.param_child != kNone) {
+            const LookupNode& c = lookup_nodes_[n.param_child];
+            auto segment = path.substr(0, path.find('/'));
+            size_t size = params.Size();
+            if (!segment.empty() && params.Push(Label(c.prefix, c.prefix_size), segment)) {
+                if (auto handler = Lookup(n.param_child, path.substr(segment.size()), params)) {
+                    return handler;
+                }
+                params.Truncate(size);
+            }
         }
+
+        return n.wildcard ? &handlers_[n.handler] : nullptr;
     }
-    return nullptr;
 }
 
 ServeMux DefaultServeMux() {
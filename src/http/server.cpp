@@ -4,6 +4,10 @@
 
 #include "fuchsia/http/server.h"
 
+#include <cerrno>
+#include <new>
+#include <system_error>
+
 #include "exec/async_scope.hpp"
 #include "fuchsia/http/session.h"
 #include "fuchsia/logging.h"
@@ -11,16 +15,23 @@
 
 namespace fuchsia::http {
 
-Server::Server(const std::string& address, int port)
-    : context_(),
-      acceptor_{context_, fuchsia::net::Tcp::Endpoint{fuchsia::net::MakeAddressV4(address),
-                                                      static_cast<fuchsia::net::PortType>(port)}} {}
+Server::Server(const std::string& address, int port, ServerOptions options)
+    : options_(options), pool_(options.num_threads, options.pin_threads, options.context_options) {
+    fuchsia::net::Tcp::Endpoint endpoint{fuchsia::net::MakeAddressV4(address),
+                                         static_cast<fuchsia::net::PortType>(port)};
+    reactors_.reserve(pool_.Size());
+    for (size_t i = 0; i < pool_.Size(); ++i) {
+        reactors_.push_back(std::make_unique<Reactor>(pool_.At(i), endpoint));
+    }
+}
 
 Server::~Server() {
     async_scope_.request_stop();
-    context_.Stop();
-    acceptor_.Close();
-    session_mgr_.StopAll();
+    pool_.Stop();
+    for (auto& reactor : reactors_) {
+        reactor->acceptor.Close();
+        reactor->session_mgr.StopAll();
+    }
 }
 
 static exec::task<void> StartSession(SessionMgr& session_mgr,
@@ -32,16 +43,75 @@ static exec::task<void> StartSession(SessionMgr& session_mgr,
     }
 }
 
-void Server::Serve(const ServeMux& mux) {
-    std::jthread thread{[this] { context_.Run(); }};
-    stdexec::sync_wait([this, &mux]() -> exec::task<void> {
-        while (true) {
-            auto socket = co_await fuchsia::AsyncAccept(acceptor_);
-            auto session = std::make_shared<Session>(std::move(socket), session_mgr_, mux);
-            async_scope_.spawn(
-                stdexec::on(context_.GetScheduler(), StartSession(session_mgr_, session)));
+// Errors that only concern the connection being accepted, the next accept() may well succeed.
+// accept(2) also passes on the network errors already pending on the new socket.
+static bool IsTransientAcceptError(const std::error_code& ec) noexcept {
+    if (ec.category() == std::system_category() &&
+        (ec.value() == EHOSTDOWN || ec.value() == ENONET)) {  // no std::errc for these
+        return true;
+    }
+    return ec == std::errc::connection_aborted || ec == std::errc::interrupted ||
+           ec == std::errc::protocol_error || ec == std::errc::network_down ||
+           ec == std::errc::network_unreachable || ec == std::errc::host_unreachable ||
+           ec == std::errc::no_protocol_option || ec == std::errc::operation_not_supported ||
+           ec == std::errc::operation_not_permitted;
+}
+
+// Errors that last until some descriptors or memory are freed. The listen socket stays readable
+// meanwhile, so retrying right away would spin.
+static bool IsResourceExhaustedError(const std::error_code& ec) noexcept {
+    return ec == std::errc::too_many_files_open ||
+           ec == std::errc::too_many_files_open_in_system ||
+           ec == std::errc::no_buffer_space || ec == std::errc::not_enough_memory;
+}
+
+exec::task<void> Server::Accept(Reactor& reactor, MuxRef mux) {
+    while (true) {
+        bool back_off = false;
+        try {
+            auto socket = co_await fuchsia::AsyncAccept(reactor.acceptor);
+            auto session = MakeSession(std::move(socket), reactor.session_mgr, mux,
+                                       options_.session_options);
+            async_scope_.spawn(stdexec::on(reactor.context.GetScheduler(),
+                                           StartSession(reactor.session_mgr, session)));
+        } catch (const std::system_error& e) {
+            if (IsResourceExhaustedError(e.code())) {
+                LOG_WARN("Accept error: {}, retrying in {}ms", e.what(),
+                         options_.accept_retry_delay.count());
+                back_off = true;
+            } else if (!IsTransientAcceptError(e.code())) {
+                // Rethrowing would terminate the process from the async_scope.
+                LOG_ERROR("Unexpected accept error: {}, retrying in {}ms", e.what(),
+                          options_.accept_retry_delay.count());
+                back_off = true;
+            }
+        } catch (const std::bad_alloc& e) {  // from MakeSession()
+            LOG_WARN("Accept error: {}, retrying in {}ms", e.what(),
+                     options_.accept_retry_delay.count());
+            back_off = true;
         }
-    }());
+        if (back_off) {
+            co_await exec::schedule_after(reactor.context.GetScheduler(),
+                                          options_.accept_retry_delay);
+        }
+    }
+}
+
+exec::task<void> Server::RefreshDate(Reactor& reactor) {
+    DateCache::SetCurrent(&reactor.date_cache);
+    while (true) {
+        co_await exec::schedule_after(reactor.context.GetScheduler(), std::chrono::seconds(1));
+        reactor.date_cache.Refresh();
+    }
+}
+
+void Server::Serve(MuxRef mux) {
+    pool_.Start();
+    for (auto& reactor : reactors_) {
+        async_scope_.spawn(stdexec::on(reactor->context.GetScheduler(), RefreshDate(*reactor)));
+        async_scope_.spawn(stdexec::on(reactor->context.GetScheduler(), Accept(*reactor, mux)));
+    }
+    stdexec::sync_wait(async_scope_.on_empty());
 }
 
 }  // namespace fuchsia::http
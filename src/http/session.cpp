@@ -4,19 +4,57 @@
 
 #include "fuchsia/http/session.h"
 
+#include <atomic>
 #include <sstream>
+#include <system_error>
 
 #include "fuchsia/logging.h"
+#include "fuchsia/scope_guard.h"
 #include "fuchsia/socket_recv_some_op.h"
-#include "fuchsia/socket_send_some_op.h"
+#include "fuchsia/socket_send_file_op.h"
+#include "fuchsia/socket_send_all_op.h"
+#include "fuchsia/with_timeout.h"
 
 namespace fuchsia::http {
 
 exec::task<void> Session::Start() {
     while (true) {
-        auto size = co_await fuchsia::AsyncRecvSome(socket_, fuchsia::Buffer(buffer_));
-        auto result = request_.Parse(buffer_, size);
+        if (read_begin_ == read_end_) {
+            // Everything buffered has been parsed, answer it before waiting for more.
+            co_await Flush();
+            read_begin_ = read_end_ = 0;
+            size_t size = 0;
+            try {
+                auto recv = fuchsia::AsyncRecvSome(socket_, fuchsia::Buffer(buffer_));
+                if (deadline_ == TimePoint::max()) {
+                    size = co_await std::move(recv);
+                } else {
+                    size = co_await fuchsia::WithDeadline(socket_.Context().GetScheduler(),
+                                                          std::move(recv), deadline_);
+                }
+            } catch (const std::system_error& e) {
+                if (e.code() == std::errc::timed_out) {
+                    LOG_DEBUG("Session {} timed out", id_);
+                } else if (e.code() != std::errc::connection_aborted) {
+                    throw;
+                }
+            }
+            if (size == 0) {
+                LOG_TRACE("Session {} closed", id_);
+                session_mgr_.Stop(shared_from_this());
+                break;
+            }
+            read_end_ = size;
+        }
+
+        auto result = request_.Parse(buffer_ + read_begin_, read_end_ - read_begin_);
+        read_begin_ += request_.Consumed();
         if (result == ParseResult::Incomplete) {
+            // The parser kept what it needs, the buffer can be reused.
+            auto phase = request_.HeadersComplete() ? Phase::Body : Phase::Header;
+            if (phase != phase_) {
+                EnterPhase(phase);
+            }
             continue;
         }
 
@@ -24,19 +62,35 @@ exec::task<void> Session::Start() {
         if (result == ParseResult::Error) {
             response_.SetStatusCode(StatusCode::BadRequest);
         } else {  // ParseResult::Ok
-            auto handler = mux_.Match(request_.Url());
-            if (handler == nullptr) {
+            auto task = mux_.Dispatch(request_, response_);
+            if (!task) {
                 response_.SetStatusCode(StatusCode::NotFound);
             } else {
-                co_await handler->operator()(request_, response_);
+                co_await std::move(*task);
             }
         }
 
         LOG_TRACE("Session {} send response: {}", id_, response_.StatusCode());
-        co_await fuchsia::AsyncSendSome(socket_, response_.ToBuffers());
+        if (response_.HasFileBody()) {
+            // The head goes out with whatever is buffered, then the file from the page cache.
+            response_.AppendTo(write_buffer_);
+            co_await Flush();
+            const auto& file = response_.FileBody();
+            co_await fuchsia::AsyncSendFile(socket_, file.fd, file.offset, file.size);
+        } else if (response_.KeepAlive() && read_begin_ != read_end_) {
+            // More requests are pipelined behind this one, send the responses together.
+            response_.AppendTo(write_buffer_);
+        } else if (write_buffer_.empty()) {
+            co_await fuchsia::AsyncSendAll(socket_, response_.ToBuffers());
+        } else {
+            response_.AppendTo(write_buffer_);
+            co_await Flush();
+        }
+
         if (response_.KeepAlive()) {
             request_.Reset();
             response_.Reset();
+            EnterPhase(Phase::Idle);
         } else {
             socket_.Shutdown(fuchsia::net::ShutdownMode::Both);
             session_mgr_.Stop(shared_from_this());
@@ -45,15 +99,43 @@ exec::task<void> Session::Start() {
     }
 }
 
+void Session::EnterPhase(Phase phase) {
+    phase_ = phase;
+    std::chrono::milliseconds timeout{};
+    switch (phase) {
+        case Phase::Idle:
+            timeout = options_.idle_timeout;
+            break;
+        case Phase::Header:
+            timeout = options_.header_timeout;
+            break;
+        case Phase::Body:
+            timeout = options_.body_timeout;
+            break;
+    }
+    deadline_ = timeout == timeout.zero() ? TimePoint::max() : EpollContext::Now() + timeout;
+}
+
+exec::task<void> Session::Flush() {
+    if (write_buffer_.empty()) {
+        co_return;
+    }
+    co_await fuchsia::AsyncSendAll(socket_, fuchsia::Buffer(write_buffer_));
+    write_buffer_.clear();
+}
+
 void Session::Stop() { socket_.Close(); }
 
 uint64_t Session::GenID() {
-    static uint64_t id = 0;
-    return ++id;
+    static std::atomic<uint64_t> id = 0;  // sessions are created on multiple contexts
+    return id.fetch_add(1, std::memory_order_relaxed) + 1;
 }
 
 exec::task<void> SessionMgr::Start(const std::shared_ptr<Session>& session) {
     sessions_.insert(session);
+    // The session stops itself when the connection is done with, but a failed send or recv, or
+    // being stopped, ends it early: whichever way it ends, it is removed and its socket closed.
+    ScopeGuard guard{[this, session]() noexcept { Stop(session); }};
     co_await session->Start();
 }
 
@@ -63,10 +145,12 @@ void SessionMgr::Stop(const std::shared_ptr<Session>& session) {
 }
 
 void SessionMgr::StopAll() {
-    for (const auto& session : sessions_) {
+    // Stopped sessions may remove themselves, not from the set being walked.
+    auto sessions = std::move(sessions_);
+    sessions_.clear();
+    for (const auto& session : sessions) {
         session->Stop();
     }
-    sessions_.clear();
 }
 
 }  // namespace fuchsia::http
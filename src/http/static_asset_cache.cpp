@@ -0,0 +1,367 @@
+//
+// Created by wenjuxu on 2023/9/3.
+//
+
+#include "fuchsia/http/static_asset_cache.h"
+
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <optional>
+#include <set>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "fuchsia/logging.h"
+
+namespace fuchsia::http {
+
+namespace {
+
+constexpr uint32_t kWatchMask =
+    IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+constexpr std::array<std::string_view, 3> kSuffixes{"", ".gz", ".br"};
+constexpr std::array<std::string_view, 3> kContentEncodings{"", "gzip", "br"};
+
+std::string_view Trim(std::string_view s) {
+    while (!s.empty() && s.front() == ' ') {
+        s.remove_prefix(1);
+    }
+    while (!s.empty() && s.back() == ' ') {
+        s.remove_suffix(1);
+    }
+    return s;
+}
+
+// Whether the `Accept-Encoding:` value `accept` allows `coding`, i.e. lists it without `q=0`.
+bool Accepts(std::string_view accept, std::string_view coding) {
+    while (!accept.empty()) {
+        auto comma = accept.find(',');
+        auto item = accept.substr(0, comma);
+        auto semicolon = item.find(';');
+        if (Trim(item.substr(0, semicolon)) == coding) {
+            if (semicolon == std::string_view::npos) {
+                return true;
+            }
+            auto q = Trim(item.substr(semicolon + 1));
+            return !(q.starts_with("q=0") &&
+                     q.find_first_not_of("0.", 2) == std::string_view::npos);
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        accept.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+// `dir/name`, or `name` at the root.
+std::string Join(const std::string& dir, std::string_view name) {
+    std::string path = dir;
+    if (!path.empty()) {
+        path.push_back('/');
+    }
+    path.append(name);
+    return path;
+}
+
+// The path a directory index is also served at, e.g. `docs/` for `docs/index.html`.
+std::optional<std::string> IndexAlias(std::string_view path) {
+    constexpr std::string_view kIndex = "index.html";
+    if (path == kIndex || path.ends_with("/index.html")) {
+        return std::string{path.substr(0, path.size() - kIndex.size())};
+    }
+    return std::nullopt;
+}
+
+void AppendHead(std::string& out, StatusCode status_code, std::string_view content_type,
+                size_t content_length, std::string_view content_encoding, bool vary,
+                std::string_view etag, std::string_view last_modified, bool keep_alive) {
+    char digits[20];
+    out.append(StatusLine(status_code));
+    if (status_code == StatusCode::Ok) {
+        out.append("Content-Type: ").append(content_type).append("\r\n");
+        out.append("Content-Length: ").append(FormatDecimal(digits, content_length));
+        out.append("\r\n");
+        if (!content_encoding.empty()) {
+            out.append("Content-Encoding: ").append(content_encoding).append("\r\n");
+        }
+    }
+    if (vary) {
+        out.append("Vary: Accept-Encoding\r\n");
+    }
+    out.append("ETag: ").append(etag).append("\r\n");
+    out.append("Last-Modified: ").append(last_modified).append("\r\n");
+    out.append(keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n");
+}
+
+}  // namespace
+
+StaticAssetCache::Mapping::~Mapping() {
+    if (data != nullptr) {
+        ::munmap(const_cast<void*>(data), size);
+    }
+}
+
+const StaticAssetCache::Variant& StaticAssetCache::Asset::Select(std::string_view accept) const {
+    if (!accept.empty()) {
+        for (auto encoding : {kBrotli, kGzip}) {  // the smaller one first
+            if (variants[encoding] != nullptr && Accepts(accept, kContentEncodings[encoding])) {
+                return *variants[encoding];
+            }
+        }
+    }
+    return *variants[kIdentity];
+}
+
+StaticAssetCache::StaticAssetCache(std::string root, std::string prefix,
+                                   StaticAssetCacheOptions options)
+    : root_(std::move(root)), prefix_(std::move(prefix)), options_(options) {
+    while (!root_.empty() && root_.back() == '/') {
+        root_.pop_back();
+    }
+    inotify_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd_ < 0) {
+        throw std::system_error(errno, std::system_category(), "inotify_init1");
+    }
+    auto assets = std::make_shared<AssetMap>();
+    std::lock_guard lock(refresh_mutex_);
+    if (auto ec = Scan("", *assets)) {
+        ::close(inotify_fd_);
+        throw std::system_error(ec, "inotify_add_watch " + root_);
+    }
+    assets_.store(std::move(assets));
+}
+
+StaticAssetCache::~StaticAssetCache() { ::close(inotify_fd_); }
+
+exec::task<void> StaticAssetCache::Serve(const Request& req, Response& resp) {
+    bool head = req.Method() == "HEAD";
+    if (!head && req.Method() != "GET") {
+        resp.SetKeepAlive(req.KeepAlive());
+        resp.SetStatusCode(StatusCode::MethodNotAllowed);
+        resp.AddHeader("Allow", "GET, HEAD");
+        co_return;
+    }
+
+    auto path = req.Url().substr(0, req.Url().find('?'));
+    auto assets = assets_.load();
+    auto it = assets->end();
+    if (path.starts_with(prefix_)) {
+        path.remove_prefix(prefix_.size());
+        while (path.starts_with('/')) {
+            path.remove_prefix(1);
+        }
+        it = assets->find(path);
+    }
+    if (it == assets->end()) {
+        resp.SetKeepAlive(req.KeepAlive());
+        resp.SetStatusCode(StatusCode::NotFound);
+        co_return;
+    }
+
+    const auto& variant = it->second->Select(req.Header("Accept-Encoding"));
+    auto if_none_match = req.Header("If-None-Match");
+    bool not_modified = if_none_match.empty()
+                            ? NotModifiedSince(req.Header("If-Modified-Since"), variant.mtime)
+                            : MatchesETag(if_none_match, variant.etag);
+    bool keep_alive = req.KeepAlive();
+    resp.SetStatusCode(not_modified ? StatusCode::NotModified : StatusCode::Ok);
+    const auto& head_block =
+        not_modified ? variant.not_modified_heads[keep_alive] : variant.ok_heads[keep_alive];
+    fuchsia::ConstBuffer body;
+    if (!not_modified && !head) {
+        body = fuchsia::ConstBuffer{variant.body.data, variant.body.size};
+    }
+    resp.SetPrerendered(fuchsia::Buffer(head_block), body, keep_alive, it->second);
+}
+
+exec::task<void> StaticAssetCache::Watch(fuchsia::EpollContext& context) {
+    // The inotify descriptor is drained on a timer of the context, nothing is added to the path of
+    // requests.
+    while (true) {
+        co_await exec::schedule_after(context.GetScheduler(), options_.watch_interval);
+        Refresh();
+    }
+}
+
+size_t StaticAssetCache::Refresh() {
+    std::lock_guard lock(refresh_mutex_);
+    std::set<std::string> changed;
+    std::vector<std::string> new_dirs;
+    bool rescan = false;
+    alignas(::inotify_event) char buffer[4096];
+    while (true) {
+        auto n = ::read(inotify_fd_, buffer, sizeof(buffer));
+        if (n <= 0) {
+            break;  // drained
+        }
+        for (char* p = buffer; p < buffer + n;) {
+            auto event = reinterpret_cast<const ::inotify_event*>(p);
+            p += sizeof(::inotify_event) + event->len;
+            if ((event->mask & IN_Q_OVERFLOW) != 0) {
+                rescan = true;
+                continue;
+            }
+            auto watch = watches_.find(event->wd);
+            if (watch == watches_.end()) {
+                continue;
+            }
+            if ((event->mask & IN_IGNORED) != 0) {
+                watches_.erase(watch);
+                continue;
+            }
+            auto path = Join(watch->second, event->name);
+            if ((event->mask & IN_ISDIR) == 0) {
+                changed.insert(std::move(path));
+            } else if ((event->mask & (IN_CREATE | IN_MOVED_TO)) != 0) {
+                new_dirs.push_back(std::move(path));
+            } else {  // a directory moved away, with whatever is below it
+                rescan = true;
+            }
+        }
+    }
+    if (!rescan && changed.empty() && new_dirs.empty()) {
+        return 0;
+    }
+
+    // Copy on write, requests keep using the current snapshot meanwhile.
+    auto assets = std::make_shared<AssetMap>(rescan ? AssetMap{} : *assets_.load());
+    if (rescan) {
+        LOG_DEBUG("StaticAssetCache rescans {}", root_);
+        Scan("", *assets);
+    }
+    for (const auto& dir : new_dirs) {
+        Scan(dir, *assets);
+    }
+    for (const auto& path : changed) {
+        LOG_DEBUG("StaticAssetCache reloads {}", path);
+        Reload(path, *assets);
+        for (auto suffix : {kSuffixes[kGzip], kSuffixes[kBrotli]}) {
+            if (path.ends_with(suffix)) {  // a variant of another file
+                Reload(path.substr(0, path.size() - suffix.size()), *assets);
+            }
+        }
+    }
+    assets_.store(std::move(assets));
+    return changed.size() + new_dirs.size();
+}
+
+std::error_code StaticAssetCache::Scan(const std::string& dir, AssetMap& assets) {
+    auto full_path = Join(root_, dir);
+    int wd = ::inotify_add_watch(inotify_fd_, full_path.c_str(), kWatchMask);
+    if (wd < 0) {
+        // Its files would never be reloaded, leave them out rather than serve them stale.
+        std::error_code ec{errno, std::system_category()};
+        LOG_WARN("StaticAssetCache skips {}: inotify_add_watch: {}", full_path, ec.message());
+        return ec;
+    }
+    watches_[wd] = dir;
+
+    std::error_code first_error;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(full_path, ec)) {
+        auto path = Join(dir, entry.path().filename().native());
+        if (entry.is_directory(ec)) {
+            if (auto scan_ec = Scan(path, assets); scan_ec && !first_error) {
+                first_error = scan_ec;
+            }
+        } else {
+            Reload(path, assets);
+        }
+    }
+    return first_error;
+}
+
+void StaticAssetCache::Reload(const std::string& path, AssetMap& assets) const {
+    auto asset = Load(path);
+    auto alias = IndexAlias(path);
+    if (asset == nullptr) {
+        assets.erase(path);
+        if (alias) {
+            assets.erase(*alias);
+        }
+        return;
+    }
+    assets[path] = asset;
+    if (alias) {
+        assets[*alias] = asset;
+    }
+}
+
+std::unique_ptr<StaticAssetCache::Variant> StaticAssetCache::Map(
+    const std::string& full_path) const {
+    // Non-blocking, so that opening a FIFO does not wait for a writer.
+    int fd = ::open(full_path.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+    if (fd < 0) {
+        return nullptr;
+    }
+    auto variant = std::make_unique<Variant>();
+    struct ::stat st {};
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) ||
+        static_cast<size_t>(st.st_size) > options_.max_asset_size) {
+        ::close(fd);
+        return nullptr;
+    }
+    variant->body.size = static_cast<size_t>(st.st_size);
+    if (variant->body.size > 0) {
+        void* data = ::mmap(nullptr, variant->body.size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            ::close(fd);
+            return nullptr;
+        }
+        variant->body.data = data;
+    }
+    ::close(fd);  // the mapping stays
+
+    char etag[64];
+    variant->etag = FormatETag(etag, st.st_mtim, variant->body.size);
+    variant->mtime = st.st_mtim.tv_sec;
+    char date[32];
+    variant->last_modified = FormatHttpDate(date, variant->mtime);
+    return variant;
+}
+
+std::shared_ptr<const StaticAssetCache::Asset> StaticAssetCache::Load(std::string_view path) const {
+    auto asset = std::make_shared<Asset>();
+    auto base_path = Join(root_, path);
+    for (int encoding = kIdentity; encoding < kNumEncodings; ++encoding) {
+        auto variant = Map(base_path + std::string{kSuffixes[encoding]});
+        if (variant == nullptr) {
+            if (encoding == kIdentity) {
+                return nullptr;
+            }
+            continue;
+        }
+        if (encoding != kIdentity) {  // a different representation, e.g. `"...-1f4.gz"`
+            variant->etag.insert(variant->etag.size() - 1, kSuffixes[encoding]);
+        }
+        asset->variants[encoding] = std::move(variant);
+    }
+
+    bool vary = asset->variants[kGzip] != nullptr || asset->variants[kBrotli] != nullptr;
+    auto content_type = ContentType(path);
+    for (int encoding = kIdentity; encoding < kNumEncodings; ++encoding) {
+        auto& variant = asset->variants[encoding];
+        if (variant == nullptr) {
+            continue;
+        }
+        for (bool keep_alive : {false, true}) {
+            AppendHead(variant->ok_heads[keep_alive], StatusCode::Ok, content_type,
+                       variant->body.size, kContentEncodings[encoding], vary, variant->etag,
+                       variant->last_modified, keep_alive);
+            AppendHead(variant->not_modified_heads[keep_alive], StatusCode::NotModified,
+                       content_type, 0, {}, vary, variant->etag, variant->last_modified,
+                       keep_alive);
+        }
+    }
+    return asset;
+}
+
+}  // namespace fuchsia::http
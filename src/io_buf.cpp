@@ -0,0 +1,104 @@
+//
+// Created by wenjuxu on 2023/9/4.
+//
+
+#include "fuchsia/io_buf.h"
+
+#include <cstring>
+#include <new>
+
+namespace fuchsia {
+
+IOBuf IOBuf::Create(size_t capacity) {
+    auto block = new (SlabAllocator::Allocate(sizeof(Block) + capacity)) Block{};
+    block->refs.store(1, std::memory_order_relaxed);
+    block->capacity = static_cast<uint32_t>(capacity);
+    IOBuf buf;
+    buf.block_ = block;
+    buf.data_ = block->Begin();
+    return buf;
+}
+
+IOBuf IOBuf::CopyOf(ConstBuffer data) {
+    auto buf = Create(data.Size());
+    if (data.Size() > 0) {
+        std::memcpy(buf.data_, data.Data(), data.Size());
+    }
+    buf.Commit(data.Size());
+    return buf;
+}
+
+void IOBufChain::Append(IOBuf buf) {
+    if (buf.Empty()) {
+        return;
+    }
+    size_ += buf.Size();
+    bufs_.push_back(std::move(buf));
+}
+
+void IOBufChain::Append(IOBufChain&& chain) {
+    for (auto& buf : chain.bufs_) {
+        Append(std::move(buf));
+    }
+    chain.Clear();
+}
+
+void IOBufChain::TrimStart(size_t n) {
+    n = std::min(n, size_);
+    size_ -= n;
+    while (n > 0) {
+        auto& front = bufs_.front();
+        if (n < front.Size()) {
+            front.TrimStart(n);
+            return;
+        }
+        n -= front.Size();
+        bufs_.pop_front();
+    }
+}
+
+IOBufChain IOBufChain::Split(size_t n) {
+    IOBufChain head;
+    n = std::min(n, size_);
+    while (n > 0) {
+        auto& front = bufs_.front();
+        if (n < front.Size()) {
+            head.Append(front.Slice(0, n));
+            front.TrimStart(n);
+            size_ -= n;
+            break;
+        }
+        n -= front.Size();
+        size_ -= front.Size();
+        head.Append(std::move(front));
+        bufs_.pop_front();
+    }
+    return head;
+}
+
+size_t IOBufChain::CopyTo(void* out, size_t size, size_t offset) const {
+    auto dest = static_cast<char*>(out);
+    size_t copied = 0;
+    for (const auto& buf : bufs_) {
+        if (copied == size) {
+            break;
+        }
+        if (offset >= buf.Size()) {
+            offset -= buf.Size();
+            continue;
+        }
+        size_t n = std::min(buf.Size() - offset, size - copied);
+        std::memcpy(dest + copied, buf.Data() + offset, n);
+        copied += n;
+        offset = 0;
+    }
+    return copied;
+}
+
+std::string IOBufChain::ToString() const {
+    std::string out(size_, '\0');
+    CopyTo(out.data(), out.size());
+    return out;
+}
+
+}  // namespace fuchsia
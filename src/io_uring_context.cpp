@@ -0,0 +1,208 @@
+//
+// Created by wenjuxu on 2023/8/13.
+//
+
+#include "fuchsia/io_uring_context.h"
+
+#include <sys/eventfd.h>
+
+#include "fmt/std.h"
+#include "fuchsia/logging.h"
+#include "fuchsia/scope_guard.h"
+
+namespace fuchsia {
+
+static thread_local IoUringContext* current_context = nullptr;
+
+IoUringContext::IoUringContext(unsigned entries) {
+    int ret = io_uring_queue_init(entries, &ring_, 0);
+    if (ret < 0) {
+        LOG_ERROR("io_uring_queue_init failed: {}", strerror(-ret));
+        throw std::system_error{-ret, std::system_category(), "io_uring_queue_init failed"};
+    }
+
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd_ < 0) {
+        int err = errno;
+        io_uring_queue_exit(&ring_);
+        LOG_ERROR("eventfd create failed: {}", strerror(err));
+        throw std::system_error{err, std::system_category(), "eventfd create failed"};
+    }
+
+    LOG_TRACE("io_uring context created");
+}
+
+IoUringContext::~IoUringContext() {
+    io_uring_queue_exit(&ring_);
+    if (wakeup_fd_ > 0) close(wakeup_fd_);
+    LOG_TRACE("io_uring context destroyed");
+}
+
+void IoUringContext::Run() {
+    LOG_TRACE("io_uring context started running on thread: {}", std::this_thread::get_id());
+    current_context = this;
+    ScopeGuard _{[&]() noexcept { current_context = nullptr; }};
+
+    ArmWakeup();
+    while (true) {
+        ProcessLocalOperations();
+
+        bool has_remote_operations = ProcessRemoteOperations();
+        if (has_remote_operations) {
+            continue;
+        }
+
+        if (stop_source_.stop_requested()) {
+            LOG_TRACE("io_uring context stopped running");
+            return;
+        }
+
+        SubmitAndWaitCompletions();
+    }
+}
+
+void IoUringContext::Stop() noexcept {
+    LOG_TRACE("io_uring context stop requested");
+    stop_source_.request_stop();
+    Wakeup();
+}
+
+void IoUringContext::Schedule(OperationBase* op) noexcept {
+    assert(op->execute != nullptr);
+    if (IsRunningOnIOThread()) {
+        ScheduleLocal(op);
+    } else {
+        ScheduleRemote(op);
+    }
+}
+
+void IoUringContext::ScheduleLocal(OperationBase* op) noexcept {
+    LOG_TRACE("schedule local operation: {}", op->uuid);
+    local_operation_queue_.PushBack(op);
+}
+
+void IoUringContext::ScheduleRemote(OperationBase* op) noexcept {
+    LOG_TRACE("schedule remote operation: {} from thread: {}", op->uuid,
+              std::this_thread::get_id());
+    if (remote_operation_queue_.PushFront(op)) {
+        Wakeup();
+    }
+}
+
+io_uring_sqe* IoUringContext::GetSqe() noexcept {
+    auto sqe = io_uring_get_sqe(&ring_);
+    if (sqe == nullptr) {
+        // submission queue is full, hand the pending entries to the kernel to make room.
+        io_uring_submit(&ring_);
+        sqe = io_uring_get_sqe(&ring_);
+    }
+    assert(sqe != nullptr);
+    return sqe;
+}
+
+void IoUringContext::SubmitCancel(CompletionBase* op) noexcept {
+    LOG_TRACE("cancel operation: {}", op->uuid);
+    auto sqe = GetSqe();
+    io_uring_prep_cancel(sqe, op, 0);
+    io_uring_sqe_set_data(sqe, nullptr);  // result of the cancel request itself is ignored
+}
+
+void IoUringContext::ArmWakeup() noexcept {
+    auto sqe = GetSqe();
+    io_uring_prep_read(sqe, wakeup_fd_, &wakeup_value_, sizeof(wakeup_value_), 0);
+    io_uring_sqe_set_data(sqe, &wakeup_fd_);
+}
+
+void IoUringContext::ProcessLocalOperations() noexcept {
+    if (local_operation_queue_.Empty()) {
+        LOG_TRACE("local operation queue is empty");
+        return;
+    }
+
+    LOG_TRACE("processing local operations");
+
+    size_t count = 0;
+    auto pending_queue = std::move(local_operation_queue_);
+    while (!pending_queue.Empty()) {
+        auto op = pending_queue.PopFront();
+        op->execute.load()(op);
+        ++count;
+    }
+
+    LOG_TRACE("processed {} local operations", count);
+}
+
+bool IoUringContext::ProcessRemoteOperations() noexcept {
+    if (remote_operation_queue_.Empty()) {
+        LOG_TRACE("remote operation queue is empty");
+        return false;
+    }
+
+    LOG_TRACE("processing remote operations");
+
+    size_t count = 0;
+    auto pending_queue = remote_operation_queue_.PopAll();
+    while (!pending_queue.Empty()) {
+        auto op = pending_queue.PopFront();
+        ScheduleLocal(op);
+        ++count;
+    }
+
+    LOG_TRACE("processed {} remote operations", count);
+    return true;
+}
+
+void IoUringContext::SubmitAndWaitCompletions() {
+    LOG_TRACE("submit and wait completions");
+
+    // One io_uring_enter() both flushes every sqe prepared in this iteration and waits.
+    // Same as EpollContext, remote threads only write the eventfd once the loop is about to sleep.
+    bool block = local_operation_queue_.Empty() && remote_operation_queue_.TryMarkInactive();
+    int ret = io_uring_submit_and_wait(&ring_, block ? 1 : 0);
+    if (block) {
+        remote_operation_queue_.MarkActive();
+    }
+    if (ret < 0 && ret != -EINTR && ret != -EBUSY) {
+        LOG_ERROR("io_uring_submit_and_wait failed: {}", strerror(-ret));
+        throw std::system_error{-ret, std::system_category(), "io_uring_submit_and_wait failed"};
+    }
+
+    unsigned head;
+    unsigned count = 0;
+    io_uring_cqe* cqe;
+    io_uring_for_each_cqe(&ring_, head, cqe) {
+        ++count;
+        auto data = io_uring_cqe_get_data(cqe);
+        if (data == nullptr) {
+            continue;  // completion of a cancel request
+        } else if (data == &wakeup_fd_) {
+            LOG_TRACE("wakeup event received");
+            ArmWakeup();
+        } else {
+            auto op = static_cast<CompletionBase*>(data);
+            LOG_TRACE("completion received for operation {}: {}", op->uuid, cqe->res);
+            op->result = cqe->res;
+            ScheduleLocal(op);
+        }
+    }
+    io_uring_cq_advance(&ring_, count);
+
+    LOG_TRACE("submit and wait finished, {} completions received", count);
+}
+
+void IoUringContext::Wakeup() {
+    uint64_t value = 1;
+    ssize_t n = ::write(wakeup_fd_, &value, sizeof(value));
+    if (n < 0) {
+        int err = errno;
+        LOG_ERROR("write wakeup fd failed: {}", strerror(err));
+
+        // It's fundamentally broken anyway if we cannot wake up the loop,
+        // and we also want to use noexcept on functions that call Wakeup().
+        std::terminate();
+    }
+}
+
+bool IoUringContext::IsRunningOnIOThread() const noexcept { return current_context == this; }
+
+}  // namespace fuchsia
@@ -0,0 +1,105 @@
+//
+// Created by wenjuxu on 2023/8/21.
+//
+
+#include "fuchsia/slab_allocator.h"
+
+#include <bit>
+#include <new>
+
+#include "fuchsia/logging.h"
+
+namespace fuchsia {
+
+static thread_local SlabAllocator* current_allocator = nullptr;
+
+SlabAllocator::~SlabAllocator() {
+    auto remote = remote_frees_.PopAll();
+    while (!remote.Empty()) {
+        remote.PopFront();
+    }
+    for (auto chunk : chunks_) {
+        ::operator delete(chunk);
+    }
+    LOG_TRACE("slab allocator destroyed, released {} chunks", chunks_.size());
+}
+
+SlabAllocator* SlabAllocator::Current() noexcept { return current_allocator; }
+
+SlabAllocator* SlabAllocator::SetCurrent(SlabAllocator* allocator) noexcept {
+    return std::exchange(current_allocator, allocator);
+}
+
+void* SlabAllocator::Allocate(size_t size) {
+    size_t total = size + sizeof(BlockHeader);
+    auto self = current_allocator;
+    if (self == nullptr || total > kMaxBlockSize) {
+        auto header = static_cast<BlockHeader*>(::operator new(total));
+        header->owner = nullptr;
+        header->size_class = 0;
+        return header + 1;
+    }
+    return self->AllocateLocal(SizeClassOf(total));
+}
+
+void SlabAllocator::Deallocate(void* ptr) noexcept {
+    if (ptr == nullptr) {
+        return;
+    }
+    auto header = static_cast<BlockHeader*>(ptr) - 1;
+    auto owner = header->owner;
+    if (owner == nullptr) {
+        ::operator delete(header);
+    } else if (owner == current_allocator) {
+        owner->DeallocateLocal(static_cast<FreeBlock*>(header));
+    } else {
+        owner->remote_frees_.PushFront(static_cast<FreeBlock*>(header));
+    }
+}
+
+uint32_t SlabAllocator::SizeClassOf(size_t size) noexcept {
+    if (size <= (size_t{1} << kMinBlockShift)) {
+        return 0;
+    }
+    return std::bit_width(size - 1) - kMinBlockShift;
+}
+
+void* SlabAllocator::AllocateLocal(uint32_t size_class) {
+    if (free_lists_[size_class] == nullptr) {
+        DrainRemoteFrees();
+        if (free_lists_[size_class] == nullptr) {
+            Refill(size_class);
+        }
+    }
+    auto block = free_lists_[size_class];
+    free_lists_[size_class] = block->next;
+    block->owner = this;
+    block->size_class = size_class;
+    return static_cast<BlockHeader*>(block) + 1;
+}
+
+void SlabAllocator::DeallocateLocal(FreeBlock* block) noexcept {
+    block->next = free_lists_[block->size_class];
+    free_lists_[block->size_class] = block;
+}
+
+void SlabAllocator::Refill(uint32_t size_class) {
+    size_t block_size = size_t{1} << (kMinBlockShift + size_class);
+    auto chunk = static_cast<char*>(::operator new(kChunkSize));
+    chunks_.push_back(chunk);
+    for (size_t offset = 0; offset + block_size <= kChunkSize; offset += block_size) {
+        auto block = reinterpret_cast<FreeBlock*>(chunk + offset);
+        block->size_class = size_class;
+        DeallocateLocal(block);
+    }
+    LOG_TRACE("slab allocator refilled size class {} ({} bytes)", size_class, block_size);
+}
+
+void SlabAllocator::DrainRemoteFrees() noexcept {
+    auto remote = remote_frees_.PopAll();
+    while (!remote.Empty()) {
+        DeallocateLocal(remote.PopFront());
+    }
+}
+
+}  // namespace fuchsia
@@ -0,0 +1,125 @@
+//
+// Created by wenjuxu on 2023/8/19.
+//
+
+#include "fuchsia/work_stealing_pool.h"
+
+#include <random>
+
+#include "fuchsia/logging.h"
+
+namespace fuchsia {
+
+static thread_local void* current_worker = nullptr;
+
+WorkStealingPool::WorkStealingPool(size_t num_workers) {
+    if (num_workers == 0) {
+        num_workers = 1;
+    }
+    workers_.reserve(num_workers);
+    for (size_t i = 0; i < num_workers; ++i) {
+        workers_.push_back(std::make_unique<Worker>(*this));
+    }
+    // Only start the threads once all workers exist, they steal from each other.
+    for (auto& worker : workers_) {
+        worker->thread = std::jthread([this, w = worker.get()] { Run(*w); });
+    }
+    LOG_TRACE("work stealing pool created with {} workers", num_workers);
+}
+
+WorkStealingPool::~WorkStealingPool() { Stop(); }
+
+void WorkStealingPool::Stop() noexcept {
+    if (stopped_.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    LOG_TRACE("work stealing pool stop requested");
+    epoch_.fetch_add(1, std::memory_order_release);
+    epoch_.notify_all();
+    for (auto& worker : workers_) {
+        worker->thread = {};  // join
+    }
+}
+
+void WorkStealingPool::Schedule(OperationBase* op) noexcept {
+    assert(op->execute != nullptr);
+    auto worker = static_cast<Worker*>(current_worker);
+    if (worker == nullptr || &worker->pool != this || !worker->deque.Push(op)) {
+        injection_queue_.PushFront(op);
+    }
+    Notify();
+}
+
+void WorkStealingPool::Notify() noexcept {
+    // Pairs with the fence in Run(): either a worker about to sleep sees the new work, or we see
+    // that it is about to sleep.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) > 0) {
+        epoch_.fetch_add(1, std::memory_order_release);
+        epoch_.notify_one();
+    }
+}
+
+void WorkStealingPool::Run(Worker& worker) noexcept {
+    current_worker = &worker;
+    while (true) {
+        if (auto op = FindWork(worker)) {
+            op->execute.load(std::memory_order_relaxed)(op);
+            continue;
+        }
+
+        // Announce going to sleep, then look once more, to not miss work scheduled in between.
+        auto epoch = epoch_.load(std::memory_order_acquire);
+        sleepers_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (auto op = FindWork(worker)) {
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+            op->execute.load(std::memory_order_relaxed)(op);
+            continue;
+        }
+        if (stopped_.load(std::memory_order_acquire)) {
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+            break;
+        }
+        epoch_.wait(epoch, std::memory_order_acquire);
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    current_worker = nullptr;
+}
+
+OperationBase* WorkStealingPool::FindWork(Worker& worker) noexcept {
+    if (auto op = worker.deque.Pop()) {
+        return op;
+    }
+
+    // Take the whole injection queue at once, keep what fits into the own deque for later (others
+    // may steal it from there) and put the rest back.
+    auto batch = injection_queue_.PopAll();
+    if (!batch.Empty()) {
+        auto op = batch.PopFront();
+        IntrusiveQueue<OperationBase> overflow;
+        while (!batch.Empty()) {
+            auto next = batch.PopFront();
+            if (!worker.deque.Push(next)) {
+                overflow.PushBack(next);
+            }
+        }
+        injection_queue_.PushAllFront(std::move(overflow));
+        return op;
+    }
+
+    static thread_local std::minstd_rand rng{std::random_device{}()};
+    size_t start = rng() % workers_.size();
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        auto& victim = *workers_[(start + i) % workers_.size()];
+        if (&victim == &worker) {
+            continue;
+        }
+        if (auto op = victim.deque.Steal()) {
+            return op;
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace fuchsia
@@ -0,0 +1,99 @@
+//
+// Created by wenjuxu on 2023/8/18.
+//
+
+#include <thread>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+#include "fuchsia/atomic_intrusive_queue.h"
+
+namespace {
+
+struct Node {
+    int value = 0;
+    Node* next = nullptr;
+};
+
+std::vector<int> Values(fuchsia::IntrusiveQueue<Node>&& queue) {
+    std::vector<int> result;
+    while (!queue.Empty()) {
+        result.push_back(queue.PopFront()->value);
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST_CASE("AtomicIntrusiveQueue pops items in push order", "[AtomicIntrusiveQueue]") {
+    fuchsia::AtomicIntrusiveQueue<Node> queue;
+    Node nodes[3]{{1}, {2}, {3}};
+    for (auto& node : nodes) {
+        REQUIRE_FALSE(queue.PushFront(&node));
+    }
+    REQUIRE(Values(queue.PopAll()) == std::vector<int>{1, 2, 3});
+    REQUIRE(queue.Empty());
+}
+
+TEST_CASE("AtomicIntrusiveQueue pushes a chain at once", "[AtomicIntrusiveQueue]") {
+    fuchsia::AtomicIntrusiveQueue<Node> queue;
+    Node nodes[4]{{1}, {2}, {3}, {4}};
+    queue.PushFront(&nodes[0]);
+
+    fuchsia::IntrusiveQueue<Node> chain;
+    chain.PushBack(&nodes[1]);
+    chain.PushBack(&nodes[2]);
+    REQUIRE_FALSE(queue.PushAllFront(std::move(chain)));
+    queue.PushFront(&nodes[3]);
+
+    REQUIRE(Values(queue.PopAll()) == std::vector<int>{1, 2, 3, 4});
+}
+
+TEST_CASE("AtomicIntrusiveQueue tells the first push after inactive", "[AtomicIntrusiveQueue]") {
+    fuchsia::AtomicIntrusiveQueue<Node> queue;
+    Node nodes[4]{{1}, {2}, {3}, {4}};
+
+    REQUIRE(queue.TryMarkInactive());
+    REQUIRE(queue.Empty());
+    REQUIRE(queue.PushFront(&nodes[0]));  // the one to wake up the consumer
+    REQUIRE_FALSE(queue.PushFront(&nodes[1]));
+    REQUIRE_FALSE(queue.TryMarkInactive());  // not empty
+    REQUIRE(Values(queue.PopAll()) == std::vector<int>{1, 2});
+
+    REQUIRE(queue.TryMarkInactive());
+    fuchsia::IntrusiveQueue<Node> chain;
+    chain.PushBack(&nodes[2]);
+    REQUIRE(queue.PushAllFront(std::move(chain)));
+    REQUIRE(Values(queue.PopAll()) == std::vector<int>{3});
+
+    REQUIRE(queue.TryMarkInactive());
+    queue.MarkActive();
+    REQUIRE_FALSE(queue.PushFront(&nodes[3]));
+    REQUIRE(Values(queue.PopAll()) == std::vector<int>{4});
+    REQUIRE(Values(queue.PopAll()).empty());
+}
+
+TEST_CASE("AtomicIntrusiveQueue wakes up the consumer exactly once", "[AtomicIntrusiveQueue]") {
+    static constexpr int kProducers = 4;
+    static constexpr int kItemsPerProducer = 10000;
+
+    fuchsia::AtomicIntrusiveQueue<Node> queue;
+    std::vector<Node> nodes(kProducers * kItemsPerProducer);
+    std::atomic<int> wakeups = 0;
+
+    REQUIRE(queue.TryMarkInactive());
+    {
+        std::vector<std::jthread> producers;
+        for (int i = 0; i < kProducers; ++i) {
+            producers.emplace_back([&, i] {
+                for (int n = 0; n < kItemsPerProducer; ++n) {
+                    if (queue.PushFront(&nodes[i * kItemsPerProducer + n])) {
+                        ++wakeups;
+                    }
+                }
+            });
+        }
+    }
+    REQUIRE(wakeups == 1);
+    REQUIRE(Values(queue.PopAll()).size() == nodes.size());
+}
@@ -0,0 +1,70 @@
+//
+// Created by wenjuxu on 2023/9/5.
+//
+
+#include "fuchsia/dynamic_buffer.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+
+#include "catch2/catch_test_macros.hpp"
+
+namespace {
+
+void Append(fuchsia::DynamicBuffer& buf, std::string_view text) {
+    auto space = buf.Prepare(text.size());
+    std::memcpy(space.Data(), text.data(), text.size());
+    buf.Commit(text.size());
+}
+
+}  // namespace
+
+TEST_CASE("DynamicBuffer prepares, commits and consumes", "[DynamicBuffer]") {
+    fuchsia::DynamicBuffer buf;
+    REQUIRE(buf.Empty());
+    REQUIRE(buf.ReadSize() == fuchsia::DynamicBuffer::kMinReadSize);
+
+    Append(buf, "GET / HTTP/1.1\r\n");
+    Append(buf, "\r\nnext");
+    REQUIRE(buf.View() == "GET / HTTP/1.1\r\n\r\nnext");
+    REQUIRE(buf.Data().Size() == buf.Size());
+
+    buf.Consume(18);
+    REQUIRE(buf.View() == "next");
+    buf.Consume(100);
+    REQUIRE(buf.Empty());
+
+    // A prepared but uncommitted space is not readable.
+    buf.Prepare(8);
+    buf.Commit(0);
+    REQUIRE(buf.Empty());
+}
+
+TEST_CASE("DynamicBuffer moves the readable bytes to the front before growing",
+          "[DynamicBuffer]") {
+    fuchsia::DynamicBuffer buf;
+    Append(buf, std::string(4000, 'a'));
+    size_t capacity = buf.Capacity();
+    buf.Consume(3990);
+    Append(buf, std::string(capacity - 20, 'b'));
+    REQUIRE(buf.Capacity() == capacity);  // compacted
+    REQUIRE(buf.View().substr(0, 11) == "aaaaaaaaaab");
+
+    Append(buf, std::string(100, 'c'));
+    REQUIRE(buf.Capacity() >= 2 * capacity);  // grown
+    REQUIRE(buf.Size() == capacity + 90);
+    REQUIRE(buf.View().substr(0, 10) == "aaaaaaaaaa");
+    REQUIRE(buf.View().back() == 'c');
+}
+
+TEST_CASE("DynamicBuffer stays within its max size", "[DynamicBuffer]") {
+    fuchsia::DynamicBuffer buf{100};
+    REQUIRE(buf.ReadSize() == 100);
+    Append(buf, std::string(60, 'a'));
+    REQUIRE(buf.ReadSize() == 40);
+    REQUIRE_THROWS_AS(buf.Prepare(41), std::length_error);
+    Append(buf, std::string(40, 'b'));
+    REQUIRE(buf.ReadSize() == 0);
+    REQUIRE(buf.Capacity() == 100);
+}
@@ -128,3 +128,22 @@ TEST_CASE("EpollContext scheduler can cancel timers", "[EpollContext]") {
 
     REQUIRE(counter == 100);
 }
+
+TEST_CASE("EpollContext operation budget keeps timers going under load", "[EpollContext]") {
+    fuchsia::EpollContext context{{.max_operations_per_iteration = 2}};
+    std::jthread thread([&]() { context.Run(); });
+    fuchsia::ScopeGuard guard{[&]() noexcept { context.Stop(); }};
+
+    stdexec::scheduler auto scheduler = context.GetScheduler();
+    auto spin = [&] {
+        // reschedules itself forever, until it is stopped
+        return exec::repeat_effect_until(stdexec::schedule(scheduler) |
+                                         stdexec::then([] { return false; }));
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    stdexec::sync_wait(exec::when_any(stdexec::when_all(spin(), spin(), spin(), spin()),
+                                      exec::schedule_after(scheduler, 10ms)));
+    REQUIRE(std::chrono::steady_clock::now() - start < 1s);
+    REQUIRE(context.GetMetrics().budget_exhausted.load() > 0);
+}
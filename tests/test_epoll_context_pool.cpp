@@ -0,0 +1,40 @@
+//
+// Created by wenjuxu on 2023/8/12.
+//
+
+#include <set>
+
+#include "catch2/catch_test_macros.hpp"
+#include "fuchsia/epoll_context_pool.h"
+
+TEST_CASE("EpollContextPool should be able to start and stop", "[EpollContextPool]") {
+    fuchsia::EpollContextPool pool(4);
+    REQUIRE(pool.Size() == 4);
+    pool.Start();
+    pool.Stop();
+}
+
+TEST_CASE("EpollContextPool runs each context on its own thread", "[EpollContextPool]") {
+    fuchsia::EpollContextPool pool(4);
+    pool.Start();
+
+    std::set<std::thread::id> thread_ids;
+    for (size_t i = 0; i < pool.Size(); ++i) {
+        auto [id] = stdexec::sync_wait(stdexec::schedule(pool.At(i).GetScheduler()) |
+                                       stdexec::then([] { return std::this_thread::get_id(); }))
+                        .value();
+        thread_ids.insert(id);
+    }
+    REQUIRE(thread_ids.size() == 4);
+    REQUIRE(thread_ids.count(std::this_thread::get_id()) == 0);
+}
+
+TEST_CASE("EpollContextPool picks contexts in round-robin order", "[EpollContextPool]") {
+    fuchsia::EpollContextPool pool(3);
+    auto& c0 = pool.Next();
+    auto& c1 = pool.Next();
+    auto& c2 = pool.Next();
+    REQUIRE(&c0 != &c1);
+    REQUIRE(&c1 != &c2);
+    REQUIRE(&pool.Next() == &c0);
+}
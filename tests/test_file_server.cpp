@@ -0,0 +1,165 @@
+//
+// Created by wenjuxu on 2023/9/2.
+//
+
+#include "fuchsia/http/file_server.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <ctime>
+#include <string>
+
+#include "catch2/catch_test_macros.hpp"
+#include "test_util.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Serve the request `raw` into `resp`.
+void Serve(fuchsia::http::FileServer& files, const std::string& raw,
+           fuchsia::http::Response& resp) {
+    fuchsia::http::Request req;
+    REQUIRE(req.Parse(raw.data(), raw.size()) == fuchsia::http::ParseResult::Ok);
+    resp.Reset();
+    stdexec::sync_wait(files.Serve(req, resp));
+}
+
+std::string Get(std::string_view target, std::string_view headers = {}) {
+    std::string raw{"GET "};
+    raw.append(target).append(" HTTP/1.1\r\nHost: test\r\n").append(headers).append("\r\n");
+    return raw;
+}
+
+}  // namespace
+
+TEST_CASE("FileServer sends files below its root", "[FileServer]") {
+    fuchsia::test::TempDir dir;
+    dir.Write("css/main.css", "body {}");
+    dir.Write("index.html", "<html></html>");
+    fuchsia::http::FileServer files{dir.Path(), "/static/"};
+    fuchsia::http::Response resp;
+
+    Serve(files, Get("/static/css/main.css?v=1"), resp);
+    REQUIRE(resp.StatusCode() == fuchsia::http::StatusCode::Ok);
+    REQUIRE(resp.Header("Content-Type") == "text/css; charset=utf-8");
+    REQUIRE_FALSE(resp.Header("ETag").empty());
+    REQUIRE(resp.HasFileBody());
+    REQUIRE(resp.FileBody().size == 7);
+    char content[16]{};
+    REQUIRE(::pread(resp.FileBody().fd, content, sizeof(content), 0) == 7);
+    REQUIRE(std::string_view{content} == "body {}");
+    REQUIRE(resp.KeepAlive());
+
+    std::string head;
+    resp.AppendTo(head);
+    REQUIRE(head.find("Content-Length: 7\r\n") != std::string::npos);
+
+    Serve(files, Get("/static/"), resp);
+    REQUIRE(resp.StatusCode() == fuchsia::http::StatusCode::Ok);
+    REQUIRE(resp.FileBody().size == 13);
+
+    Serve(files, Get("/static/missing.css"), resp);
+    REQUIRE(resp.StatusCode() == fuchsia::http::StatusCode::NotFound);
+    Serve(files, Get("/static/css"), resp);  // a directory
+    REQUIRE(resp.StatusCode() == fuchsia::http::StatusCode::NotFound);
+    REQUIRE(::mkfifo((dir.Path() + "/pipe").c_str(), 0600) == 0);
+    Serve(files, Get("/static/pipe"), resp);  // without waiting for a writer
+    REQUIRE(resp.StatusCode() == fuchsia::http::StatusCode::NotFound);
+    Serve(files, Get("/static/css/../../etc/passwd"), resp);
+    REQUIRE(resp.StatusCode() == fuchsia::http::StatusCode::Forbidden);
+    Serve(files, "POST /static/index.html HTTP/1.1\r\nContent-Length: 0\r\n\r\n", resp);
+    REQUIRE(resp.StatusCode() == fuchsia::http::StatusCode::MethodNotAllowed);
+
+    REQUIRE(files.OpenFiles() == 2);
+}
+
+TEST_CASE("FileServer answers conditional requests with 304", "[FileServer]") {
+    fuchsia::test::TempDir dir;
+    dir.Write("app.js", "let x = 1;");
+    fuchsia::http::FileServer files{dir.Path()};
+    fuchsia::http::Response resp;
+
+    Serve(files, Get("/app.js"), resp);
+    std::string etag{resp.Header("ETag")};
+    std::string last_modified{resp.Header("Last-Modified")};
+
+    Serve(files, Get("/app.js", "If-None-Match: \"other\", " + etag + "\r\n"), resp);
+    REQUIRE(resp.StatusCode() == fuchsia::http::StatusCode::NotModified);
+    REQUIRE_FALSE(resp.HasFileBody());
+    REQUIRE(resp.Header("ETag") == etag);
+
+    Serve(files, Get("/app.js", "If-Modified-Since: " + last_modified + "\r\n"), resp);
+    REQUIRE(resp.StatusCode() == fuchsia::http::StatusCode::NotModified);
+
+    Serve(files, Get("/app.js", "If-None-Match: \"other\"\r\n"), resp);
+    REQUIRE(resp.StatusCode() == fuchsia::http::StatusCode::Ok);
+    REQUIRE(resp.HasFileBody());
+
+    // Dates are compared as dates, in any of the formats clients may send.
+    auto mtime = fuchsia::http::ParseHttpDate(last_modified);
+    REQUIRE(mtime.has_value());
+    auto since = [](std::time_t time) {
+        char date[32];
+        return "If-Modified-Since: " + std::string{fuchsia::http::FormatHttpDate(date, time)} +
+               "\r\n";
+    };
+    Serve(files, Get("/app.js", since(*mtime + 3600)), resp);
+    REQUIRE(resp.StatusCode() == fuchsia::http::StatusCode::NotModified);
+    Serve(files, Get("/app.js", since(*mtime - 1)), resp);
+    REQUIRE(resp.StatusCode() == fuchsia::http::StatusCode::Ok);
+    char date[32];
+    std::tm tm{};
+    ::gmtime_r(&*mtime, &tm);
+    std::string asctime{date, std::strftime(date, sizeof(date), "%a %b %e %H:%M:%S %Y", &tm)};
+    Serve(files, Get("/app.js", "If-Modified-Since: " + asctime + "\r\n"), resp);
+    REQUIRE(resp.StatusCode() == fuchsia::http::StatusCode::NotModified);
+    Serve(files, Get("/app.js", "If-Modified-Since: yesterday\r\n"), resp);
+    REQUIRE(resp.StatusCode() == fuchsia::http::StatusCode::Ok);
+}
+
+TEST_CASE("FileServer sends a Content-Length without a body to send", "[FileServer]") {
+    fuchsia::test::TempDir dir;
+    dir.Write("app.js", "let x = 1;");
+    dir.Write("empty.txt", "");
+    fuchsia::http::FileServer files{dir.Path()};
+    fuchsia::http::Response resp;
+
+    Serve(files, "HEAD /app.js HTTP/1.1\r\nHost: test\r\n\r\n", resp);
+    REQUIRE(resp.StatusCode() == fuchsia::http::StatusCode::Ok);
+    REQUIRE_FALSE(resp.HasFileBody());
+    std::string head;
+    resp.AppendTo(head);
+    REQUIRE(head.find("Content-Length: 10\r\n") != std::string::npos);
+    REQUIRE(head.find("Content-Length", head.find("Content-Length") + 1) == std::string::npos);
+
+    Serve(files, Get("/empty.txt"), resp);
+    REQUIRE(resp.StatusCode() == fuchsia::http::StatusCode::Ok);
+    REQUIRE_FALSE(resp.HasFileBody());
+    REQUIRE(resp.Header("Content-Length") == "0");
+}
+
+TEST_CASE("FileServer revalidates and evicts cached files", "[FileServer]") {
+    fuchsia::test::TempDir dir;
+    dir.Write("a.txt", "a");
+    dir.Write("b.txt", "b");
+    fuchsia::http::FileServer files{dir.Path(), "/",
+                                    {.max_open_files = 1, .revalidate_interval = 0ms}};
+    fuchsia::http::Response resp;
+
+    Serve(files, Get("/a.txt"), resp);
+    std::string etag{resp.Header("ETag")};
+    dir.Write("a.txt", "changed");
+    Serve(files, Get("/a.txt", "If-None-Match: " + etag + "\r\n"), resp);
+    REQUIRE(resp.StatusCode() == fuchsia::http::StatusCode::Ok);
+    REQUIRE(resp.FileBody().size == 7);
+
+    // A response still sending the evicted file holds it open.
+    auto body = resp.FileBody();
+    Serve(files, Get("/b.txt"), resp);
+    REQUIRE(files.OpenFiles() == 1);
+    char content[8]{};
+    REQUIRE(::pread(body.fd, content, sizeof(content), 0) == 7);
+    REQUIRE(std::string_view{content, 7} == "changed");
+}
@@ -0,0 +1,188 @@
+//
+// Created by wenjuxu on 2023/8/29.
+//
+
+#include "fuchsia/http/client.h"
+
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+#include "exec/async_scope.hpp"
+#include "exec/when_any.hpp"
+#include "fuchsia/epoll_context.h"
+#include "fuchsia/http/mux.h"
+#include "fuchsia/http/session.h"
+#include "fuchsia/net/tcp.h"
+#include "fuchsia/socket_accept_op.h"
+#include "test_util.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// A server on the loopback interface counting the connections it accepts. Everything, including
+// the client under test, runs on the thread of the context.
+class TestServer {
+public:
+    TestServer(fuchsia::EpollContext& context, fuchsia::http::SessionOptions session_options)
+        : context_(context),
+          acceptor_(context,
+                    fuchsia::net::Tcp::Endpoint{fuchsia::net::AddressV4::Loopback(), 0}),
+          session_options_(session_options) {
+        mux_.HandleFunc("/", [](const fuchsia::http::Request& req,
+                                fuchsia::http::Response& resp) -> exec::task<void> {
+            resp.SetKeepAlive(req.Url() != "/close");
+            resp.WriteBody(req.Body().empty() ? std::string_view{"hello"} : req.Body());
+            co_return;
+        });
+    }
+
+    fuchsia::net::Tcp::Endpoint Endpoint() const {
+        ::sockaddr_storage addr{};
+        ::socklen_t len = sizeof(addr);
+        ::getsockname(acceptor_.Fd(), reinterpret_cast<::sockaddr*>(&addr), &len);
+        return fuchsia::net::Tcp::Endpoint{reinterpret_cast<::sockaddr*>(&addr)};
+    }
+
+    // Accept until stopped.
+    exec::task<void> Serve() {
+        while (true) {
+            auto socket = co_await fuchsia::AsyncAccept(acceptor_);
+            ++accepted;
+            auto session = fuchsia::http::MakeSession(std::move(socket), session_mgr_,
+                                                      fuchsia::http::MuxRef{mux_},
+                                                      session_options_);
+            scope_.spawn(stdexec::on(context_.GetScheduler(), session_mgr_.Start(session)));
+        }
+    }
+
+    // Wait for the sessions to end, once the client is gone and has closed its connections.
+    exec::task<void> Shutdown() { co_await scope_.on_empty(); }
+
+    size_t accepted = 0;
+
+private:
+    fuchsia::EpollContext& context_;
+    fuchsia::net::Tcp::Acceptor acceptor_;
+    fuchsia::http::SessionOptions session_options_;
+    fuchsia::http::ServeMux mux_;
+    fuchsia::http::SessionMgr session_mgr_;
+    exec::async_scope scope_;
+};
+
+struct Result {
+    fuchsia::http::StatusCode status;
+    std::string body;
+};
+
+}  // namespace
+
+TEST_CASE("Client reuses keep-alive connections", "[Client]") {
+    fuchsia::EpollContext context;
+    TestServer server{context, {}};
+    fuchsia::test::RunningContext running{context};
+    auto endpoint = server.Endpoint();
+
+    std::vector<Result> results;
+    size_t idle_after_close = 0;
+    auto run_client = [&]() -> exec::task<void> {
+        fuchsia::http::Client client{context};
+        fuchsia::http::ClientResponse response;
+        fuchsia::http::ClientRequest request;
+        for (int i = 0; i < 10; ++i) {
+            co_await client.Send(endpoint, request, response);
+            results.push_back({response.StatusCode(), std::string{response.Body()}});
+        }
+        request.method = "POST";
+        request.body = "echo";
+        co_await client.Send(endpoint, request, response);
+        results.push_back({response.StatusCode(), std::string{response.Body()}});
+
+        fuchsia::http::ClientRequest close{.target = "/close"};
+        co_await client.Send(endpoint, close, response);
+        results.push_back({response.StatusCode(), std::string{response.Body()}});
+        idle_after_close = client.IdleConnections(endpoint);
+
+        co_await client.Send(endpoint, request, response);
+        results.push_back({response.StatusCode(), std::string{response.Body()}});
+    };
+    stdexec::sync_wait(stdexec::on(context.GetScheduler(),
+                                   exec::when_any(server.Serve(), run_client())));
+    stdexec::sync_wait(stdexec::on(context.GetScheduler(), server.Shutdown()));
+
+    REQUIRE(results.size() == 13);
+    for (size_t i = 0; i < 10; ++i) {
+        REQUIRE(results[i].status == fuchsia::http::StatusCode::Ok);
+        REQUIRE(results[i].body == "hello");
+    }
+    REQUIRE(results[10].body == "echo");
+    REQUIRE(results[11].body == "hello");
+    REQUIRE(idle_after_close == 0);
+    REQUIRE(results[12].body == "echo");
+    // One connection until /close, then a new one.
+    REQUIRE(server.accepted == 2);
+}
+
+TEST_CASE("Client retries when the server closed the pooled connection", "[Client]") {
+    fuchsia::EpollContext context;
+    TestServer server{context, {.idle_timeout = 20ms}};
+    fuchsia::test::RunningContext running{context};
+    auto endpoint = server.Endpoint();
+
+    std::vector<Result> results;
+    auto run_client = [&]() -> exec::task<void> {
+        fuchsia::http::Client client{context};
+        fuchsia::http::ClientResponse response;
+        fuchsia::http::ClientRequest request;
+        co_await client.Send(endpoint, request, response);
+        results.push_back({response.StatusCode(), std::string{response.Body()}});
+        co_await exec::schedule_after(context.GetScheduler(), 100ms);  // the server hangs up
+        co_await client.Send(endpoint, request, response);
+        results.push_back({response.StatusCode(), std::string{response.Body()}});
+    };
+    stdexec::sync_wait(stdexec::on(context.GetScheduler(),
+                                   exec::when_any(server.Serve(), run_client())));
+    stdexec::sync_wait(stdexec::on(context.GetScheduler(), server.Shutdown()));
+
+    REQUIRE(results.size() == 2);
+    REQUIRE(results[1].status == fuchsia::http::StatusCode::Ok);
+    REQUIRE(results[1].body == "hello");
+    REQUIRE(server.accepted == 2);
+}
+
+TEST_CASE("Client does not retry a POST the server may have seen", "[Client]") {
+    fuchsia::EpollContext context;
+    TestServer server{context, {.idle_timeout = 20ms}};
+    fuchsia::test::RunningContext running{context};
+    auto endpoint = server.Endpoint();
+
+    std::vector<Result> results;
+    bool post_failed = false;
+    auto run_client = [&]() -> exec::task<void> {
+        fuchsia::http::Client client{context};
+        fuchsia::http::ClientResponse response;
+        fuchsia::http::ClientRequest request;
+        co_await client.Send(endpoint, request, response);
+        results.push_back({response.StatusCode(), std::string{response.Body()}});
+        co_await exec::schedule_after(context.GetScheduler(), 100ms);  // the server hangs up
+
+        fuchsia::http::ClientRequest post{.method = "POST", .body = "echo"};
+        try {
+            co_await client.Send(endpoint, post, response);
+        } catch (const std::system_error&) {
+            post_failed = true;
+        }
+        co_await client.Send(endpoint, post, response);  // a new connection
+        results.push_back({response.StatusCode(), std::string{response.Body()}});
+    };
+    stdexec::sync_wait(stdexec::on(context.GetScheduler(),
+                                   exec::when_any(server.Serve(), run_client())));
+    stdexec::sync_wait(stdexec::on(context.GetScheduler(), server.Shutdown()));
+
+    REQUIRE(post_failed);
+    REQUIRE(results.size() == 2);
+    REQUIRE(results[1].body == "echo");
+    REQUIRE(server.accepted == 2);
+}
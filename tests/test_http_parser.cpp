@@ -0,0 +1,83 @@
+//
+// Created by wenjuxu on 2023/8/22.
+//
+
+#include <cstring>
+
+#include "catch2/catch_test_macros.hpp"
+#include "fuchsia/http/message.h"
+
+TEST_CASE("A request received in one piece is parsed in place", "[Parser]") {
+    std::string data = "GET /index.html HTTP/1.1\r\nHost: example.com\r\nX-Id: 42\r\n\r\n";
+    fuchsia::http::Request request;
+    REQUIRE(request.Parse(data.data(), data.size()) == fuchsia::http::ParseResult::Ok);
+    REQUIRE(request.Method() == "GET");
+    REQUIRE(request.Url() == "/index.html");
+    REQUIRE(request.Header("Host") == "example.com");
+    REQUIRE(request.Header("X-Id") == "42");
+    REQUIRE(request.Headers().size() == 2);
+
+    auto in_data = [&](std::string_view view) {
+        return view.data() >= data.data() && view.data() + view.size() <= data.data() + data.size();
+    };
+    REQUIRE(in_data(request.Url()));
+    REQUIRE(in_data(request.Header("Host")));
+}
+
+TEST_CASE("A request split over several reads survives the reuse of the buffer", "[Parser]") {
+    std::string_view message =
+        "POST /upload HTTP/1.1\r\nContent-Type: text/plain\r\nContent-Length: 11\r\n\r\n"
+        "hello world";
+    fuchsia::http::Request request;
+    // Feed it in small pieces through one buffer, every token ends up split somewhere.
+    char buffer[7];
+    auto result = fuchsia::http::ParseResult::Incomplete;
+    for (size_t offset = 0; offset < message.size(); offset += sizeof(buffer)) {
+        size_t len = std::min(sizeof(buffer), message.size() - offset);
+        std::memcpy(buffer, message.data() + offset, len);
+        result = request.Parse(buffer, len);
+        if (result != fuchsia::http::ParseResult::Ok) {
+            std::memset(buffer, 'x', sizeof(buffer));
+        }
+    }
+    REQUIRE(result == fuchsia::http::ParseResult::Ok);
+    REQUIRE(request.Method() == "POST");
+    REQUIRE(request.Url() == "/upload");
+    REQUIRE(request.Header("Content-Type") == "text/plain");
+    REQUIRE(request.Header("Content-Length") == "11");
+    REQUIRE(request.Body() == "hello world");
+}
+
+TEST_CASE("Chunks of a body are joined", "[Parser]") {
+    std::string data =
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+        "5\r\nhello\r\n1\r\n \r\n5\r\nworld\r\n0\r\n\r\n";
+    fuchsia::http::Request request;
+    REQUIRE(request.Parse(data.data(), data.size()) == fuchsia::http::ParseResult::Ok);
+    REQUIRE(request.Body() == "hello world");
+
+    request.Reset();
+    REQUIRE(request.Body().empty());
+    REQUIRE(request.Headers().empty());
+}
+
+TEST_CASE("Pipelined requests are parsed one at a time", "[Parser]") {
+    std::string data =
+        "GET /a HTTP/1.1\r\nHost: x\r\n\r\n"
+        "GET /b HTTP/1.1\r\nHost: x\r\n\r\n"
+        "GET /c HT";
+    fuchsia::http::Request request;
+    size_t offset = 0;
+    for (auto url : {"/a", "/b"}) {
+        REQUIRE(request.Parse(data.data() + offset, data.size() - offset) ==
+                fuchsia::http::ParseResult::Ok);
+        REQUIRE(request.Url() == url);
+        REQUIRE(request.Consumed() == 28);
+        offset += request.Consumed();
+        request.Reset();
+    }
+    REQUIRE(request.Parse(data.data() + offset, data.size() - offset) ==
+            fuchsia::http::ParseResult::Incomplete);
+    REQUIRE(request.Consumed() == data.size() - offset);
+    REQUIRE(request.Url() == "/c");
+}
@@ -0,0 +1,174 @@
+//
+// Created by wenjuxu on 2023/9/7.
+//
+
+#include <cstdint>
+#include <ctime>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "catch2/catch_test_macros.hpp"
+#include "fuchsia/http/message.h"
+
+namespace {
+
+using fuchsia::http::StatusCode;
+
+// Renders `resp` into one string, the way it goes out on the wire.
+std::string Render(fuchsia::http::Response& resp) {
+    std::string out;
+    for (const auto& buffer : resp.ToBuffers()) {
+        out.append(static_cast<const char*>(buffer.Data()), buffer.Size());
+    }
+    return out;
+}
+
+// Installs `cache` on the calling thread for the scope, and puts back the previous one.
+class CurrentDateCache {
+public:
+    explicit CurrentDateCache(fuchsia::http::DateCache* cache)
+        : previous_(fuchsia::http::DateCache::SetCurrent(cache)) {}
+
+    ~CurrentDateCache() { fuchsia::http::DateCache::SetCurrent(previous_); }
+
+private:
+    fuchsia::http::DateCache* previous_;
+};
+
+}  // namespace
+
+TEST_CASE("Status lines are whole lines of the status table", "[Response]") {
+    REQUIRE(fuchsia::http::StatusLine(StatusCode::Ok) == "HTTP/1.1 200 OK\r\n");
+    REQUIRE(fuchsia::http::StatusLine(StatusCode::NotFound) == "HTTP/1.1 404 Not Found\r\n");
+    REQUIRE(fuchsia::http::StatusLine(StatusCode::NetworkAuthenticationRequired) ==
+            "HTTP/1.1 511 Network Authentication Required\r\n");
+    // A code that is not in the table goes out as an internal error rather than as garbage.
+    REQUIRE(fuchsia::http::StatusLine(static_cast<StatusCode>(299)) ==
+            "HTTP/1.1 500 Internal Server Error\r\n");
+}
+
+TEST_CASE("FormatDecimal formats at the end of the buffer", "[Response]") {
+    char digits[20];
+    REQUIRE(fuchsia::http::FormatDecimal(digits, 0) == "0");
+    REQUIRE(fuchsia::http::FormatDecimal(digits, 7) == "7");
+    REQUIRE(fuchsia::http::FormatDecimal(digits, 10) == "10");
+    REQUIRE(fuchsia::http::FormatDecimal(digits, 1234567890) == "1234567890");
+
+    auto max = fuchsia::http::FormatDecimal(digits, std::numeric_limits<uint64_t>::max());
+    REQUIRE(max == "18446744073709551615");
+    REQUIRE(max.data() == digits);  // all 20 characters of the buffer
+
+    auto one = fuchsia::http::FormatDecimal(digits, 1);
+    REQUIRE(one.data() + one.size() == digits + sizeof(digits));
+}
+
+TEST_CASE("Response heads get a Content-Type only if none was added", "[Response]") {
+    fuchsia::http::Response resp;
+    resp.SetStatusCode(StatusCode::Ok);
+    resp.WriteBody("hello");
+    REQUIRE(Render(resp) ==
+            "HTTP/1.1 200 OK\r\nContent-Length: 5\r\nContent-Type: text/plain\r\n"
+            "Connection: close\r\n\r\nhello");
+
+    resp.Reset();
+    resp.SetStatusCode(StatusCode::Ok);
+    resp.SetKeepAlive(true);
+    resp.AddHeader("Content-Type", "application/json");
+    resp.WriteBody("{}");
+    REQUIRE(Render(resp) ==
+            "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: 2\r\n"
+            "Connection: keep-alive\r\n\r\n{}");
+
+    // Reset() forgets the Content-Type as well as the headers.
+    resp.Reset();
+    resp.SetStatusCode(StatusCode::Ok);
+    resp.SetFileBody({.fd = 0, .size = 0});
+    REQUIRE(Render(resp) ==
+            "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n"
+            "Content-Type: application/octet-stream\r\nConnection: close\r\n\r\n");
+
+    // Other headers do not count.
+    resp.Reset();
+    resp.SetStatusCode(StatusCode::NotFound);
+    resp.AddHeader("Content-Encoding", "gzip");
+    resp.WriteBody("x");
+    REQUIRE(Render(resp) ==
+            "HTTP/1.1 404 Not Found\r\nContent-Encoding: gzip\r\nContent-Length: 1\r\n"
+            "Content-Type: text/plain\r\nConnection: close\r\n\r\nx");
+}
+
+TEST_CASE("StaticResponse is rendered once and sent as a single buffer", "[Response]") {
+    static const fuchsia::http::StaticResponse kHealthy{
+        StatusCode::Ok, "ok", {{"Content-Type", "text/html"}}};
+    REQUIRE(kHealthy.Data() ==
+            "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nContent-Length: 2\r\n"
+            "Connection: keep-alive\r\n\r\nok");
+    REQUIRE(kHealthy.KeepAlive());
+
+    // Without a Date header even where the thread has a cache.
+    fuchsia::http::DateCache cache;
+    CurrentDateCache current{&cache};
+    fuchsia::http::Response resp;
+    resp.SetStatusCode(StatusCode::NotFound);
+    resp.WriteBody("ignored");
+    resp.SetStaticResponse(kHealthy);
+    REQUIRE(resp.KeepAlive());
+
+    auto buffers = resp.ToBuffers();
+    REQUIRE(buffers[0].Data() == kHealthy.Data().data());  // not copied
+    REQUIRE(buffers[0].Size() == kHealthy.Data().size());
+    REQUIRE(buffers[1].Size() == 0);
+
+    std::string out = "before";
+    resp.AppendTo(out);
+    REQUIRE(out == "before" + std::string(kHealthy.Data()));
+
+    const fuchsia::http::StaticResponse closing{StatusCode::ServiceUnavailable, "", {}, false};
+    REQUIRE(closing.Data() == "HTTP/1.1 503 Service Unavailable\r\nConnection: close\r\n\r\n");
+    resp.SetStaticResponse(closing);
+    REQUIRE_FALSE(resp.KeepAlive());
+}
+
+TEST_CASE("DateCache formats the Date header line of now", "[DateCache]") {
+    std::time_t before = std::time(nullptr);
+    fuchsia::http::DateCache cache;
+    std::time_t after = std::time(nullptr);
+
+    // e.g. `Date: Sat, 26 Aug 2023 08:49:37 GMT\r\n`
+    auto header = cache.Header();
+    REQUIRE(header.size() == 37);
+    REQUIRE(header.starts_with("Date: "));
+    REQUIRE(header.ends_with(" GMT\r\n"));
+
+    char expected[32];
+    auto date = header.substr(6, header.size() - 6 - 2);
+    REQUIRE((date == fuchsia::http::FormatHttpDate(expected, before) ||
+             date == fuchsia::http::FormatHttpDate(expected, after)));
+}
+
+TEST_CASE("DateCache is installed per thread", "[DateCache]") {
+    REQUIRE(fuchsia::http::DateCache::Current() == nullptr);
+
+    fuchsia::http::DateCache cache;
+    {
+        CurrentDateCache current{&cache};
+        REQUIRE(fuchsia::http::DateCache::Current() == &cache);
+
+        fuchsia::http::DateCache* other = &cache;
+        std::thread{[&other]() { other = fuchsia::http::DateCache::Current(); }}.join();
+        REQUIRE(other == nullptr);
+
+        // Responses rendered here carry the date right after the status line.
+        fuchsia::http::Response resp;
+        resp.SetStatusCode(StatusCode::NoContent);
+        REQUIRE(Render(resp) == "HTTP/1.1 204 No Content\r\n" + std::string(cache.Header()) +
+                                    "Connection: close\r\n\r\n");
+    }
+    REQUIRE(fuchsia::http::DateCache::Current() == nullptr);
+
+    fuchsia::http::Response resp;
+    resp.SetStatusCode(StatusCode::NoContent);
+    REQUIRE(Render(resp) == "HTTP/1.1 204 No Content\r\nConnection: close\r\n\r\n");
+}
@@ -0,0 +1,93 @@
+//
+// Created by wenjuxu on 2023/9/4.
+//
+
+#include "fuchsia/io_buf.h"
+
+#include <cstring>
+#include <string>
+
+#include "catch2/catch_test_macros.hpp"
+#include "fuchsia/buffer_sequence_adapter.h"
+
+static_assert(fuchsia::MutableBufferSequence<fuchsia::IOBufChain>);
+static_assert(fuchsia::ConstBufferSequence<fuchsia::IOBufChain>);
+
+namespace {
+
+fuchsia::IOBuf Filled(std::string_view text, size_t capacity = 64) {
+    auto buf = fuchsia::IOBuf::Create(capacity);
+    auto tail = buf.Tail();
+    std::memcpy(tail.Data(), text.data(), text.size());
+    buf.Commit(text.size());
+    return buf;
+}
+
+}  // namespace
+
+TEST_CASE("IOBuf copies and slices share the block", "[IOBuf]") {
+    auto buf = Filled("hello world");
+    REQUIRE(buf.View() == "hello world");
+    REQUIRE_FALSE(buf.IsShared());
+    REQUIRE(buf.Tail().Size() == 64 - 11);
+
+    auto world = buf.Slice(6, 100);
+    REQUIRE(world.View() == "world");
+    REQUIRE(world.Data() == buf.Data() + 6);
+    REQUIRE(buf.IsShared());
+    REQUIRE(buf.Tail().Size() == 0);  // read-only while shared
+
+    {
+        auto copy = buf;
+        copy.TrimStart(1);
+        copy.TrimEnd(1);
+        REQUIRE(copy.View() == "ello worl");
+    }
+    buf = fuchsia::IOBuf{};  // the slice keeps the block alive
+    REQUIRE_FALSE(world.IsShared());
+    REQUIRE(world.View() == "world");
+
+    auto copied = fuchsia::IOBuf::CopyOf(fuchsia::Buffer(std::string_view{"abc"}));
+    REQUIRE(copied.View() == "abc");
+    REQUIRE(copied.Tail().Size() == 0);
+}
+
+TEST_CASE("IOBufChain splits and trims without copying", "[IOBufChain]") {
+    fuchsia::IOBufChain chain;
+    chain.Append(Filled("GET / HTTP/1.1\r\n"));
+    chain.Append(fuchsia::IOBuf{});  // dropped
+    chain.Append(Filled("Host: a\r\n\r\nbody"));
+    REQUIRE(chain.Count() == 2);
+    REQUIRE(chain.Size() == 31);
+    REQUIRE(chain.ToString() == "GET / HTTP/1.1\r\nHost: a\r\n\r\nbody");
+
+    auto head = chain.Split(27);
+    REQUIRE(head.ToString() == "GET / HTTP/1.1\r\nHost: a\r\n\r\n");
+    REQUIRE(head.Count() == 2);
+    REQUIRE(chain.ToString() == "body");
+    REQUIRE(chain.Front().Data() == head.Back().Data() + head.Back().Size());
+
+    char out[8]{};
+    REQUIRE(head.CopyTo(out, 4, 14) == 4);
+    REQUIRE(std::string_view{out, 4} == "\r\nHo");
+
+    head.TrimStart(16);
+    REQUIRE(head.Count() == 1);
+    REQUIRE(head.ToString() == "Host: a\r\n\r\n");
+    head.Append(std::move(chain));
+    REQUIRE(chain.Empty());
+    REQUIRE(head.ToString() == "Host: a\r\n\r\nbody");
+}
+
+TEST_CASE("IOBufChain plugs into BufferSequenceAdapter", "[IOBufChain]") {
+    fuchsia::IOBufChain chain;
+    chain.Append(Filled("abc"));
+    chain.Append(Filled("defg"));
+    fuchsia::BufferSequenceAdapter<fuchsia::ConstBuffer, fuchsia::IOBufChain> adapter{chain};
+    REQUIRE(adapter.Count() == 2);
+    REQUIRE(adapter.TotalSize() == 7);
+    REQUIRE(adapter.Buffers()[1].iov_base == chain.Back().Data());
+    adapter.Advance(4);
+    REQUIRE(adapter.Count() == 1);
+    REQUIRE(static_cast<const char*>(adapter.Buffers()[0].iov_base) == chain.Back().Data() + 1);
+}
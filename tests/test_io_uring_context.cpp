@@ -0,0 +1,80 @@
+//
+// Created by wenjuxu on 2023/8/13.
+//
+
+#include "catch2/catch_test_macros.hpp"
+#include "exec/when_any.hpp"
+#include "fuchsia/io_uring_context.h"
+#include "fuchsia/net/tcp.h"
+#include "fuchsia/scope_guard.h"
+
+using namespace std::chrono_literals;
+
+TEST_CASE("IoUringContext should be able to run and stop", "[IoUringContext]") {
+    fuchsia::IoUringContext context;
+    std::jthread thread([&]() { context.Run(); });
+    fuchsia::ScopeGuard guard{[&]() noexcept { context.Stop(); }};
+}
+
+TEST_CASE("IoUringContext scheduler can create (timer) senders", "[IoUringContext]") {
+    fuchsia::IoUringContext context;
+    std::jthread thread([&]() { context.Run(); });
+    fuchsia::ScopeGuard guard{[&]() noexcept { context.Stop(); }};
+
+    stdexec::scheduler auto scheduler = context.GetScheduler();
+    STATIC_REQUIRE(exec::timed_scheduler<decltype(scheduler)>);
+
+    // clang-format off
+    auto task = stdexec::when_all(
+        stdexec::schedule(scheduler) |
+            stdexec::then([] { return 42; }),
+        exec::schedule_after(scheduler, 5ms) |
+            stdexec::then([] { return "Hello"; }));
+    // clang-format on
+
+    auto result = stdexec::sync_wait(task).value();
+    REQUIRE(result == std::tuple{42, "Hello"});
+}
+
+TEST_CASE("IoUringContext scheduler can cancel timers", "[IoUringContext]") {
+    fuchsia::IoUringContext context;
+    std::jthread thread([&]() { context.Run(); });
+    fuchsia::ScopeGuard guard{[&]() noexcept { context.Stop(); }};
+
+    stdexec::scheduler auto scheduler = context.GetScheduler();
+
+    uint32_t counter = 0;
+    stdexec::sync_wait(exec::when_any(
+        exec::schedule_after(scheduler, 1ms) | stdexec::then([&] { ++counter; }),
+        exec::schedule_after(scheduler, 1h) | stdexec::then([&] { ++counter; })));
+    REQUIRE(counter == 1);
+}
+
+TEST_CASE("IoUringContext sockets echo through the ring", "[IoUringContext]") {
+    using Acceptor = fuchsia::net::Acceptor<fuchsia::net::Tcp, fuchsia::IoUringContext>;
+
+    fuchsia::IoUringContext context;
+    std::jthread thread([&]() { context.Run(); });
+    fuchsia::ScopeGuard guard{[&]() noexcept { context.Stop(); }};
+
+    fuchsia::net::Tcp::Endpoint ep{fuchsia::net::AddressV4::Loopback(), 0};
+    Acceptor acceptor{context, ep};
+    ::sockaddr_storage addr{};
+    ::socklen_t len = sizeof(addr);
+    ::getsockname(acceptor.Fd(), reinterpret_cast<::sockaddr*>(&addr), &len);
+
+    int client = ::socket(AF_INET, SOCK_STREAM, 0);
+    REQUIRE(::connect(client, reinterpret_cast<::sockaddr*>(&addr), len) == 0);
+    fuchsia::ScopeGuard client_guard{[&]() noexcept { ::close(client); }};
+
+    auto [server] = stdexec::sync_wait(fuchsia::AsyncAccept(acceptor)).value();
+    REQUIRE(::send(client, "ping", 4, 0) == 4);
+
+    char buffer[16];
+    auto [n] = stdexec::sync_wait(fuchsia::AsyncRecvSome(server, fuchsia::Buffer(buffer))).value();
+    REQUIRE(n == 4);
+    auto [m] =
+        stdexec::sync_wait(fuchsia::AsyncSendSome(server, fuchsia::Buffer(buffer, n))).value();
+    REQUIRE(m == 4);
+    REQUIRE(::recv(client, buffer, sizeof(buffer), 0) == 4);
+}
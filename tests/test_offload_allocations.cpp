@@ -0,0 +1,59 @@
+//
+// Created by wenjuxu on 2023/9/7.
+//
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+#include "catch2/catch_test_macros.hpp"
+#include "exec/task.hpp"
+#include "fuchsia/epoll_context.h"
+#include "fuchsia/work_stealing_pool.h"
+#include "test_util.h"
+
+namespace {
+
+std::atomic<bool> counting = false;
+std::atomic<size_t> allocations = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+TEST_CASE("Offload from a coroutine on a context does not allocate", "[WorkStealingPool]") {
+    fuchsia::EpollContext context;
+    fuchsia::test::RunningContext running{context};
+    fuchsia::WorkStealingPool pool{2};
+
+    auto task = [&]() -> exec::task<size_t> {
+        size_t sum = 0;
+        // Warm up, the first hops may set up thread-local state of the workers.
+        for (size_t i = 0; i < 100; ++i) {
+            sum += co_await fuchsia::Offload(pool, [i] { return i; });
+        }
+        allocations = 0;
+        counting = true;
+        for (size_t i = 0; i < 1000; ++i) {
+            sum += co_await fuchsia::Offload(pool, [i] { return i; });
+        }
+        counting = false;
+        co_return sum;
+    };
+    auto [sum] = stdexec::sync_wait(stdexec::on(context.GetScheduler(), task())).value();
+    REQUIRE(sum == 99 * 100 / 2 + 999 * 1000 / 2);
+    REQUIRE(allocations.load() == 0);
+}
@@ -0,0 +1,138 @@
+//
+// Created by wenjuxu on 2023/8/24.
+//
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+#include "fuchsia/http/mux.h"
+
+namespace {
+
+exec::task<void> Noop(const fuchsia::http::Request&, fuchsia::http::Response&) { co_return; }
+
+// Tells which pattern a path matched, handlers are told apart by their address in the mux.
+struct Routes {
+    Routes(std::initializer_list<const char*> patterns)
+        : patterns(patterns.begin(), patterns.end()) {
+        for (const auto& pattern : this->patterns) {
+            mux.HandleFunc(pattern, Noop);
+        }
+        for (const auto& pattern : this->patterns) {
+            handlers.push_back(mux.Match(pattern));  // `{name}` matches itself literally
+        }
+    }
+
+    std::string Match(std::string_view path) {
+        auto handler = mux.Match(path, params);
+        for (size_t i = 0; i < handlers.size(); ++i) {
+            if (handlers[i] == handler) {
+                return patterns[i];
+            }
+        }
+        return "";
+    }
+
+    std::vector<std::string> patterns;
+    fuchsia::http::ServeMux mux;
+    std::vector<const fuchsia::http::ServeMux::Handler*> handlers;
+    fuchsia::http::RouteParams params;
+};
+
+}  // namespace
+
+TEST_CASE("Static patterns match exactly", "[ServeMux]") {
+    Routes routes{"/hello", "/help", "/hello-keep-alive", "/json"};
+    REQUIRE(routes.Match("/hello") == "/hello");
+    REQUIRE(routes.Match("/help") == "/help");
+    REQUIRE(routes.Match("/hello-keep-alive") == "/hello-keep-alive");
+    REQUIRE(routes.Match("/json?pretty=1") == "/json");
+    REQUIRE(routes.Match("/hel").empty());
+    REQUIRE(routes.Match("/hello/").empty());
+    REQUIRE(routes.Match("/").empty());
+}
+
+TEST_CASE("Trailing slash patterns match everything below, the longest wins", "[ServeMux]") {
+    Routes routes{"/", "/static/", "/static/img/", "/api"};
+    REQUIRE(routes.Match("/") == "/");
+    REQUIRE(routes.Match("/anything/else") == "/");
+    REQUIRE(routes.Match("/static/") == "/static/");
+    REQUIRE(routes.Match("/static/css/main.css") == "/static/");
+    REQUIRE(routes.Match("/static/img/logo.png") == "/static/img/");
+    REQUIRE(routes.Match("/static") == "/");
+    REQUIRE(routes.Match("/api") == "/api");
+    REQUIRE(routes.Match("/api/v1") == "/");
+}
+
+TEST_CASE("Parameters capture whole segments", "[ServeMux]") {
+    Routes routes{"/users/{id}", "/users/new", "/users/{id}/posts/{post}", "/files/{name}/"};
+    REQUIRE(routes.Match("/users/42") == "/users/{id}");
+    REQUIRE(routes.params.Size() == 1);
+    REQUIRE(routes.params.Get("id") == "42");
+
+    REQUIRE(routes.Match("/users/new") == "/users/new");
+    REQUIRE(routes.params.Empty());
+
+    REQUIRE(routes.Match("/users/newer") == "/users/{id}");
+    REQUIRE(routes.params.Get("id") == "newer");
+
+    REQUIRE(routes.Match("/users/7/posts/hello-world") == "/users/{id}/posts/{post}");
+    REQUIRE(routes.params.Get("id") == "7");
+    REQUIRE(routes.params.Get("post") == "hello-world");
+
+    REQUIRE(routes.Match("/files/a/b/c") == "/files/{name}/");
+    REQUIRE(routes.params.Get("name") == "a");
+
+    REQUIRE(routes.Match("/users/").empty());
+    REQUIRE(routes.Match("/users/7/posts").empty());
+    REQUIRE(routes.params.Empty());
+}
+
+TEST_CASE("Static text wins over parameters, with backtracking", "[ServeMux]") {
+    Routes routes{"/a/b/c", "/a/{x}/d"};
+    REQUIRE(routes.Match("/a/b/c") == "/a/b/c");
+    REQUIRE(routes.Match("/a/b/d") == "/a/{x}/d");
+    REQUIRE(routes.params.Get("x") == "b");
+}
+
+TEST_CASE("Invalid and duplicate patterns are rejected", "[ServeMux]") {
+    fuchsia::http::ServeMux mux;
+    mux.HandleFunc("/users/{id}", Noop);
+    REQUIRE_THROWS_AS(mux.HandleFunc("/users/{id}", Noop), std::runtime_error);
+    REQUIRE_THROWS_AS(mux.HandleFunc("/users/{name}/posts", Noop), std::runtime_error);
+    REQUIRE_THROWS_AS(mux.HandleFunc("users", Noop), std::runtime_error);
+    REQUIRE_THROWS_AS(mux.HandleFunc("/a{id}", Noop), std::runtime_error);
+    REQUIRE_THROWS_AS(mux.HandleFunc("/{id}b", Noop), std::runtime_error);
+    REQUIRE_THROWS_AS(mux.HandleFunc("/{}", Noop), std::runtime_error);
+}
+
+TEST_CASE("A rejected pattern leaves the routes as they were", "[ServeMux]") {
+    Routes routes{"/users/{id}", "/a"};
+    REQUIRE_THROWS_AS(routes.mux.HandleFunc("/users/{name}/posts", Noop), std::runtime_error);
+    REQUIRE_THROWS_AS(routes.mux.HandleFunc("/ab{id}", Noop), std::runtime_error);
+    REQUIRE_THROWS_AS(routes.mux.HandleFunc("/b/c/{id}x", Noop), std::runtime_error);
+
+    // The static parts of the rejected patterns were not inserted, so these are new patterns.
+    routes.mux.HandleFunc("/users/{id}/posts", Noop);
+    routes.mux.HandleFunc("/ab", Noop);
+    routes.mux.HandleFunc("/b/c/", Noop);
+    REQUIRE(routes.mux.Match("/users/1/posts") != nullptr);
+    REQUIRE(routes.mux.Match("/ab") != nullptr);
+    REQUIRE(routes.mux.Match("/b/c/d") != nullptr);
+    REQUIRE(routes.mux.Match("/a") != nullptr);
+    REQUIRE(routes.mux.Match("/users/7", routes.params) != nullptr);
+    REQUIRE(routes.params.Get("id") == "7");
+}
+
+TEST_CASE("Nodes with many children find every one of them", "[ServeMux]") {
+    // More children than the node keeps the first characters of.
+    Routes routes{"/a", "/b", "/c", "/d", "/e", "/f", "/g", "/h", "/i", "/j", "/k", "/{id}"};
+    for (const auto& pattern : {"/a", "/d", "/h", "/i", "/k"}) {
+        REQUIRE(routes.Match(pattern) == pattern);
+    }
+    REQUIRE(routes.Match("/l") == "/{id}");
+    REQUIRE(routes.params.Get("id") == "l");
+    REQUIRE(routes.Match("/kk") == "/{id}");
+}
@@ -0,0 +1,109 @@
+//
+// Created by wenjuxu on 2023/8/21.
+//
+
+#include <fcntl.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "catch2/catch_test_macros.hpp"
+#include "fuchsia/epoll_context.h"
+#include "fuchsia/http/session.h"
+#include "fuchsia/net/tcp.h"
+#include "test_util.h"
+
+namespace {
+
+std::atomic<bool> counting = false;
+std::atomic<size_t> allocations = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+namespace {
+
+// Send a request and read its whole response, blocking. Catch2 assertions are not thread safe,
+// so failures are reported back through the return value.
+bool RoundTrip(int fd, std::string_view request, std::string_view expected_response) {
+    if (::send(fd, request.data(), request.size(), MSG_NOSIGNAL) !=
+        static_cast<ssize_t>(request.size())) {
+        return false;
+    }
+    char buffer[256];
+    size_t received = 0;
+    while (received < expected_response.size()) {
+        auto n = ::recv(fd, buffer + received, sizeof(buffer) - received, 0);
+        if (n <= 0) {
+            return false;
+        }
+        received += n;
+    }
+    return std::string_view{buffer, received} == expected_response;
+}
+
+}  // namespace
+
+TEST_CASE("A keep-alive session does not allocate in steady state", "[Session]") {
+    fuchsia::EpollContext context;
+    auto [client, server] = fuchsia::test::MakeSocketPair(context);
+    fuchsia::test::RunningContext running{context};
+    // The client side talks plain blocking syscalls from its own thread.
+    ::fcntl(client.Fd(), F_SETFL, ::fcntl(client.Fd(), F_GETFL) & ~O_NONBLOCK);
+
+    fuchsia::http::ServeMux mux;
+    mux.HandleFunc("/", [](const fuchsia::http::Request& req,
+                           fuchsia::http::Response& resp) -> exec::task<void> {
+        resp.SetKeepAlive(req.Url() != "/close");
+        resp.WriteBody("ok");
+        co_return;
+    });
+    fuchsia::http::SessionMgr session_mgr;
+    auto session = fuchsia::http::MakeSession(std::move(server), session_mgr, mux);
+
+    constexpr std::string_view kRequest =
+        "GET / HTTP/1.1\r\nHost: localhost\r\nUser-Agent: fuchsia-session-allocation-test\r\n\r\n";
+    constexpr std::string_view kResponse =
+        "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nContent-Type: text/plain\r\n"
+        "Connection: keep-alive\r\n\r\nok";
+    constexpr std::string_view kCloseRequest = "GET /close HTTP/1.1\r\nHost: a\r\n\r\n";
+    constexpr std::string_view kCloseResponse =
+        "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nContent-Type: text/plain\r\n"
+        "Connection: close\r\n\r\nok";
+
+    bool ok = true;
+    size_t steady_state_allocations = 0;
+    std::jthread client_thread([&, fd = client.Fd()]() {
+        // Warm up: the slab chunks, the buffers of the request and response, ...
+        for (int i = 0; i < 100; ++i) {
+            ok = ok && RoundTrip(fd, kRequest, kResponse);
+        }
+        allocations = 0;
+        counting = true;
+        for (int i = 0; i < 1000; ++i) {
+            ok = ok && RoundTrip(fd, kRequest, kResponse);
+        }
+        counting = false;
+        steady_state_allocations = allocations.load();
+        ok = RoundTrip(fd, kCloseRequest, kCloseResponse) && ok;
+    });
+
+    stdexec::sync_wait(stdexec::on(context.GetScheduler(), session_mgr.Start(session)));
+    client_thread.join();
+    REQUIRE(ok);
+    REQUIRE(steady_state_allocations == 0);
+}
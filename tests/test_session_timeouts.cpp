@@ -0,0 +1,141 @@
+//
+// Created by wenjuxu on 2023/9/7.
+//
+
+#include <fcntl.h>
+#include <sys/socket.h>
+
+#include <chrono>
+#include <string_view>
+#include <thread>
+
+#include "catch2/catch_test_macros.hpp"
+#include "fuchsia/epoll_context.h"
+#include "fuchsia/http/session.h"
+#include "fuchsia/net/tcp.h"
+#include "test_util.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Serves one connection with `options`, while `client` talks to it with blocking syscalls from a
+// thread of its own. Returns how long the session lasted. Catch2 assertions are not thread safe,
+// so the client reports failures back through `ok`.
+template <typename Client>
+std::chrono::steady_clock::duration Serve(const fuchsia::http::SessionOptions& options,
+                                          Client client, bool& ok) {
+    fuchsia::EpollContext context;
+    auto [client_socket, server] = fuchsia::test::MakeSocketPair(context);
+    int fd = client_socket.Fd();
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+
+    fuchsia::http::ServeMux mux;
+    mux.HandleFunc("/", [](const fuchsia::http::Request& req,
+                           fuchsia::http::Response& resp) -> exec::task<void> {
+        resp.SetKeepAlive(false);
+        resp.WriteBody(req.Body());
+        co_return;
+    });
+    fuchsia::http::SessionMgr session_mgr;
+    auto session = fuchsia::http::MakeSession(std::move(server), session_mgr, mux, options);
+    fuchsia::test::RunningContext running{context};
+
+    auto start = std::chrono::steady_clock::now();
+    std::jthread client_thread([&]() { ok = client(fd); });
+    stdexec::sync_wait(stdexec::on(context.GetScheduler(), session_mgr.Start(session)));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    client_thread.join();
+    return elapsed;
+}
+
+bool Send(int fd, std::string_view data) {
+    return ::send(fd, data.data(), data.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(data.size());
+}
+
+// Whether the server closed the connection without answering.
+bool Closed(int fd) {
+    char c;
+    return ::recv(fd, &c, 1, 0) <= 0;
+}
+
+// Read until the server closes the connection, whether that is all of `expected`.
+bool Receive(int fd, std::string_view expected) {
+    char buffer[256];
+    size_t received = 0;
+    while (received < sizeof(buffer)) {
+        auto n = ::recv(fd, buffer + received, sizeof(buffer) - received, 0);
+        if (n <= 0) {
+            break;
+        }
+        received += n;
+    }
+    return std::string_view{buffer, received} == expected;
+}
+
+// The limit under test, much shorter than the others, and how late the close may come.
+constexpr auto kTimeout = 100ms;
+constexpr auto kSlack = 5s;
+
+fuchsia::http::SessionOptions Options(std::chrono::milliseconds idle,
+                                      std::chrono::milliseconds header,
+                                      std::chrono::milliseconds body) {
+    return {.idle_timeout = idle, .header_timeout = header, .body_timeout = body};
+}
+
+}  // namespace
+
+TEST_CASE("A client that sends nothing is closed after the idle timeout", "[Session]") {
+    bool ok = false;
+    auto elapsed = Serve(Options(kTimeout, 1min, 1min), [](int fd) { return Closed(fd); }, ok);
+    REQUIRE(ok);
+    REQUIRE(elapsed >= kTimeout);
+    REQUIRE(elapsed < kSlack);
+}
+
+TEST_CASE("A partial header is closed after the header timeout", "[Session]") {
+    bool ok = false;
+    auto elapsed = Serve(
+        Options(1min, kTimeout, 1min),
+        [](int fd) { return Send(fd, "GET / HTTP/1.1\r\nHost: loc") && Closed(fd); }, ok);
+    REQUIRE(ok);
+    REQUIRE(elapsed >= kTimeout);
+    REQUIRE(elapsed < kSlack);
+}
+
+TEST_CASE("A partial body is closed after the body timeout", "[Session]") {
+    bool ok = false;
+    auto elapsed = Serve(Options(1min, 1min, kTimeout),
+                         [](int fd) {
+                             return Send(fd,
+                                         "POST / HTTP/1.1\r\nHost: localhost\r\n"
+                                         "Content-Length: 10\r\n\r\nabc") &&
+                                    Closed(fd);
+                         },
+                         ok);
+    REQUIRE(ok);
+    REQUIRE(elapsed >= kTimeout);
+    REQUIRE(elapsed < kSlack);
+}
+
+TEST_CASE("A zero timeout means no limit", "[Session]") {
+    // Each pause is longer than the timeouts above, in each of the phases.
+    constexpr auto kPause = 3 * kTimeout;
+    bool ok = false;
+    auto elapsed = Serve(Options(0ms, 0ms, 0ms),
+                         [kPause](int fd) {
+                             std::this_thread::sleep_for(kPause);
+                             bool sent = Send(fd, "POST / HTTP/1.1\r\nHost: loc");
+                             std::this_thread::sleep_for(kPause);
+                             sent = sent && Send(fd, "alhost\r\nContent-Length: 5\r\n\r\nhe");
+                             std::this_thread::sleep_for(kPause);
+                             return sent && Send(fd, "llo") &&
+                                    Receive(fd,
+                                            "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n"
+                                            "Content-Type: text/plain\r\n"
+                                            "Connection: close\r\n\r\nhello");
+                         },
+                         ok);
+    REQUIRE(ok);
+    REQUIRE(elapsed >= 3 * kPause);
+}
@@ -0,0 +1,362 @@
+//
+// Created by wenjuxu on 2023/8/15.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "catch2/catch_test_macros.hpp"
+#include "exec/when_any.hpp"
+#include "fuchsia/epoll_context.h"
+#include "fuchsia/net/tcp.h"
+#include "fuchsia/scope_guard.h"
+#include "fuchsia/socket_connect_op.h"
+#include "fuchsia/socket_read_at_least_op.h"
+#include "fuchsia/socket_read_until_op.h"
+#include "fuchsia/socket_recv_exactly_op.h"
+#include "fuchsia/socket_recv_some_op.h"
+#include "fuchsia/socket_send_all_op.h"
+#include "fuchsia/socket_send_file_op.h"
+#include "fuchsia/socket_send_some_op.h"
+#include "fuchsia/socket_send_zero_copy_op.h"
+#include "fuchsia/with_timeout.h"
+#include "test_util.h"
+
+using namespace std::chrono_literals;
+
+TEST_CASE("Socket operations complete on readiness", "[SocketOperation]") {
+    fuchsia::EpollContext context;
+    auto [client, server] = fuchsia::test::MakeSocketPair(context);
+    fuchsia::test::RunningContext running{context};
+
+    char buffer[16]{};
+    fuchsia::MutableBuffer buf{buffer, sizeof(buffer)};
+    // clang-format off
+    auto [received, sent] = stdexec::sync_wait(stdexec::when_all(
+        fuchsia::AsyncRecvSome(server, buf),
+        exec::schedule_after(context.GetScheduler(), 10ms) |
+            stdexec::let_value([&] {
+                return fuchsia::AsyncSendSome(client, fuchsia::ConstBuffer("ping", 4));
+            }))).value();
+    // clang-format on
+    REQUIRE(received == 4);
+    REQUIRE(sent == 4);
+    REQUIRE(std::string_view{buffer, received} == "ping");
+}
+
+TEST_CASE("A socket can have a pending read and a pending write at once", "[SocketOperation]") {
+    fuchsia::EpollContext context;
+    auto [client, server] = fuchsia::test::MakeSocketPair(context);
+    fuchsia::test::RunningContext running{context};
+
+    // Fill up the send buffer of the server, so that the next send has to wait.
+    std::vector<char> chunk(64 * 1024);
+    std::error_code ec;
+    while (server.Send(chunk.data(), chunk.size(), ec).has_value()) {
+    }
+    REQUIRE(ec == std::errc::resource_unavailable_try_again);
+
+    char buffer[16]{};
+    fuchsia::MutableBuffer buf{buffer, sizeof(buffer)};
+    fuchsia::ConstBuffer data{chunk.data(), chunk.size()};
+    std::vector<char> drain(1024 * 1024);
+    // clang-format off
+    auto [received, sent] = stdexec::sync_wait(stdexec::when_all(
+        fuchsia::AsyncRecvSome(server, buf),   // waits for read
+        fuchsia::AsyncSendSome(server, data),  // waits for write
+        exec::schedule_after(context.GetScheduler(), 10ms) |
+            stdexec::then([&] {
+                ::send(client.Fd(), "ping", 4, 0);
+                while (::recv(client.Fd(), drain.data(), drain.size(), 0) > 0) {
+                }
+            }))).value();
+    // clang-format on
+    REQUIRE(received == 4);
+    REQUIRE(sent > 0);
+}
+
+TEST_CASE("A pending socket operation can be cancelled", "[SocketOperation]") {
+    fuchsia::EpollContext context;
+    auto [client, server] = fuchsia::test::MakeSocketPair(context);
+    fuchsia::test::RunningContext running{context};
+
+    char buffer[16]{};
+    fuchsia::MutableBuffer buf{buffer, sizeof(buffer)};
+    bool received = false;
+    stdexec::sync_wait(exec::when_any(
+        fuchsia::AsyncRecvSome(server, buf) |
+            stdexec::then([&](size_t) { received = true; }),
+        exec::schedule_after(context.GetScheduler(), 10ms)));
+    REQUIRE_FALSE(received);
+
+    // The socket is still usable after the cancellation.
+    ::send(client.Fd(), "ping", 4, 0);
+    auto [n] = stdexec::sync_wait(fuchsia::AsyncRecvSome(server, buf)).value();
+    REQUIRE(n == 4);
+}
+
+TEST_CASE("SendAll and RecvExactly go on past the socket buffer size", "[SocketOperation]") {
+    fuchsia::EpollContext context;
+    auto [client, server] = fuchsia::test::MakeSocketPair(context);
+    fuchsia::test::RunningContext running{context};
+
+    std::string head = "head";
+    std::vector<char> body(8 * 1024 * 1024);
+    for (size_t i = 0; i < body.size(); ++i) {
+        body[i] = static_cast<char>(i * 31);
+    }
+    std::array<fuchsia::ConstBuffer, 2> data{fuchsia::Buffer(head), fuchsia::Buffer(body)};
+
+    std::vector<char> received_head(head.size());
+    std::vector<char> received_body(body.size());
+    std::array<fuchsia::MutableBuffer, 2> buffers{fuchsia::Buffer(received_head),
+                                                  fuchsia::Buffer(received_body)};
+    auto [sent, received] = stdexec::sync_wait(stdexec::when_all(
+        fuchsia::AsyncSendAll(server, data), fuchsia::AsyncRecvExactly(client, buffers))).value();
+    REQUIRE(sent == head.size() + body.size());
+    REQUIRE(received == sent);
+    REQUIRE(std::string_view{received_head.data(), received_head.size()} == head);
+    REQUIRE(received_body == body);
+}
+
+TEST_CASE("SendZeroCopy completes once the kernel is done with the buffers", "[SocketOperation]") {
+    fuchsia::EpollContext context;
+    auto [client, server] = fuchsia::test::MakeSocketPair(context);
+    fuchsia::test::RunningContext running{context};
+
+    std::vector<char> body(8 * 1024 * 1024);
+    for (size_t i = 0; i < body.size(); ++i) {
+        body[i] = static_cast<char>(i * 31);
+    }
+    std::vector<char> received_body(body.size());
+    for (int round = 0; round < 2; ++round) {  // the notifications of a socket add up
+        auto [sent, received] = stdexec::sync_wait(stdexec::when_all(
+            fuchsia::AsyncSendZeroCopy(server, fuchsia::ConstBuffer{body.data(), body.size()}),
+            fuchsia::AsyncRecvExactly(client, fuchsia::Buffer(received_body)))).value();
+        REQUIRE(sent == body.size());
+        REQUIRE(received == sent);
+        REQUIRE(received_body == body);
+    }
+}
+
+TEST_CASE("SendZeroCopy only counts the notifications of its own sends", "[SocketOperation]") {
+    fuchsia::EpollContext context;
+    auto [client, server] = fuchsia::test::MakeSocketPair(context);
+    fuchsia::test::RunningContext running{context};
+
+    // A send given up on, whose notification is still to be taken from the error queue.
+    server.SetZeroCopy(true);
+    std::vector<char> earlier(64 * 1024, 'e');
+    ::iovec iov{earlier.data(), earlier.size()};
+    std::error_code ec;
+    auto earlier_sent = server.SendMsg(&iov, 1, ec, MSG_ZEROCOPY);
+    REQUIRE(earlier_sent.has_value());
+    REQUIRE(server.ZeroCopySequence() == 1);
+
+    std::vector<char> body(1024 * 1024, 'b');
+    std::vector<char> received(*earlier_sent + body.size());
+    auto [sent, n] = stdexec::sync_wait(stdexec::when_all(
+        fuchsia::AsyncSendZeroCopy(server, fuchsia::ConstBuffer{body.data(), body.size()}),
+        fuchsia::AsyncRecvExactly(client, fuchsia::Buffer(received)))).value();
+    REQUIRE(sent == body.size());
+    REQUIRE(n == received.size());
+    REQUIRE(server.ZeroCopySequence() > 1);
+    REQUIRE(std::equal(body.begin(), body.end(), received.begin() + *earlier_sent));
+}
+
+TEST_CASE("SendFile sends a range of a file past the socket buffer size", "[SocketOperation]") {
+    fuchsia::EpollContext context;
+    auto [client, server] = fuchsia::test::MakeSocketPair(context);
+    fuchsia::test::RunningContext running{context};
+
+    std::vector<char> body(8 * 1024 * 1024);
+    for (size_t i = 0; i < body.size(); ++i) {
+        body[i] = static_cast<char>(i * 31);
+    }
+    std::FILE* file = std::tmpfile();
+    REQUIRE(std::fwrite(body.data(), 1, body.size(), file) == body.size());
+    std::fflush(file);
+    fuchsia::ScopeGuard close_file{[&]() noexcept { std::fclose(file); }};
+
+    constexpr size_t kOffset = 4096;
+    std::vector<char> received_body(body.size() - kOffset);
+    auto [sent, received] = stdexec::sync_wait(stdexec::when_all(
+        fuchsia::AsyncSendFile(server, ::fileno(file), kOffset, received_body.size()),
+        fuchsia::AsyncRecvExactly(client, fuchsia::Buffer(received_body)))).value();
+    REQUIRE(sent == received_body.size());
+    REQUIRE(received == sent);
+    REQUIRE(std::equal(received_body.begin(), received_body.end(), body.begin() + kOffset));
+
+    // A range past the end of the file fails rather than waiting forever.
+    std::error_code ec;
+    try {
+        stdexec::sync_wait(fuchsia::AsyncSendFile(server, ::fileno(file), body.size() - 1, 2));
+    } catch (const std::system_error& e) {
+        ec = e.code();
+    }
+    REQUIRE(ec == std::errc::io_error);
+}
+
+TEST_CASE("ReadUntil finds a delimiter split across reads", "[SocketOperation]") {
+    fuchsia::EpollContext context;
+    auto [client, server] = fuchsia::test::MakeSocketPair(context);
+    fuchsia::test::RunningContext running{context};
+
+    fuchsia::DynamicBuffer buf;
+    // clang-format off
+    auto [n] = stdexec::sync_wait(stdexec::when_all(
+        fuchsia::AsyncReadUntil(server, buf, "\r\n\r\n"),
+        exec::schedule_after(context.GetScheduler(), 10ms) |
+            stdexec::then([&] { ::send(client.Fd(), "GET / HTTP/1.1\r\n\r", 17, 0); }) |
+            stdexec::let_value([&] {
+                return exec::schedule_after(context.GetScheduler(), 10ms);
+            }) |
+            stdexec::then([&] { ::send(client.Fd(), "\nGET /next", 10, 0); }))).value();
+    // clang-format on
+    REQUIRE(n == 18);
+    REQUIRE(buf.View().substr(0, n) == "GET / HTTP/1.1\r\n\r\n");
+    buf.Consume(n);
+    REQUIRE(buf.View() == "GET /next");
+
+    // The next message is read on top of what is left.
+    std::string_view rest{" HTTP/1.1\r\n\r\nGET /last HTTP/1.1\r\n\r\n"};
+    ::send(client.Fd(), rest.data(), rest.size(), 0);
+    auto [second] = stdexec::sync_wait(fuchsia::AsyncReadUntil(server, buf, "\r\n\r\n")).value();
+    REQUIRE(buf.View().substr(0, second) == "GET /next HTTP/1.1\r\n\r\n");
+    buf.Consume(second);
+    // ... and the one after that straight from the buffer.
+    auto [third] = stdexec::sync_wait(fuchsia::AsyncReadUntil(server, buf, "\n")).value();
+    REQUIRE(buf.View().substr(0, third) == "GET /last HTTP/1.1\r\n");
+}
+
+TEST_CASE("ReadUntil fails once the buffer is full", "[SocketOperation]") {
+    fuchsia::EpollContext context;
+    auto [client, server] = fuchsia::test::MakeSocketPair(context);
+    fuchsia::test::RunningContext running{context};
+
+    fuchsia::DynamicBuffer buf{16};
+    std::string_view request{"GET /a/very/long/path HTTP/1.1\r\n\r\n"};
+    ::send(client.Fd(), request.data(), request.size(), 0);
+    std::error_code ec;
+    try {
+        stdexec::sync_wait(fuchsia::AsyncReadUntil(server, buf, "\r\n\r\n"));
+    } catch (const std::system_error& e) {
+        ec = e.code();
+    }
+    REQUIRE(ec == std::errc::message_size);
+    REQUIRE(buf.Size() == 16);
+}
+
+TEST_CASE("ReadAtLeast reads length prefixed frames", "[SocketOperation]") {
+    fuchsia::EpollContext context;
+    auto [client, server] = fuchsia::test::MakeSocketPair(context);
+    fuchsia::test::RunningContext running{context};
+
+    std::vector<char> body(1024 * 1024);
+    for (size_t i = 0; i < body.size(); ++i) {
+        body[i] = static_cast<char>(i * 31);
+    }
+    auto length = static_cast<uint32_t>(body.size());
+    std::array<fuchsia::ConstBuffer, 3> data{fuchsia::ConstBuffer{&length, sizeof(length)},
+                                             fuchsia::Buffer(body),
+                                             fuchsia::ConstBuffer{"next", 4}};
+
+    fuchsia::DynamicBuffer buf;
+    auto [sent, prefixed] = stdexec::sync_wait(stdexec::when_all(
+        fuchsia::AsyncSendAll(client, data),
+        fuchsia::AsyncReadAtLeast(server, buf, sizeof(uint32_t)))).value();
+    REQUIRE(prefixed >= sizeof(uint32_t));
+    uint32_t received_length = 0;
+    std::memcpy(&received_length, buf.Data().Data(), sizeof(received_length));
+    REQUIRE(received_length == body.size());
+    buf.Consume(sizeof(uint32_t));
+
+    auto [n] = stdexec::sync_wait(fuchsia::AsyncReadAtLeast(server, buf, received_length + 4))
+                   .value();
+    REQUIRE(n == received_length + 4);
+    REQUIRE(std::equal(body.begin(), body.end(), buf.View().begin()));
+    REQUIRE(buf.View().substr(received_length) == "next");
+
+    std::error_code ec;
+    try {
+        fuchsia::DynamicBuffer small{8};
+        stdexec::sync_wait(fuchsia::AsyncReadAtLeast(server, small, 9));
+    } catch (const std::system_error& e) {
+        ec = e.code();
+    }
+    REQUIRE(ec == std::errc::message_size);
+}
+
+TEST_CASE("WithTimeout fails a socket operation with timed_out", "[SocketOperation]") {
+    fuchsia::EpollContext context;
+    auto [client, server] = fuchsia::test::MakeSocketPair(context);
+    fuchsia::test::RunningContext running{context};
+
+    char buffer[16]{};
+    fuchsia::MutableBuffer buf{buffer, sizeof(buffer)};
+    std::error_code ec;
+    try {
+        stdexec::sync_wait(fuchsia::WithTimeout(context.GetScheduler(),
+                                                fuchsia::AsyncRecvSome(server, buf), 10ms));
+    } catch (const std::system_error& e) {
+        ec = e.code();
+    }
+    REQUIRE(ec == std::errc::timed_out);
+
+    // An operation completing in time is not affected.
+    ::send(client.Fd(), "ping", 4, 0);
+    auto [n] = stdexec::sync_wait(fuchsia::WithTimeout(context.GetScheduler(),
+                                                       fuchsia::AsyncRecvSome(server, buf), 1s))
+                   .value();
+    REQUIRE(n == 4);
+}
+
+TEST_CASE("Connect completes once the connection is established", "[SocketOperation]") {
+    fuchsia::EpollContext context;
+    fuchsia::net::Tcp::Acceptor acceptor{
+        context, fuchsia::net::Tcp::Endpoint{fuchsia::net::AddressV4::Loopback(), 0}};
+    ::sockaddr_storage addr{};
+    ::socklen_t len = sizeof(addr);
+    ::getsockname(acceptor.Fd(), reinterpret_cast<::sockaddr*>(&addr), &len);
+    fuchsia::net::Tcp::Endpoint endpoint{reinterpret_cast<::sockaddr*>(&addr)};
+    fuchsia::net::Tcp::Socket client{context, fuchsia::net::Tcp::V4()};
+    fuchsia::net::Tcp::Socket server{context};
+    fuchsia::test::RunningContext running{context};
+
+    stdexec::sync_wait(fuchsia::AsyncConnect(client, endpoint));
+    REQUIRE_FALSE(client.Error());
+
+    std::error_code ec;
+    auto accepted = acceptor.Accept(ec);
+    REQUIRE(accepted.has_value());
+    server = std::move(accepted->first);
+    ::send(client.Fd(), "ping", 4, 0);
+    char buffer[16]{};
+    fuchsia::MutableBuffer buf{buffer, sizeof(buffer)};
+    auto [n] = stdexec::sync_wait(fuchsia::AsyncRecvSome(server, buf)).value();
+    REQUIRE(n == 4);
+}
+
+TEST_CASE("Connect fails when nobody listens", "[SocketOperation]") {
+    fuchsia::EpollContext context;
+    // Take a free port, then close it again.
+    ::sockaddr_storage addr{};
+    {
+        fuchsia::net::Tcp::Socket socket{
+            context, fuchsia::net::Tcp::Endpoint{fuchsia::net::AddressV4::Loopback(), 0}};
+        ::socklen_t len = sizeof(addr);
+        ::getsockname(socket.Fd(), reinterpret_cast<::sockaddr*>(&addr), &len);
+    }
+    fuchsia::net::Tcp::Endpoint endpoint{reinterpret_cast<::sockaddr*>(&addr)};
+    fuchsia::net::Tcp::Socket client{context, fuchsia::net::Tcp::V4()};
+    fuchsia::test::RunningContext running{context};
+
+    std::error_code ec;
+    try {
+        stdexec::sync_wait(fuchsia::AsyncConnect(client, endpoint));
+    } catch (const std::system_error& e) {
+        ec = e.code();
+    }
+    REQUIRE(ec == std::errc::connection_refused);
+}
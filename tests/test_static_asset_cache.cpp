@@ -0,0 +1,133 @@
+//
+// Created by wenjuxu on 2023/9/3.
+//
+
+#include "fuchsia/http/static_asset_cache.h"
+
+#include <sys/stat.h>
+
+#include <string>
+
+#include "catch2/catch_test_macros.hpp"
+#include "test_util.h"
+
+namespace {
+
+struct Result {
+    fuchsia::http::StatusCode status;
+    std::string head;
+    std::string body;
+};
+
+// Serve a GET of `target` with the extra header lines `headers`.
+Result Get(fuchsia::http::StaticAssetCache& assets, std::string_view target,
+           std::string_view headers = {}) {
+    std::string raw{"GET "};
+    raw.append(target).append(" HTTP/1.1\r\nHost: test\r\n").append(headers).append("\r\n");
+    fuchsia::http::Request req;
+    REQUIRE(req.Parse(raw.data(), raw.size()) == fuchsia::http::ParseResult::Ok);
+    fuchsia::http::Response resp;
+    stdexec::sync_wait(assets.Serve(req, resp));
+    auto buffers = resp.ToBuffers();
+    return {resp.StatusCode(),
+            std::string{static_cast<const char*>(buffers[0].Data()), buffers[0].Size()},
+            std::string{static_cast<const char*>(buffers[1].Data()), buffers[1].Size()}};
+}
+
+}  // namespace
+
+TEST_CASE("StaticAssetCache serves mapped files with rendered heads", "[StaticAssetCache]") {
+    fuchsia::test::TempDir dir{true};
+    dir.Write("app.js", "let x = 1;");
+    dir.Write("docs/index.html", "<html></html>");
+    // Left out, without waiting for a writer.
+    REQUIRE(::mkfifo((dir.Path() + "/pipe").c_str(), 0600) == 0);
+    fuchsia::http::StaticAssetCache assets{dir.Path(), "/assets/"};
+    REQUIRE(assets.Size() == 3);  // docs/ too
+
+    auto result = Get(assets, "/assets/app.js?v=2");
+    REQUIRE(result.status == fuchsia::http::StatusCode::Ok);
+    REQUIRE(result.head.starts_with("HTTP/1.1 200 OK\r\n"));
+    REQUIRE(result.head.find("Content-Type: text/javascript; charset=utf-8\r\n") !=
+            std::string::npos);
+    REQUIRE(result.head.find("Content-Length: 10\r\n") != std::string::npos);
+    REQUIRE(result.head.find("Vary:") == std::string::npos);
+    REQUIRE(result.head.ends_with("Connection: keep-alive\r\n\r\n"));
+    REQUIRE(result.body == "let x = 1;");
+
+    REQUIRE(Get(assets, "/assets/docs/").body == "<html></html>");
+    REQUIRE(Get(assets, "/assets/missing.js").status == fuchsia::http::StatusCode::NotFound);
+    REQUIRE(Get(assets, "/app.js").status == fuchsia::http::StatusCode::NotFound);
+}
+
+TEST_CASE("StaticAssetCache picks the variant by Accept-Encoding", "[StaticAssetCache]") {
+    fuchsia::test::TempDir dir{true};
+    dir.Write("app.js", "let x = 1;");
+    dir.Write("app.js.gz", "gzipped");
+    dir.Write("app.js.br", "brotli");
+    dir.Write("style.css", "body {}");
+    dir.Write("style.css.gz", "gzipped css");
+    fuchsia::http::StaticAssetCache assets{dir.Path()};
+
+    REQUIRE(Get(assets, "/app.js").body == "let x = 1;");
+    auto gzip = Get(assets, "/app.js", "Accept-Encoding: gzip\r\n");
+    REQUIRE(gzip.body == "gzipped");
+    REQUIRE(gzip.head.find("Content-Encoding: gzip\r\n") != std::string::npos);
+    REQUIRE(gzip.head.find("Vary: Accept-Encoding\r\n") != std::string::npos);
+    REQUIRE(Get(assets, "/app.js", "Accept-Encoding: gzip, deflate, br\r\n").body == "brotli");
+    REQUIRE(Get(assets, "/app.js", "Accept-Encoding: br;q=0, gzip\r\n").body == "gzipped");
+    REQUIRE(Get(assets, "/style.css", "Accept-Encoding: br\r\n").body == "body {}");
+
+    // The variants have ETags of their own.
+    auto etag_begin = gzip.head.find("ETag: ") + 6;
+    auto etag = gzip.head.substr(etag_begin, gzip.head.find("\r\n", etag_begin) - etag_begin);
+    auto not_modified = Get(assets, "/app.js", "Accept-Encoding: gzip\r\nIf-None-Match: " + etag +
+                                                   "\r\n");
+    REQUIRE(not_modified.status == fuchsia::http::StatusCode::NotModified);
+    REQUIRE(not_modified.head.starts_with("HTTP/1.1 304 Not Modified\r\n"));
+    REQUIRE(not_modified.body.empty());
+    REQUIRE(Get(assets, "/app.js", "If-None-Match: " + etag + "\r\n").status ==
+            fuchsia::http::StatusCode::Ok);
+
+    // If-Modified-Since is compared as a date, not as the text of Last-Modified.
+    auto modified_begin = gzip.head.find("Last-Modified: ") + 15;
+    auto last_modified = fuchsia::http::ParseHttpDate(gzip.head.substr(
+        modified_begin, gzip.head.find("\r\n", modified_begin) - modified_begin));
+    REQUIRE(last_modified.has_value());
+    char date[32];
+    auto later = std::string{fuchsia::http::FormatHttpDate(date, *last_modified + 60)};
+    REQUIRE(Get(assets, "/app.js", "If-Modified-Since: " + later + "\r\n").status ==
+            fuchsia::http::StatusCode::NotModified);
+    auto earlier = std::string{fuchsia::http::FormatHttpDate(date, *last_modified - 60)};
+    REQUIRE(Get(assets, "/app.js", "If-Modified-Since: " + earlier + "\r\n").status ==
+            fuchsia::http::StatusCode::Ok);
+}
+
+TEST_CASE("StaticAssetCache applies the changes reported by inotify", "[StaticAssetCache]") {
+    fuchsia::test::TempDir dir{true};
+    dir.Write("app.js", "let x = 1;");
+    dir.Write("old.css", "old");
+    fuchsia::http::StaticAssetCache assets{dir.Path()};
+    REQUIRE(assets.Refresh() == 0);
+
+    // A response rendered before keeps its snapshot.
+    std::string raw{"GET /app.js HTTP/1.1\r\n\r\n"};
+    fuchsia::http::Request req;
+    req.Parse(raw.data(), raw.size());
+    fuchsia::http::Response resp;
+    stdexec::sync_wait(assets.Serve(req, resp));
+
+    dir.Write("app.js", "let x = 2; // updated");
+    dir.Write("app.js.gz", "gzipped");
+    dir.Write("css/new.css", "new");
+    dir.Remove("old.css");
+    REQUIRE(assets.Refresh() > 0);
+
+    REQUIRE(Get(assets, "/app.js").body == "let x = 2; // updated");
+    REQUIRE(Get(assets, "/app.js", "Accept-Encoding: gzip\r\n").body == "gzipped");
+    REQUIRE(Get(assets, "/css/new.css").body == "new");
+    REQUIRE(Get(assets, "/old.css").status == fuchsia::http::StatusCode::NotFound);
+
+    auto body = resp.ToBuffers()[1];
+    REQUIRE(std::string_view{static_cast<const char*>(body.Data()), body.Size()} == "let x = 1;");
+}
@@ -0,0 +1,68 @@
+//
+// Created by wenjuxu on 2023/8/25.
+//
+
+#include <string>
+
+#include "catch2/catch_test_macros.hpp"
+#include "fuchsia/http/static_mux.h"
+#include "stdexec/execution.hpp"
+
+namespace {
+
+exec::task<void> HandleHealth(const fuchsia::http::Request&, fuchsia::http::Response& resp) {
+    resp.WriteBody("ok");
+    co_return;
+}
+
+exec::task<void> HandleStatic(const fuchsia::http::Request& req, fuchsia::http::Response& resp) {
+    resp.WriteBody("static ");
+    resp.WriteBody(req.Url());
+    co_return;
+}
+
+using Mux = fuchsia::http::StaticServeMux<
+    fuchsia::http::Route<"/health", HandleHealth>,
+    fuchsia::http::Route<"/static/", HandleStatic>,
+    fuchsia::http::Route<"/static/img/", HandleStatic>,
+    fuchsia::http::Route<"/", [](const fuchsia::http::Request&,
+                                 fuchsia::http::Response& resp) -> exec::task<void> {
+        resp.SetStatusCode(fuchsia::http::StatusCode::NotFound);
+        co_return;
+    }>>;
+
+// Matching happens at compile time for constant paths.
+static_assert(Mux::Match("/health") == 0);
+static_assert(Mux::Match("/health?verbose") == 0);
+static_assert(Mux::Match("/static/css/main.css") == 1);
+static_assert(Mux::Match("/static/img/logo.png") == 2);
+static_assert(Mux::Match("/healthz") == 3);
+static_assert(fuchsia::http::StaticServeMux<fuchsia::http::Route<"/a", HandleHealth>>::Match(
+                  "/b") == 1);
+
+std::string Serve(const fuchsia::http::MuxRef& mux, std::string_view url) {
+    auto data = "GET " + std::string(url) + " HTTP/1.1\r\n\r\n";
+    fuchsia::http::Request req;
+    fuchsia::http::Response resp;
+    REQUIRE(req.Parse(data.data(), data.size()) == fuchsia::http::ParseResult::Ok);
+    auto task = mux.Dispatch(req, resp);
+    if (!task) {
+        return "no route";
+    }
+    stdexec::sync_wait(std::move(*task));
+    return resp.StatusCode() == fuchsia::http::StatusCode::Ok ? std::string(resp.Body())
+                                                               : "not found";
+}
+
+}  // namespace
+
+TEST_CASE("StaticServeMux calls the handler of the matching route", "[StaticServeMux]") {
+    Mux mux;
+    REQUIRE(Serve(mux, "/health") == "ok");
+    REQUIRE(Serve(mux, "/static/a.js") == "static /static/a.js");
+    REQUIRE(Serve(mux, "/other") == "not found");
+
+    fuchsia::http::StaticServeMux<fuchsia::http::Route<"/health", HandleHealth>> small;
+    REQUIRE(Serve(small, "/health") == "ok");
+    REQUIRE(Serve(small, "/") == "no route");
+}
@@ -0,0 +1,129 @@
+//
+// Created by wenjuxu on 2023/8/16.
+//
+
+#include <random>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+#include "fuchsia/timing_wheel.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+using TimePoint = std::chrono::steady_clock::time_point;
+
+struct Timer {
+    TimePoint expiration;
+    Timer* prev = nullptr;
+    Timer* next = nullptr;
+    uint32_t bucket = fuchsia::kNoTimingWheelBucket;
+};
+
+std::vector<Timer*> Drain(fuchsia::IntrusiveQueue<Timer>&& queue) {
+    std::vector<Timer*> result;
+    while (!queue.Empty()) {
+        result.push_back(queue.PopFront());
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST_CASE("TimingWheel pops timers once they expire", "[TimingWheel]") {
+    auto start = TimePoint::clock::now();
+    fuchsia::TimingWheel<Timer> wheel{start};
+    REQUIRE(wheel.Empty());
+    REQUIRE_FALSE(wheel.NextExpiration().has_value());
+
+    Timer t1{start + 10ms};
+    Timer t2{start + 5ms};
+    wheel.Push(&t1);
+    wheel.Push(&t2);
+    REQUIRE(wheel.Size() == 2);
+    REQUIRE(wheel.NextExpiration() == start + 5ms);
+
+    REQUIRE(Drain(wheel.PopExpired(start + 4ms)).empty());
+    REQUIRE(Drain(wheel.PopExpired(start + 5ms)) == std::vector<Timer*>{&t2});
+    REQUIRE(wheel.NextExpiration() == start + 10ms);
+    REQUIRE(Drain(wheel.PopExpired(start + 1s)) == std::vector<Timer*>{&t1});
+    REQUIRE(wheel.Empty());
+}
+
+TEST_CASE("TimingWheel never pops a timer early", "[TimingWheel]") {
+    auto start = TimePoint::clock::now();
+    fuchsia::TimingWheel<Timer> wheel{start};
+
+    Timer timer{start + 2500us};
+    wheel.Push(&timer);
+    REQUIRE(Drain(wheel.PopExpired(start + 2999us)).empty());
+    REQUIRE(Drain(wheel.PopExpired(start + 3ms)) == std::vector<Timer*>{&timer});
+}
+
+TEST_CASE("TimingWheel pops already expired timers right away", "[TimingWheel]") {
+    auto start = TimePoint::clock::now();
+    fuchsia::TimingWheel<Timer> wheel{start};
+    REQUIRE(Drain(wheel.PopExpired(start + 100ms)).empty());
+
+    Timer timer{start + 50ms};
+    wheel.Push(&timer);
+    REQUIRE(wheel.NextExpiration() <= start + 100ms);
+    REQUIRE(Drain(wheel.PopExpired(start + 100ms)) == std::vector<Timer*>{&timer});
+}
+
+TEST_CASE("TimingWheel supports removing timers", "[TimingWheel]") {
+    auto start = TimePoint::clock::now();
+    fuchsia::TimingWheel<Timer> wheel{start};
+
+    Timer t1{start + 1ms};
+    Timer t2{start + 1ms};
+    Timer t3{start + 1h};
+    wheel.Push(&t1);
+    wheel.Push(&t2);
+    wheel.Push(&t3);
+    wheel.Remove(&t1);
+    wheel.Remove(&t3);
+    REQUIRE(wheel.Size() == 1);
+    REQUIRE(Drain(wheel.PopExpired(start + 2h)) == std::vector<Timer*>{&t2});
+    REQUIRE(wheel.Empty());
+}
+
+TEST_CASE("TimingWheel keeps order across levels", "[TimingWheel]") {
+    auto start = TimePoint::clock::now();
+    fuchsia::TimingWheel<Timer> wheel{start};
+
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<int64_t> dist{0, 24 * 3600 * 1000};  // one day in ms
+    std::vector<Timer> timers(10000);
+    for (auto& timer : timers) {
+        timer.expiration = start + std::chrono::milliseconds{dist(rng)};
+        wheel.Push(&timer);
+    }
+
+    // Advance in irregular steps, every popped timer must be expired, and no expired one left.
+    auto now = start;
+    size_t popped = 0;
+    while (!wheel.Empty()) {
+        if (auto next = wheel.NextExpiration(); next > now) {
+            now = *next;
+        }
+        for (auto timer : Drain(wheel.PopExpired(now))) {
+            REQUIRE(timer->expiration <= now);
+            REQUIRE(timer->expiration > now - 1ms);
+            ++popped;
+        }
+    }
+    REQUIRE(popped == timers.size());
+}
+
+TEST_CASE("TimingWheel handles timers far in the future", "[TimingWheel]") {
+    auto start = TimePoint::clock::now();
+    fuchsia::TimingWheel<Timer> wheel{start};
+
+    Timer timer{start + 24h * 365 * 10};
+    wheel.Push(&timer);
+    REQUIRE(wheel.NextExpiration() <= timer.expiration);
+    REQUIRE(Drain(wheel.PopExpired(start + 24h * 365 * 5)).empty());
+    REQUIRE(Drain(wheel.PopExpired(timer.expiration)) == std::vector<Timer*>{&timer});
+}
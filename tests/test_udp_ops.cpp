@@ -0,0 +1,135 @@
+//
+// Created by wenjuxu on 2023/8/30.
+//
+
+#include <array>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+#include "fuchsia/epoll_context.h"
+#include "fuchsia/net/udp.h"
+#include "fuchsia/socket_recv_from_op.h"
+#include "fuchsia/socket_recv_many_op.h"
+#include "fuchsia/socket_send_many_op.h"
+#include "fuchsia/socket_send_to_op.h"
+#include "test_util.h"
+
+namespace {
+
+// A socket bound to an ephemeral port on the loopback interface.
+fuchsia::net::Udp::Socket MakeBoundSocket(fuchsia::EpollContext& context) {
+    return {context, fuchsia::net::Udp::Endpoint{fuchsia::net::AddressV4::Loopback(), 0}};
+}
+
+fuchsia::net::Udp::Endpoint LocalEndpoint(const fuchsia::net::Udp::Socket& socket) {
+    fuchsia::net::Udp::Endpoint endpoint;
+    ::socklen_t len = fuchsia::net::Udp::Endpoint::Capacity();
+    ::getsockname(socket.Fd(), endpoint.Data(), &len);
+    return endpoint;
+}
+
+}  // namespace
+
+TEST_CASE("SendTo and RecvFrom carry the peer endpoint", "[UdpOperation]") {
+    fuchsia::EpollContext context;
+    auto a = MakeBoundSocket(context);
+    auto b = MakeBoundSocket(context);
+    fuchsia::test::RunningContext running{context};
+
+    char buffer[16]{};
+    fuchsia::MutableBuffer buf{buffer, sizeof(buffer)};
+    fuchsia::net::Udp::Endpoint from;
+    auto [received, sent] = stdexec::sync_wait(stdexec::when_all(
+        fuchsia::AsyncRecvFrom(b, buf, from),
+        fuchsia::AsyncSendTo(a, fuchsia::ConstBuffer("ping", 4), LocalEndpoint(b)))).value();
+    REQUIRE(sent == 4);
+    REQUIRE(received == 4);
+    REQUIRE(std::string_view{buffer, received} == "ping");
+    REQUIRE(from == LocalEndpoint(a));
+}
+
+TEST_CASE("SendMany and RecvMany move a batch of datagrams", "[UdpOperation]") {
+    fuchsia::EpollContext context;
+    auto a = MakeBoundSocket(context);
+    auto b = MakeBoundSocket(context);
+    fuchsia::test::RunningContext running{context};
+
+    constexpr size_t kCount = 16;
+    std::array<char, kCount> payloads{};
+    std::array<fuchsia::net::Datagram<fuchsia::net::Udp, fuchsia::ConstBuffer>, kCount> out;
+    for (size_t i = 0; i < kCount; ++i) {
+        payloads[i] = static_cast<char>('a' + i);
+        out[i].buffer = fuchsia::ConstBuffer{&payloads[i], 1};
+        out[i].endpoint = LocalEndpoint(b);
+    }
+    auto [sent] = stdexec::sync_wait(fuchsia::AsyncSendMany(a, out)).value();
+    REQUIRE(sent == kCount);
+
+    std::array<std::array<char, 8>, kCount> buffers{};
+    std::array<fuchsia::net::Datagram<fuchsia::net::Udp, fuchsia::MutableBuffer>, kCount> in;
+    for (size_t i = 0; i < kCount; ++i) {
+        in[i].buffer = fuchsia::Buffer(buffers[i]);
+    }
+    // All of them are queued on the loopback interface by now, still they may take several calls.
+    size_t received = 0;
+    while (received < kCount) {
+        auto batch = std::span(in).subspan(received);
+        auto [n] = stdexec::sync_wait(fuchsia::AsyncRecvMany(b, batch)).value();
+        REQUIRE(n > 0);
+        received += n;
+    }
+    for (size_t i = 0; i < kCount; ++i) {
+        REQUIRE(in[i].size == 1);
+        REQUIRE(buffers[i][0] == payloads[i]);
+        REQUIRE(in[i].endpoint == LocalEndpoint(a));
+    }
+}
+
+TEST_CASE("A GSO send is received coalesced with GRO", "[UdpOperation]") {
+    fuchsia::EpollContext context;
+    auto a = MakeBoundSocket(context);
+    auto b = MakeBoundSocket(context);
+    fuchsia::test::RunningContext running{context};
+
+    constexpr size_t kSegmentSize = 1200;
+    constexpr size_t kSegments = 10;
+    try {
+        b.SetUdpGro(true);
+    } catch (const std::system_error& e) {
+        WARN("UDP_GRO is not supported: " << e.what());
+        return;
+    }
+
+    std::vector<char> payload(kSegments * kSegmentSize);
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = static_cast<char>(i / kSegmentSize);
+    }
+    std::array<fuchsia::net::Datagram<fuchsia::net::Udp, fuchsia::ConstBuffer>, 1> out;
+    out[0].buffer = fuchsia::ConstBuffer{payload.data(), payload.size()};
+    out[0].endpoint = LocalEndpoint(b);
+    out[0].segment_size = kSegmentSize;
+    try {
+        auto [sent] = stdexec::sync_wait(fuchsia::AsyncSendMany(a, out)).value();
+        REQUIRE(sent == 1);
+    } catch (const std::system_error& e) {
+        WARN("UDP_SEGMENT is not supported: " << e.what());
+        return;
+    }
+
+    // Coalesced into one buffer as a rule, though the kernel may hand them out in several.
+    std::vector<char> storage(payload.size());
+    size_t received = 0;
+    while (received < payload.size()) {
+        std::array<fuchsia::net::Datagram<fuchsia::net::Udp, fuchsia::MutableBuffer>, 1> in;
+        in[0].buffer = fuchsia::MutableBuffer{storage.data() + received, storage.size() - received};
+        auto [n] = stdexec::sync_wait(fuchsia::AsyncRecvMany(b, in)).value();
+        REQUIRE(n == 1);
+        REQUIRE(in[0].segment_size == kSegmentSize);
+        REQUIRE(in[0].size % kSegmentSize == 0);
+        received += in[0].size;
+    }
+    REQUIRE(received == payload.size());
+    REQUIRE(storage == payload);
+}
@@ -0,0 +1,104 @@
+//
+// Created by wenjuxu on 2023/9/6.
+//
+
+#pragma once
+
+#include <sys/socket.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include "catch2/catch_test_macros.hpp"
+#include "fuchsia/epoll_context.h"
+#include "fuchsia/net/tcp.h"
+
+namespace fuchsia::test {
+
+// Runs a context on a thread of its own, and stops and joins it when destroyed. Sockets must only
+// be closed on the io thread or once the context has stopped, so declare it after the sockets of
+// the context: they are destroyed once the context is done with them.
+//
+//     fuchsia::EpollContext context;
+//     auto [client, server] = fuchsia::test::MakeSocketPair(context);
+//     fuchsia::test::RunningContext running{context};
+class RunningContext {
+public:
+    explicit RunningContext(EpollContext& context)
+        : context_(context), thread_([&context]() { context.Run(); }) {}
+
+    RunningContext(const RunningContext&) = delete;
+
+    ~RunningContext() {
+        context_.Stop();
+        thread_.join();
+    }
+
+private:
+    EpollContext& context_;
+    std::jthread thread_;
+};
+
+// A connected pair of sockets on the loopback interface, both bound to `context`. The connection
+// is accepted synchronously with an acceptor closed on return, so call it before the context runs.
+inline std::pair<net::Tcp::Socket, net::Tcp::Socket> MakeSocketPair(EpollContext& context) {
+    net::Tcp::Acceptor acceptor{context, net::Tcp::Endpoint{net::AddressV4::Loopback(), 0}};
+    ::sockaddr_storage addr{};
+    ::socklen_t len = sizeof(addr);
+    ::getsockname(acceptor.Fd(), reinterpret_cast<::sockaddr*>(&addr), &len);
+
+    net::Tcp::Socket client{context, net::Tcp::V4()};
+    ::connect(client.Fd(), reinterpret_cast<::sockaddr*>(&addr), len);  // in progress
+
+    std::error_code ec;
+    while (true) {
+        if (auto accepted = acceptor.Accept(ec)) {
+            return {std::move(client), std::move(accepted->first)};
+        }
+        REQUIRE(ec == std::errc::resource_unavailable_try_again);
+        std::this_thread::yield();
+    }
+}
+
+// A directory of files removed again at the end of the test. With `rename_into_place`, Write()
+// writes a new file and renames it over the old one, the way mapped files are meant to be updated,
+// otherwise it truncates and rewrites the file.
+class TempDir {
+public:
+    explicit TempDir(bool rename_into_place = false) : rename_into_place_(rename_into_place) {
+        char path[] = "/tmp/fuchsia_test_XXXXXX";
+        REQUIRE(::mkdtemp(path) != nullptr);
+        path_ = path;
+    }
+
+    TempDir(const TempDir&) = delete;
+
+    ~TempDir() { std::filesystem::remove_all(path_); }
+
+    const std::string& Path() const { return path_; }
+
+    void Write(const std::string& name, const std::string& content) const {
+        std::filesystem::path path{path_ + "/" + name};
+        std::filesystem::create_directories(path.parent_path());
+        if (!rename_into_place_) {
+            std::ofstream{path, std::ios::binary | std::ios::trunc} << content;
+            return;
+        }
+        std::filesystem::path temp{path_ + "/.tmp"};
+        std::ofstream{temp, std::ios::binary | std::ios::trunc} << content;
+        std::filesystem::rename(temp, path);
+    }
+
+    void Remove(const std::string& name) const { std::filesystem::remove(path_ + "/" + name); }
+
+private:
+    std::string path_;
+    bool rename_into_place_;
+};
+
+}  // namespace fuchsia::test
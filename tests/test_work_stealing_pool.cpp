@@ -0,0 +1,68 @@
+//
+// Created by wenjuxu on 2023/8/19.
+//
+
+#include <thread>
+
+#include "catch2/catch_test_macros.hpp"
+#include "exec/async_scope.hpp"
+#include "exec/task.hpp"
+#include "fuchsia/epoll_context.h"
+#include "fuchsia/scope_guard.h"
+#include "fuchsia/work_stealing_pool.h"
+
+TEST_CASE("WorkStealingPool runs work on its workers", "[WorkStealingPool]") {
+    fuchsia::WorkStealingPool pool{2};
+    REQUIRE(pool.Size() == 2);
+
+    auto [id] = stdexec::sync_wait(stdexec::schedule(pool.GetScheduler()) |
+                                   stdexec::then([] { return std::this_thread::get_id(); }))
+                    .value();
+    REQUIRE(id != std::this_thread::get_id());
+}
+
+TEST_CASE("WorkStealingPool runs all scheduled work", "[WorkStealingPool]") {
+    static constexpr int kOperations = 10000;
+
+    fuchsia::WorkStealingPool pool{4};
+    auto scheduler = pool.GetScheduler();
+    std::atomic<int> count = 0;
+
+    exec::async_scope scope;
+    for (int i = 0; i < kOperations; ++i) {
+        // Work scheduled from a worker lands in the worker's own deque, to be stolen by others.
+        scope.spawn(stdexec::schedule(scheduler) | stdexec::let_value([&] {
+                        return stdexec::schedule(scheduler) | stdexec::then([&] { ++count; });
+                    }));
+    }
+    stdexec::sync_wait(scope.on_empty());
+    REQUIRE(count == kOperations);
+}
+
+TEST_CASE("WorkStealingPool finishes scheduled work on stop", "[WorkStealingPool]") {
+    std::atomic<int> count = 0;
+    exec::async_scope scope;
+    {
+        fuchsia::WorkStealingPool pool{1};
+        for (int i = 0; i < 100; ++i) {
+            scope.spawn(stdexec::schedule(pool.GetScheduler()) | stdexec::then([&] { ++count; }));
+        }
+    }
+    REQUIRE(count == 100);
+    stdexec::sync_wait(scope.on_empty());
+}
+
+TEST_CASE("Offload comes back to the awaiting context", "[WorkStealingPool]") {
+    fuchsia::EpollContext context;
+    std::jthread thread([&]() { context.Run(); });
+    fuchsia::ScopeGuard guard{[&]() noexcept { context.Stop(); }};
+    fuchsia::WorkStealingPool pool{2};
+
+    auto task = [&]() -> exec::task<std::pair<std::thread::id, std::thread::id>> {
+        auto worker_id = co_await fuchsia::Offload(pool, [] { return std::this_thread::get_id(); });
+        co_return std::make_pair(worker_id, std::this_thread::get_id());
+    };
+    auto [ids] = stdexec::sync_wait(stdexec::on(context.GetScheduler(), task())).value();
+    REQUIRE(ids.first != thread.get_id());
+    REQUIRE(ids.second == thread.get_id());
+}